@@ -273,6 +273,29 @@ uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len)
     return i; // return number of bytes copied
 }
 
+uint8_t *fifoBuf_reserveData(t_fifo_buffer *buf, uint16_t len)
+{ // get a pointer to len contiguous free bytes at the write position, nothing is added until fifoBuf_commitData()
+    uint16_t wr = buf->wr;
+    uint16_t buf_size = buf->buf_size;
+
+    if (len < 1 || len > fifoBuf_getFree(buf) || len > buf_size - wr) {
+        return NULL; // no contiguous region of that size
+    }
+
+    return buf->buf_ptr + wr;
+}
+
+void fifoBuf_commitData(t_fifo_buffer *buf, uint16_t len)
+{ // add len bytes written in place after fifoBuf_reserveData() to the buffer
+    uint16_t wr = buf->wr + len;
+
+    if (wr >= buf->buf_size) {
+        wr -= buf->buf_size;
+    }
+
+    buf->wr = wr;
+}
+
 void fifoBuf_init(t_fifo_buffer *buf, const void *buffer, const uint16_t buffer_size)
 {
     buf->buf_ptr  = (uint8_t *)buffer;
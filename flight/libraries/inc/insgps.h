@@ -52,43 +52,48 @@
  * @}
  */
 
-// Exposed Function Prototypes
-void INSGPSInit();
-void INSStatePrediction(float gyro_data[3], float accel_data[3], float dT);
-void INSCovariancePrediction(float dT);
-void INSCorrection(float mag_data[3], float Pos[3], float Vel[3], float BaroAlt, uint16_t SensorsUsed);
-
-void INSResetP(float PDiag[13]);
-void INSGetP(float PDiag[13]);
-void INSSetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3]);
-void INSSetPosVelVar(float PosVar[3], float VelVar[3]);
-void INSSetGyroBias(float gyro_bias[3]);
-void INSSetAccelVar(float accel_var[3]);
-void INSSetGyroVar(float gyro_var[3]);
-void INSSetGyroBiasVar(float gyro_bias_var[3]);
-void INSSetMagNorth(float B[3]);
-void INSSetMagVar(float scaled_mag_var[3]);
-void INSSetBaroVar(float baro_var);
-void INSPosVelReset(float pos[3], float vel[3]);
-
-void MagCorrection(float mag_data[3]);
-void MagVelBaroCorrection(float mag_data[3], float Vel[3], float BaroAlt);
-void FullCorrection(float mag_data[3], float Pos[3], float Vel[3],
-                    float BaroAlt);
-void GpsBaroCorrection(float Pos[3], float Vel[3], float BaroAlt);
-void GpsMagCorrection(float mag_data[3], float Pos[3], float Vel[2]);
-void VelBaroCorrection(float Vel[3], float BaroAlt);
-
-uint16_t ins_get_num_states();
-
 // Nav structure containing current solution
-extern struct NavStruct {
+struct NavStruct {
     float Pos[3]; // Position in meters and relative to a local NED frame
     float Vel[3]; // Velocity in meters and in NED
     float q[4]; // unit quaternion rotation relative to NED
     float gyro_bias[3];
     float accel_bias[3];
-} Nav;
+};
+
+// Handle of one filter instance, instances are independent of each other
+typedef struct EKFData *insgps_handle_t;
+
+// Exposed Function Prototypes
+insgps_handle_t INSGPSCreate();
+void INSGPSInit(insgps_handle_t ekf);
+void INSStatePrediction(insgps_handle_t ekf, float gyro_data[3], float accel_data[3], float dT);
+void INSCovariancePrediction(insgps_handle_t ekf, float dT);
+void INSCorrection(insgps_handle_t ekf, float mag_data[3], float Pos[3], float Vel[3], float BaroAlt, uint16_t SensorsUsed);
+
+void INSResetP(insgps_handle_t ekf, float PDiag[13]);
+void INSGetP(insgps_handle_t ekf, float PDiag[13]);
+void INSSetState(insgps_handle_t ekf, float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3]);
+void INSSetPosVelVar(insgps_handle_t ekf, float PosVar[3], float VelVar[3]);
+void INSSetGyroBias(insgps_handle_t ekf, float gyro_bias[3]);
+void INSSetAccelVar(insgps_handle_t ekf, float accel_var[3]);
+void INSSetGyroVar(insgps_handle_t ekf, float gyro_var[3]);
+void INSSetGyroBiasVar(insgps_handle_t ekf, float gyro_bias_var[3]);
+void INSSetMagNorth(insgps_handle_t ekf, float B[3]);
+void INSSetMagVar(insgps_handle_t ekf, float scaled_mag_var[3]);
+void INSSetBaroVar(insgps_handle_t ekf, float baro_var);
+void INSPosVelReset(insgps_handle_t ekf, float pos[3], float vel[3]);
+const struct NavStruct *INSGetNav(insgps_handle_t ekf);
+
+void MagCorrection(insgps_handle_t ekf, float mag_data[3]);
+void MagVelBaroCorrection(insgps_handle_t ekf, float mag_data[3], float Vel[3], float BaroAlt);
+void FullCorrection(insgps_handle_t ekf, float mag_data[3], float Pos[3], float Vel[3],
+                    float BaroAlt);
+void GpsBaroCorrection(insgps_handle_t ekf, float Pos[3], float Vel[3], float BaroAlt);
+void GpsMagCorrection(insgps_handle_t ekf, float mag_data[3], float Pos[3], float Vel[2]);
+void VelBaroCorrection(insgps_handle_t ekf, float Vel[3], float BaroAlt);
+
+uint16_t ins_get_num_states();
 
 /**
  * @}
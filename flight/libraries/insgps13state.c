@@ -34,6 +34,7 @@
 #include <stdint.h>
 #include <pios_math.h>
 #include <mathmisc.h>
+#include <pios_mem.h>
 
 // constants/macros/typdefs
 #define NUMX 13 // number of states, X is the state vector
@@ -41,12 +42,13 @@
 #define NUMV 10 // number of measurements, v is the measurement noise vector
 #define NUMU 6 // number of deterministic inputs, U is the input vector
 #pragma GCC optimize "O3"
+
+// CovariancePrediction() and SerialUpdate() are generated by insgps_kernels.py
+// from the sparsity of F, G and H, it must be updated when LinearizeFG() or
+// LinearizeH() change. The header also defines NUMP, the size of P.
+#include "insgps13state_kernels.h"
+
 // Private functions
-void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-                          float Q[NUMW], float dT, float P[NUMX][NUMX]);
-static void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-                         float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
-                         uint16_t SensorsUsed);
 static void RungeKutta(float X[NUMX], float U[NUMU], float dT);
 static void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
 static void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
@@ -56,52 +58,36 @@ static void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
 
 // Private variables
 
-// speed optimizations, describe matrix sparsity
-// derived from state equations in
-// LinearizeFG() and LinearizeH():
-//
-// usage F:        usage G:   usage H:
-// -0123456789abc  012345678  0123456789abc
-// 0...X.........  .........  X............
-// 1....X........  .........  .X...........
-// 2.....X.......  .........  ..X..........
-// 3......XXXX...  ...XXX...  ...X.........
-// 4......XXXX...  ...XXX...  ....X........
-// 5......XXXX...  ...XXX...  .....X.......
-// 6.....ooXXXXXX  XXX......  ......XXXX...
-// 7.....oXoXXXXX  XXX......  ......XXXX...
-// 8.....oXXoXXXX  XXX......  ......XXXX...
-// 9.....oXXXoXXX  XXX......  ..X..........
-// a.............  ......Xoo
-// b.............  ......oXo
-// c.............  ......ooX
-
-static int8_t FrowMin[NUMX] = { 3, 4, 5, 6, 6, 6, 5, 5, 5, 5, 13, 13, 13 };
-static int8_t FrowMax[NUMX] = { 3, 4, 5, 9, 9, 9, 12, 12, 12, 12, -1, -1, -1 };
-
-static int8_t GrowMin[NUMX] = { 9, 9, 9, 3, 3, 3, 0, 0, 0, 0, 6, 7, 8 };
-static int8_t GrowMax[NUMX] = { -1, -1, -1, 5, 5, 5, 2, 2, 2, 2, 6, 7, 8 };
-
-static int8_t HrowMin[NUMV] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
-static int8_t HrowMax[NUMV] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
-
-static struct EKFData {
+// P is symmetric, only its upper triangle is stored, row by row
+static inline uint8_t PIndex(uint8_t i, uint8_t j)
+{
+    if (i > j) {
+        uint8_t t = i;
+        i = j;
+        j = t;
+    }
+    return i * (2 * NUMX - i - 1) / 2 + j;
+}
+
+// State of one filter instance, callers only see it through insgps_handle_t
+struct EKFData {
     // linearized system matrices
     float F[NUMX][NUMX];
     float G[NUMX][NUMW];
     float H[NUMV][NUMX];
     // local magnetic unit vector in NED frame
     float Be[3];
-    // covariance matrix and state vector
-    float P[NUMX][NUMX];
+    // covariance matrix (upper triangle) and state vector
+    float P[NUMP];
     float X[NUMX];
     // input noise and measurement noise variances
     float Q[NUMW];
     float R[NUMV];
-} ekf;
+    // current solution
+    struct NavStruct Nav;
+};
 
-// Global variables
-struct NavStruct Nav;
+static float zeros[3] = { 0, 0, 0 };
 
 // *************  Exposed Functions ****************
 // *************************************************
@@ -111,59 +97,76 @@ uint16_t ins_get_num_states()
     return NUMX;
 }
 
-void INSGPSInit() // pretty much just a place holder for now
+insgps_handle_t INSGPSCreate()
 {
-    ekf.Be[0] = 1.0f;
-    ekf.Be[1] = 0.0f;
-    ekf.Be[2] = 0.0f; // local magnetic unit vector
+    insgps_handle_t ekf = (insgps_handle_t)pios_malloc(sizeof(struct EKFData));
 
+    if (ekf) {
+        INSGPSInit(ekf);
+    }
+    return ekf;
+}
+
+const struct NavStruct *INSGetNav(insgps_handle_t ekf)
+{
+    return &ekf->Nav;
+}
+
+void INSGPSInit(insgps_handle_t ekf) // pretty much just a place holder for now
+{
+    ekf->Be[0] = 1.0f;
+    ekf->Be[1] = 0.0f;
+    ekf->Be[2] = 0.0f; // local magnetic unit vector
+
+    for (int i = 0; i < NUMP; i++) {
+        ekf->P[i] = 0.0f; // zero all terms
+    }
     for (int i = 0; i < NUMX; i++) {
         for (int j = 0; j < NUMX; j++) {
-            ekf.P[i][j] = 0.0f; // zero all terms
-            ekf.F[i][j] = 0.0f;
+            ekf->F[i][j] = 0.0f;
         }
 
         for (int j = 0; j < NUMW; j++) {
-            ekf.G[i][j] = 0.0f;
+            ekf->G[i][j] = 0.0f;
         }
 
         for (int j = 0; j < NUMV; j++) {
-            ekf.H[j][i] = 0.0f;
+            ekf->H[j][i] = 0.0f;
         }
 
-        ekf.X[i] = 0.0f;
+        ekf->X[i] = 0.0f;
     }
     for (int i = 0; i < NUMW; i++) {
-        ekf.Q[i] = 0.0f;
+        ekf->Q[i] = 0.0f;
     }
     for (int i = 0; i < NUMV; i++) {
-        ekf.R[i] = 0.0f;
+        ekf->R[i] = 0.0f;
     }
 
 
-    ekf.P[0][0]   = ekf.P[1][1] = ekf.P[2][2] = 25.0f;            // initial position variance (m^2)
-    ekf.P[3][3]   = ekf.P[4][4] = ekf.P[5][5] = 5.0f;             // initial velocity variance (m/s)^2
-    ekf.P[6][6]   = ekf.P[7][7] = ekf.P[8][8] = ekf.P[9][9] = 1e-5f;  // initial quaternion variance
-    ekf.P[10][10] = ekf.P[11][11] = ekf.P[12][12] = 1e-9f; // initial gyro bias variance (rad/s)^2
+    ekf->P[PIndex(0, 0)]   = ekf->P[PIndex(1, 1)] = ekf->P[PIndex(2, 2)] = 25.0f;            // initial position variance (m^2)
+    ekf->P[PIndex(3, 3)]   = ekf->P[PIndex(4, 4)] = ekf->P[PIndex(5, 5)] = 5.0f;             // initial velocity variance (m/s)^2
+    ekf->P[PIndex(6, 6)]   = ekf->P[PIndex(7, 7)] = ekf->P[PIndex(8, 8)] = ekf->P[PIndex(9, 9)] = 1e-5f;  // initial quaternion variance
+    ekf->P[PIndex(10, 10)] = ekf->P[PIndex(11, 11)] = ekf->P[PIndex(12, 12)] = 1e-9f; // initial gyro bias variance (rad/s)^2
 
-    ekf.X[0]  = ekf.X[1] = ekf.X[2] = ekf.X[3] = ekf.X[4] = ekf.X[5] = 0.0f; // initial pos and vel (m)
-    ekf.X[6]  = 1.0f;
-    ekf.X[7]  = ekf.X[8] = ekf.X[9] = 0.0f;      // initial quaternion (level and North) (m/s)
-    ekf.X[10] = ekf.X[11] = ekf.X[12] = 0.0f; // initial gyro bias (rad/s)
+    ekf->X[0]  = ekf->X[1] = ekf->X[2] = ekf->X[3] = ekf->X[4] = ekf->X[5] = 0.0f; // initial pos and vel (m)
+    ekf->X[6]  = 1.0f;
+    ekf->X[7]  = ekf->X[8] = ekf->X[9] = 0.0f;      // initial quaternion (level and North) (m/s)
+    ekf->X[10] = ekf->X[11] = ekf->X[12] = 0.0f; // initial gyro bias (rad/s)
 
-    ekf.Q[0]  = ekf.Q[1] = ekf.Q[2] = 50e-4f;        // gyro noise variance (rad/s)^2
-    ekf.Q[3]  = ekf.Q[4] = ekf.Q[5] = 0.00001f;      // accelerometer noise variance (m/s^2)^2
-    ekf.Q[6]  = ekf.Q[7] = ekf.Q[8] = 2e-8f;     // gyro bias random walk variance (rad/s^2)^2
+    ekf->Q[0]  = ekf->Q[1] = ekf->Q[2] = 50e-4f;        // gyro noise variance (rad/s)^2
+    ekf->Q[3]  = ekf->Q[4] = ekf->Q[5] = 0.00001f;      // accelerometer noise variance (m/s^2)^2
+    ekf->Q[6]  = ekf->Q[7] = ekf->Q[8] = 2e-8f;     // gyro bias random walk variance (rad/s^2)^2
 
-    ekf.R[0]  = ekf.R[1] = 0.004f;   // High freq GPS horizontal position noise variance (m^2)
-    ekf.R[2]  = 0.036f;          // High freq GPS vertical position noise variance (m^2)
-    ekf.R[3]  = ekf.R[4] = 0.004f;   // High freq GPS horizontal velocity noise variance (m/s)^2
-    ekf.R[5]  = 100.0f;          // High freq GPS vertical velocity noise variance (m/s)^2
-    ekf.R[6]  = ekf.R[7] = ekf.R[8] = 0.005f;    // magnetometer unit vector noise variance
-    ekf.R[9]  = .25f;                    // High freq altimeter noise variance (m^2)
+    ekf->R[0]  = ekf->R[1] = 0.004f;   // High freq GPS horizontal position noise variance (m^2)
+    ekf->R[2]  = 0.036f;          // High freq GPS vertical position noise variance (m^2)
+    ekf->R[3]  = ekf->R[4] = 0.004f;   // High freq GPS horizontal velocity noise variance (m/s)^2
+    ekf->R[5]  = 100.0f;          // High freq GPS vertical velocity noise variance (m/s)^2
+    ekf->R[6]  = ekf->R[7] = ekf->R[8] = 0.005f;    // magnetometer unit vector noise variance
+    ekf->R[9]  = .25f;                    // High freq altimeter noise variance (m^2)
 }
 
-void INSResetP(float PDiag[NUMX])
+void INSResetP(insgps_handle_t ekf, float PDiag[NUMX])
 {
     uint8_t i, j;
 
@@ -171,123 +174,122 @@ void INSResetP(float PDiag[NUMX])
     for (i = 0; i < NUMX; i++) {
         if (PDiag != 0) {
             for (j = 0; j < NUMX; j++) {
-                ekf.P[i][j] = ekf.P[j][i] = 0.0f;
+                ekf->P[PIndex(i, j)] = 0.0f;
             }
-            ekf.P[i][i] = PDiag[i];
+            ekf->P[PIndex(i, i)] = PDiag[i];
         }
     }
 }
 
-void INSGetP(float PDiag[NUMX])
+void INSGetP(insgps_handle_t ekf, float PDiag[NUMX])
 {
     uint8_t i;
 
     // retrieve diagonal elements (aka state variance)
     if (PDiag != 0) {
         for (i = 0; i < NUMX; i++) {
-            PDiag[i] = ekf.P[i][i];
+            PDiag[i] = ekf->P[PIndex(i, i)];
         }
     }
 }
 
-void INSSetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], __attribute__((unused)) float accel_bias[3])
+void INSSetState(insgps_handle_t ekf, float pos[3], float vel[3], float q[4], float gyro_bias[3], __attribute__((unused)) float accel_bias[3])
 {
     /* Note: accel_bias not used in 13 state INS */
-    ekf.X[0]  = pos[0];
-    ekf.X[1]  = pos[1];
-    ekf.X[2]  = pos[2];
-    ekf.X[3]  = vel[0];
-    ekf.X[4]  = vel[1];
-    ekf.X[5]  = vel[2];
-    ekf.X[6]  = q[0];
-    ekf.X[7]  = q[1];
-    ekf.X[8]  = q[2];
-    ekf.X[9]  = q[3];
-    ekf.X[10] = gyro_bias[0];
-    ekf.X[11] = gyro_bias[1];
-    ekf.X[12] = gyro_bias[2];
+    ekf->X[0]  = pos[0];
+    ekf->X[1]  = pos[1];
+    ekf->X[2]  = pos[2];
+    ekf->X[3]  = vel[0];
+    ekf->X[4]  = vel[1];
+    ekf->X[5]  = vel[2];
+    ekf->X[6]  = q[0];
+    ekf->X[7]  = q[1];
+    ekf->X[8]  = q[2];
+    ekf->X[9]  = q[3];
+    ekf->X[10] = gyro_bias[0];
+    ekf->X[11] = gyro_bias[1];
+    ekf->X[12] = gyro_bias[2];
 }
 
-void INSPosVelReset(float pos[3], float vel[3])
+void INSPosVelReset(insgps_handle_t ekf, float pos[3], float vel[3])
 {
     for (int i = 0; i < 6; i++) {
         for (int j = i; j < NUMX; j++) {
-            ekf.P[i][j] = 0; // zero the first 6 rows and columns
-            ekf.P[j][i] = 0;
+            ekf->P[PIndex(i, j)] = 0; // zero the first 6 rows and columns
         }
     }
 
-    ekf.P[0][0] = ekf.P[1][1] = ekf.P[2][2] = 25; // initial position variance (m^2)
-    ekf.P[3][3] = ekf.P[4][4] = ekf.P[5][5] = 5; // initial velocity variance (m/s)^2
+    ekf->P[PIndex(0, 0)] = ekf->P[PIndex(1, 1)] = ekf->P[PIndex(2, 2)] = 25; // initial position variance (m^2)
+    ekf->P[PIndex(3, 3)] = ekf->P[PIndex(4, 4)] = ekf->P[PIndex(5, 5)] = 5; // initial velocity variance (m/s)^2
 
-    ekf.X[0]    = pos[0];
-    ekf.X[1]    = pos[1];
-    ekf.X[2]    = pos[2];
-    ekf.X[3]    = vel[0];
-    ekf.X[4]    = vel[1];
-    ekf.X[5]    = vel[2];
+    ekf->X[0]    = pos[0];
+    ekf->X[1]    = pos[1];
+    ekf->X[2]    = pos[2];
+    ekf->X[3]    = vel[0];
+    ekf->X[4]    = vel[1];
+    ekf->X[5]    = vel[2];
 }
 
-void INSSetPosVelVar(float PosVar[3], float VelVar[3])
+void INSSetPosVelVar(insgps_handle_t ekf, float PosVar[3], float VelVar[3])
 {
-    ekf.R[0] = PosVar[0];
-    ekf.R[1] = PosVar[1];
-    ekf.R[2] = PosVar[2];
-    ekf.R[3] = VelVar[0];
-    ekf.R[4] = VelVar[1];
-    ekf.R[5] = VelVar[2];
+    ekf->R[0] = PosVar[0];
+    ekf->R[1] = PosVar[1];
+    ekf->R[2] = PosVar[2];
+    ekf->R[3] = VelVar[0];
+    ekf->R[4] = VelVar[1];
+    ekf->R[5] = VelVar[2];
 }
 
-void INSSetGyroBias(float gyro_bias[3])
+void INSSetGyroBias(insgps_handle_t ekf, float gyro_bias[3])
 {
-    ekf.X[10] = gyro_bias[0];
-    ekf.X[11] = gyro_bias[1];
-    ekf.X[12] = gyro_bias[2];
+    ekf->X[10] = gyro_bias[0];
+    ekf->X[11] = gyro_bias[1];
+    ekf->X[12] = gyro_bias[2];
 }
 
-void INSSetAccelVar(float accel_var[3])
+void INSSetAccelVar(insgps_handle_t ekf, float accel_var[3])
 {
-    ekf.Q[3] = accel_var[0];
-    ekf.Q[4] = accel_var[1];
-    ekf.Q[5] = accel_var[2];
+    ekf->Q[3] = accel_var[0];
+    ekf->Q[4] = accel_var[1];
+    ekf->Q[5] = accel_var[2];
 }
 
-void INSSetGyroVar(float gyro_var[3])
+void INSSetGyroVar(insgps_handle_t ekf, float gyro_var[3])
 {
-    ekf.Q[0] = gyro_var[0];
-    ekf.Q[1] = gyro_var[1];
-    ekf.Q[2] = gyro_var[2];
+    ekf->Q[0] = gyro_var[0];
+    ekf->Q[1] = gyro_var[1];
+    ekf->Q[2] = gyro_var[2];
 }
 
-void INSSetGyroBiasVar(float gyro_bias_var[3])
+void INSSetGyroBiasVar(insgps_handle_t ekf, float gyro_bias_var[3])
 {
-    ekf.Q[6] = gyro_bias_var[0];
-    ekf.Q[7] = gyro_bias_var[1];
-    ekf.Q[8] = gyro_bias_var[2];
+    ekf->Q[6] = gyro_bias_var[0];
+    ekf->Q[7] = gyro_bias_var[1];
+    ekf->Q[8] = gyro_bias_var[2];
 }
 
-void INSSetMagVar(float scaled_mag_var[3])
+void INSSetMagVar(insgps_handle_t ekf, float scaled_mag_var[3])
 {
-    ekf.R[6] = scaled_mag_var[0];
-    ekf.R[7] = scaled_mag_var[1];
-    ekf.R[8] = scaled_mag_var[2];
+    ekf->R[6] = scaled_mag_var[0];
+    ekf->R[7] = scaled_mag_var[1];
+    ekf->R[8] = scaled_mag_var[2];
 }
 
-void INSSetBaroVar(float baro_var)
+void INSSetBaroVar(insgps_handle_t ekf, float baro_var)
 {
-    ekf.R[9] = baro_var;
+    ekf->R[9] = baro_var;
 }
 
-void INSSetMagNorth(float B[3])
+void INSSetMagNorth(insgps_handle_t ekf, float B[3])
 {
     float invmag = invsqrtf(B[0] * B[0] + B[1] * B[1] + B[2] * B[2]);
 
-    ekf.Be[0] = B[0] * invmag;
-    ekf.Be[1] = B[1] * invmag;
-    ekf.Be[2] = B[2] * invmag;
+    ekf->Be[0] = B[0] * invmag;
+    ekf->Be[1] = B[1] * invmag;
+    ekf->Be[2] = B[2] * invmag;
 }
 
-void INSStatePrediction(float gyro_data[3], float accel_data[3], float dT)
+void INSStatePrediction(insgps_handle_t ekf, float gyro_data[3], float accel_data[3], float dT)
 {
     float U[6];
     float invqmag;
@@ -303,75 +305,73 @@ void INSStatePrediction(float gyro_data[3], float accel_data[3], float dT)
     U[5] = accel_data[2];
 
     // EKF prediction step
-    LinearizeFG(ekf.X, U, ekf.F, ekf.G);
-    RungeKutta(ekf.X, U, dT);
-    invqmag   = invsqrtf(ekf.X[6] * ekf.X[6] + ekf.X[7] * ekf.X[7] + ekf.X[8] * ekf.X[8] + ekf.X[9] * ekf.X[9]);
-    ekf.X[6] *= invqmag;
-    ekf.X[7] *= invqmag;
-    ekf.X[8] *= invqmag;
-    ekf.X[9] *= invqmag;
-    // CovariancePrediction(ekf.F,ekf.G,ekf.Q,dT,ekf.P);
+    LinearizeFG(ekf->X, U, ekf->F, ekf->G);
+    RungeKutta(ekf->X, U, dT);
+    invqmag   = invsqrtf(ekf->X[6] * ekf->X[6] + ekf->X[7] * ekf->X[7] + ekf->X[8] * ekf->X[8] + ekf->X[9] * ekf->X[9]);
+    ekf->X[6] *= invqmag;
+    ekf->X[7] *= invqmag;
+    ekf->X[8] *= invqmag;
+    ekf->X[9] *= invqmag;
+    // CovariancePrediction(ekf->F,ekf->G,ekf->Q,dT,ekf->P);
 
     // Update Nav solution structure
-    Nav.Pos[0] = ekf.X[0];
-    Nav.Pos[1] = ekf.X[1];
-    Nav.Pos[2] = ekf.X[2];
-    Nav.Vel[0] = ekf.X[3];
-    Nav.Vel[1] = ekf.X[4];
-    Nav.Vel[2] = ekf.X[5];
-    Nav.q[0]   = ekf.X[6];
-    Nav.q[1]   = ekf.X[7];
-    Nav.q[2]   = ekf.X[8];
-    Nav.q[3]   = ekf.X[9];
-    Nav.gyro_bias[0] = ekf.X[10];
-    Nav.gyro_bias[1] = ekf.X[11];
-    Nav.gyro_bias[2] = ekf.X[12];
+    ekf->Nav.Pos[0] = ekf->X[0];
+    ekf->Nav.Pos[1] = ekf->X[1];
+    ekf->Nav.Pos[2] = ekf->X[2];
+    ekf->Nav.Vel[0] = ekf->X[3];
+    ekf->Nav.Vel[1] = ekf->X[4];
+    ekf->Nav.Vel[2] = ekf->X[5];
+    ekf->Nav.q[0]   = ekf->X[6];
+    ekf->Nav.q[1]   = ekf->X[7];
+    ekf->Nav.q[2]   = ekf->X[8];
+    ekf->Nav.q[3]   = ekf->X[9];
+    ekf->Nav.gyro_bias[0] = ekf->X[10];
+    ekf->Nav.gyro_bias[1] = ekf->X[11];
+    ekf->Nav.gyro_bias[2] = ekf->X[12];
 }
 
-void INSCovariancePrediction(float dT)
+void INSCovariancePrediction(insgps_handle_t ekf, float dT)
 {
-    CovariancePrediction(ekf.F, ekf.G, ekf.Q, dT, ekf.P);
+    CovariancePrediction(ekf->F, ekf->G, ekf->Q, dT, ekf->P);
 }
 
-float zeros[3] = { 0, 0, 0 };
-
-void MagCorrection(float mag_data[3])
+void MagCorrection(insgps_handle_t ekf, float mag_data[3])
 {
-    INSCorrection(mag_data, zeros, zeros, zeros[0], MAG_SENSORS);
+    INSCorrection(ekf, mag_data, zeros, zeros, zeros[0], MAG_SENSORS);
 }
 
-void MagVelBaroCorrection(float mag_data[3], float Vel[3], float BaroAlt)
+void MagVelBaroCorrection(insgps_handle_t ekf, float mag_data[3], float Vel[3], float BaroAlt)
 {
-    INSCorrection(mag_data, zeros, Vel, BaroAlt,
+    INSCorrection(ekf, mag_data, zeros, Vel, BaroAlt,
                   MAG_SENSORS | HORIZ_SENSORS | VERT_SENSORS |
                   BARO_SENSOR);
 }
 
-void GpsBaroCorrection(float Pos[3], float Vel[3], float BaroAlt)
+void GpsBaroCorrection(insgps_handle_t ekf, float Pos[3], float Vel[3], float BaroAlt)
 {
-    INSCorrection(zeros, Pos, Vel, BaroAlt,
+    INSCorrection(ekf, zeros, Pos, Vel, BaroAlt,
                   HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR);
 }
 
-void FullCorrection(float mag_data[3], float Pos[3], float Vel[3],
+void FullCorrection(insgps_handle_t ekf, float mag_data[3], float Pos[3], float Vel[3],
                     float BaroAlt)
 {
-    INSCorrection(mag_data, Pos, Vel, BaroAlt, FULL_SENSORS);
+    INSCorrection(ekf, mag_data, Pos, Vel, BaroAlt, FULL_SENSORS);
 }
 
-void GpsMagCorrection(float mag_data[3], float Pos[3], float Vel[3])
+void GpsMagCorrection(insgps_handle_t ekf, float mag_data[3], float Pos[3], float Vel[3])
 {
-    INSCorrection(mag_data, Pos, Vel, zeros[0],
+    INSCorrection(ekf, mag_data, Pos, Vel, zeros[0],
                   POS_SENSORS | HORIZ_SENSORS | MAG_SENSORS);
 }
 
-void VelBaroCorrection(float Vel[3], float BaroAlt)
+void VelBaroCorrection(insgps_handle_t ekf, float Vel[3], float BaroAlt)
 {
-    INSCorrection(zeros, zeros, Vel, BaroAlt,
+    INSCorrection(ekf, zeros, zeros, Vel, BaroAlt,
                   HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR);
 }
 
-void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
+void INSCorrection(insgps_handle_t ekf, float mag_data[3], float Pos[3], float Vel[3],
                    float BaroAlt, uint16_t SensorsUsed)
 {
     float Z[10] = { 0 };
@@ -400,176 +400,29 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
     Z[9] = BaroAlt;
 
     // EKF correction step
-    LinearizeH(ekf.X, ekf.Be, ekf.H);
-    MeasurementEq(ekf.X, ekf.Be, Y);
-    SerialUpdate(ekf.H, ekf.R, Z, Y, ekf.P, ekf.X, SensorsUsed);
-
-    float invqmag = invsqrtf(ekf.X[6] * ekf.X[6] + ekf.X[7] * ekf.X[7] + ekf.X[8] * ekf.X[8] + ekf.X[9] * ekf.X[9]);
-    ekf.X[6]  *= invqmag;
-    ekf.X[7]  *= invqmag;
-    ekf.X[8]  *= invqmag;
-    ekf.X[9]  *= invqmag;
+    LinearizeH(ekf->X, ekf->Be, ekf->H);
+    MeasurementEq(ekf->X, ekf->Be, Y);
+    SerialUpdate(ekf->H, ekf->R, Z, Y, ekf->P, ekf->X, SensorsUsed);
+
+    float invqmag = invsqrtf(ekf->X[6] * ekf->X[6] + ekf->X[7] * ekf->X[7] + ekf->X[8] * ekf->X[8] + ekf->X[9] * ekf->X[9]);
+    ekf->X[6]  *= invqmag;
+    ekf->X[7]  *= invqmag;
+    ekf->X[8]  *= invqmag;
+    ekf->X[9]  *= invqmag;
     // Update Nav solution structure
-    Nav.Pos[0] = ekf.X[0];
-    Nav.Pos[1] = ekf.X[1];
-    Nav.Pos[2] = ekf.X[2];
-    Nav.Vel[0] = ekf.X[3];
-    Nav.Vel[1] = ekf.X[4];
-    Nav.Vel[2] = ekf.X[5];
-    Nav.q[0]   = ekf.X[6];
-    Nav.q[1]   = ekf.X[7];
-    Nav.q[2]   = ekf.X[8];
-    Nav.q[3]   = ekf.X[9];
-    Nav.gyro_bias[0] = ekf.X[10];
-    Nav.gyro_bias[1] = ekf.X[11];
-    Nav.gyro_bias[2] = ekf.X[12];
-}
-
-// *************  CovariancePrediction *************
-// Does the prediction step of the Kalman filter for the covariance matrix
-// Output, Pnew, overwrites P, the input covariance
-// Pnew = (I+F*T)*P*(I+F*T)' + T^2*G*Q*G'
-// Q is the discrete time covariance of process noise
-// Q is vector of the diagonal for a square matrix with
-// dimensions equal to the number of disturbance noise variables
-// The General Method is very inefficient,not taking advantage of the sparse F and G
-// The first Method is very specific to this implementation
-// ************************************************
-
-void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-                          float Q[NUMW], float dT, float P[NUMX][NUMX])
-{
-    // Pnew = (I+F*T)*P*(I+F*T)' + (T^2)*G*Q*G' = (T^2)[(P/T + F*P)*(I/T + F') + G*Q*G')]
-
-    const float dT1  = 1.0f / dT; // multiplication is faster than division on fpu.
-    const float dTsq = dT * dT;
-
-    float Dummy[NUMX][NUMX];
-    int8_t i;
-    int8_t k;
-
-    for (i = 0; i < NUMX; i++) { // Calculate Dummy = (P/T +F*P)
-        float *Firow = F[i];
-        float *Pirow = P[i];
-        float *Dirow = Dummy[i];
-        const int8_t Fistart = FrowMin[i];
-        const int8_t Fiend   = FrowMax[i];
-        int8_t j;
-
-        for (j = 0; j < NUMX; j++) {
-            Dirow[j] = Pirow[j] * dT1; // Dummy = P / T ...
-        }
-        for (k = Fistart; k <= Fiend; k++) {
-            for (j = 0; j < NUMX; j++) {
-                Dirow[j] += Firow[k] * P[k][j]; // [] + F * P
-            }
-        }
-    }
-    for (i = 0; i < NUMX; i++) { // Calculate Pnew = (T^2) [Dummy/T + Dummy*F' + G*Qw*G']
-        float *Dirow = Dummy[i];
-        float *Girow = G[i];
-        float *Pirow = P[i];
-        const int8_t Gistart = GrowMin[i];
-        const int8_t Giend   = GrowMax[i];
-        int8_t j;
-
-
-        for (j = i; j < NUMX; j++) { // Use symmetry, ie only find upper triangular
-            float Ptmp         = Dirow[j] * dT1; // Pnew = Dummy / T ...
-
-            const float *Fjrow = F[j];
-            int8_t Fjstart     = FrowMin[j];
-            int8_t Fjend       = FrowMax[j];
-            k = Fjstart;
-
-            while (k <= Fjend - 3) {
-                Ptmp += Dirow[k] * Fjrow[k]; // [] + Dummy*F' ...
-                Ptmp += Dirow[k + 1] * Fjrow[k + 1];
-                Ptmp += Dirow[k + 2] * Fjrow[k + 2];
-                Ptmp += Dirow[k + 3] * Fjrow[k + 3];
-                k    += 4;
-            }
-            while (k <= Fjend) {
-                Ptmp += Dirow[k] * Fjrow[k];
-                k++;
-            }
-
-            float *Gjrow = G[j];
-            const int8_t Gjstart = MAX(Gistart, GrowMin[j]);
-            const int8_t Gjend   = MIN(Giend, GrowMax[j]);
-            k = Gjstart;
-            while (k <= Gjend - 2) {
-                Ptmp += Q[k] * Girow[k] * Gjrow[k]; // [] + G*Q*G' ...
-                Ptmp += Q[k + 1] * Girow[k + 1] * Gjrow[k + 1];
-                Ptmp += Q[k + 2] * Girow[k + 2] * Gjrow[k + 2];
-                k    += 3;
-            }
-            if (k <= Gjend) {
-                Ptmp += Q[k] * Girow[k] * Gjrow[k];
-                if (k <= Gjend - 1) {
-                    Ptmp += Q[k + 1] * Girow[k + 1] * Gjrow[k + 1];
-                }
-            }
-
-            P[j][i] = Pirow[j] = Ptmp * dTsq; // [] * (T^2)
-        }
-    }
-}
-
-// *************  SerialUpdate *******************
-// Does the update step of the Kalman filter for the covariance and estimate
-// Outputs are Xnew & Pnew, and are written over P and X
-// Z is actual measurement, Y is predicted measurement
-// Xnew = X + K*(Z-Y), Pnew=(I-K*H)*P,
-// where K=P*H'*inv[H*P*H'+R]
-// NOTE the algorithm assumes R (measurement covariance matrix) is diagonal
-// i.e. the measurment noises are uncorrelated.
-// It therefore uses a serial update that requires no matrix inversion by
-// processing the measurements one at a time.
-// Algorithm - see Grewal and Andrews, "Kalman Filtering,2nd Ed" p.121 & p.253
-// - or see Simon, "Optimal State Estimation," 1st Ed, p.150
-// The SensorsUsed variable is a bitwise mask indicating which sensors
-// should be used in the update.
-// ************************************************
-void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
-                  uint16_t SensorsUsed)
-{
-    float HP[NUMX], HPHR, Error;
-    uint8_t i, j, k, m;
-    float Km[NUMX];
-
-    for (m = 0; m < NUMV; m++) {
-        if (SensorsUsed & (0x01 << m)) { // use this sensor for update
-            for (j = 0; j < NUMX; j++) { // Find Hp = H*P
-                HP[j] = 0;
-            }
-
-            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
-                for (j = 0; j < NUMX; j++) { // Find Hp = H*P
-                    HP[j] += H[m][k] * P[k][j];
-                }
-            }
-            HPHR = R[m]; // Find  HPHR = H*P*H' + R
-            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
-                HPHR += HP[k] * H[m][k];
-            }
-            float invHPHR = 1.0f / HPHR;
-            for (k = 0; k < NUMX; k++) {
-                Km[k] = HP[k] * invHPHR; // find K = HP/HPHR
-            }
-            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
-                for (j = i; j < NUMX; j++) {
-                    P[i][j] = P[j][i] = P[i][j] - Km[i] * HP[j];
-                }
-            }
-
-            Error = Z[m] - Y[m];
-            for (i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
-                X[i] = X[i] + Km[i] * Error;
-            }
-        }
-    }
+    ekf->Nav.Pos[0] = ekf->X[0];
+    ekf->Nav.Pos[1] = ekf->X[1];
+    ekf->Nav.Pos[2] = ekf->X[2];
+    ekf->Nav.Vel[0] = ekf->X[3];
+    ekf->Nav.Vel[1] = ekf->X[4];
+    ekf->Nav.Vel[2] = ekf->X[5];
+    ekf->Nav.q[0]   = ekf->X[6];
+    ekf->Nav.q[1]   = ekf->X[7];
+    ekf->Nav.q[2]   = ekf->X[8];
+    ekf->Nav.q[3]   = ekf->X[9];
+    ekf->Nav.gyro_bias[0] = ekf->X[10];
+    ekf->Nav.gyro_bias[1] = ekf->X[11];
+    ekf->Nav.gyro_bias[2] = ekf->X[12];
 }
 
 // *************  RungeKutta **********************
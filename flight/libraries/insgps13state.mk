@@ -0,0 +1,18 @@
+#
+# Rules to add the 13 state INS/GPS EKF to a PiOS target
+#
+# The covariance prediction and update kernels are generated into $(OUTDIR)
+# by insgps_kernels.py, the header is only rewritten when it changes.
+#
+
+INSGPS_DIR	:=	$(dir $(lastword $(MAKEFILE_LIST)))
+# $(PYTHON) is Python 2 for the older build scripts (see make/tools.mk), run the generator with Python 3
+INSGPS_PYTHON	?=	python3
+
+SRC		+=	$(INSGPS_DIR)insgps13state.c
+EXTRAINCDIRS	+=	$(OUTDIR)
+
+INSGPS_GEN	:=	$(shell $(INSGPS_PYTHON) $(INSGPS_DIR)insgps_kernels.py --model=13 --outfile=$(OUTDIR)/insgps13state_kernels.h 2>&1 || echo failed)
+ifneq ($(INSGPS_GEN),)
+    $(error Generating the INS/GPS kernels: $(INSGPS_GEN))
+endif
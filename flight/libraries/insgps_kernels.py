@@ -0,0 +1,300 @@
+#!/usr/bin/env python3
+#
+# Generates the covariance prediction and serial update kernels of the
+# INS/GPS EKF from the structure of its linearized model.
+#
+# The general form of both steps loops over dense matrices although most
+# elements of F, G and H are always zero and P is symmetric. This script
+# emits them fully unrolled for a given model: only the structurally
+# non-zero elements of F, G and H are used, elements that are always one
+# are folded in, and P is stored as its upper triangle, row by row.
+#
+# (C) 2016, The LibrePilot Project, http://www.librepilot.org
+# See also: The GNU Public License (GPL) Version 3
+#
+
+from __future__ import print_function
+
+import argparse
+import os
+import sys
+
+# Structure of F, G and H as set by LinearizeFG() and LinearizeH(), one string
+# per row: '.' is always zero, '1' always one, '-' always minus one and 'X'
+# is computed. These must be kept in sync with the model in the C source.
+MODELS = {
+    '13': {
+        'source': 'insgps13state.c',
+        'numx': 13,
+        'numw': 9,
+        'numv': 10,
+        # State Variables = [Pos Vel Quaternion GyroBias]
+        'F': [
+            # 0123456789abc
+            '...1.........',
+            '....1........',
+            '.....1.......',
+            '......XXXX...',
+            '......XXXX...',
+            '......XXXX...',
+            '.......XXXXXX',
+            '......X.XXXXX',
+            '......XX.XXXX',
+            '......XXX.XXX',
+            '.............',
+            '.............',
+            '.............',
+        ],
+        # Disturbance Noise = [GyroNoise AccelNoise GyroRandomWalkNoise]
+        'G': [
+            # 012345678
+            '.........',
+            '.........',
+            '.........',
+            '...XXX...',
+            '...XXX...',
+            '...XXX...',
+            'XXX......',
+            'XXX......',
+            'XXX......',
+            'XXX......',
+            '......1..',
+            '.......1.',
+            '........1',
+        ],
+        # Measurement Variables = [Pos Vel BodyFrameMagField Altimeter]
+        'H': [
+            # 0123456789abc
+            '1............',
+            '.1...........',
+            '..1..........',
+            '...1.........',
+            '....1........',
+            '.....1.......',
+            '......XXXX...',
+            '......XXXX...',
+            '......XXXX...',
+            '..-..........',
+        ],
+    },
+}
+
+
+def pindex(numx, i, j):
+    """ Index of P(i, j) in the upper triangle stored row by row """
+    if i > j:
+        i, j = j, i
+    return i * (2 * numx - i - 1) // 2 + j
+
+
+def nonzero(row):
+    """ Columns and kinds of the non-zero elements of a matrix row """
+    return [(k, c) for k, c in enumerate(row) if c != '.']
+
+
+def product(kind, element, operand):
+    """ Returns the sign and the term of element * operand """
+    if kind == '1':
+        return '+', operand
+    if kind == '-':
+        return '-', operand
+    return '+', '%s * %s' % (element, operand)
+
+
+def terms(first, items):
+    """ Joins (sign, term) pairs into a sum starting with first """
+    expression = first
+    for sign, term in items:
+        if expression is None:
+            expression = term if sign == '+' else '-' + term
+        else:
+            expression += ' %s %s' % (sign, term)
+    return expression if expression is not None else '0.0f'
+
+
+def check_model(name, model):
+    numx, numw, numv = model['numx'], model['numw'], model['numv']
+    shapes = (('F', numx, numx), ('G', numx, numw), ('H', numv, numx))
+    for matrix, rows, cols in shapes:
+        if len(model[matrix]) != rows or any(len(row) != cols for row in model[matrix]):
+            sys.exit('model %s: %s must be %dx%d' % (name, matrix, rows, cols))
+        if any(c not in '.1-X' for row in model[matrix] for c in row):
+            sys.exit('model %s: unknown element in %s' % (name, matrix))
+
+
+def covariance_prediction(model):
+    numx = model['numx']
+    F = [nonzero(row) for row in model['F']]
+    G = [nonzero(row) for row in model['G']]
+
+    def P(i, j):
+        return 'P[%d]' % pindex(numx, i, j)
+
+    def D(i, j):
+        return 'D%d_%d' % (i, j)
+
+    # elements of D = P/T + F*P used by the upper triangle of Pnew
+    used = set()
+    for i in range(numx):
+        for j in range(i, numx):
+            used.add((i, j))
+            used.update((i, k) for k, _ in F[j])
+
+    out = []
+    out.append('// *************  CovariancePrediction *************')
+    out.append('// Does the prediction step of the Kalman filter for the covariance matrix')
+    out.append('// Output, Pnew, overwrites P, the input covariance')
+    out.append('// Pnew = (I+F*T)*P*(I+F*T)\' + T^2*G*Q*G\'')
+    out.append('// Q is the discrete time covariance of process noise')
+    out.append('// Q is vector of the diagonal for a square matrix with')
+    out.append('// dimensions equal to the number of disturbance noise variables')
+    out.append('// ************************************************')
+    out.append('')
+    out.append('static void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],')
+    out.append('                                 float Q[NUMW], float dT, float P[NUMP])')
+    out.append('{')
+    out.append('    // Pnew = (I+F*T)*P*(I+F*T)\' + (T^2)*G*Q*G\' = (T^2)[(P/T + F*P)*(I/T + F\') + G*Q*G\')]')
+    out.append('')
+    out.append('    const float dT1  = 1.0f / dT; // multiplication is faster than division on fpu.')
+    out.append('    const float dTsq = dT * dT;')
+    out.append('')
+    out.append('    // Dummy = (P/T +F*P)')
+    for i in range(numx):
+        for j in range(numx):
+            if (i, j) in used:
+                items = [product(kind, 'F[%d][%d]' % (i, k), P(k, j)) for k, kind in F[i]]
+                out.append('    const float %s = %s;' % (D(i, j), terms('%s * dT1' % P(i, j), items)))
+    out.append('')
+    out.append('    // Pnew = (T^2) [Dummy/T + Dummy*F\' + G*Qw*G\'], upper triangle only')
+    for i in range(numx):
+        for j in range(i, numx):
+            items = [product(kind, 'F[%d][%d]' % (j, k), D(i, k)) for k, kind in F[j]]
+            Gj = dict(G[j])
+            for k, kind in G[i]:
+                if k in Gj:
+                    factors = ['Q[%d]' % k]
+                    factors += ['G[%d][%d]' % (row, k) for row, rowkind in ((i, kind), (j, Gj[k])) if rowkind == 'X']
+                    sign = '-' if (kind == '-') != (Gj[k] == '-') else '+'
+                    items.append((sign, ' * '.join(factors)))
+            out.append('    %s = dTsq * (%s);' % (P(i, j), terms('%s * dT1' % D(i, j), items)))
+    out.append('}')
+    return out
+
+
+def serial_update(model):
+    numx, numv = model['numx'], model['numv']
+    H = [nonzero(row) for row in model['H']]
+
+    out = []
+    out.append('// *************  SerialUpdateStep ***************')
+    out.append('// Updates the estimate and the covariance with one measurement')
+    out.append('// HP = H*P and HPHR = H*P*H\' + R for this measurement')
+    out.append('// K = HP/HPHR, Pnew = P - K*HP, Xnew = X + K*Error')
+    out.append('// ************************************************')
+    out.append('')
+    out.append('static void SerialUpdateStep(float P[NUMP], float X[NUMX], const float HP[NUMX],')
+    out.append('                             float HPHR, float Error)')
+    out.append('{')
+    out.append('    const float invHPHR = 1.0f / HPHR;')
+    out.append('    float Km[NUMX];')
+    out.append('')
+    for i in range(numx):
+        out.append('    Km[%d] = HP[%d] * invHPHR;' % (i, i))
+    out.append('')
+    for i in range(numx):
+        for j in range(i, numx):
+            out.append('    P[%d] -= Km[%d] * HP[%d];' % (pindex(numx, i, j), i, j))
+    out.append('')
+    for i in range(numx):
+        out.append('    X[%d] += Km[%d] * Error;' % (i, i))
+    out.append('}')
+    out.append('')
+    out.append('// *************  SerialUpdate *******************')
+    out.append('// Does the update step of the Kalman filter for the covariance and estimate')
+    out.append('// Outputs are Xnew & Pnew, and are written over P and X')
+    out.append('// Z is actual measurement, Y is predicted measurement')
+    out.append('// Xnew = X + K*(Z-Y), Pnew=(I-K*H)*P,')
+    out.append('// where K=P*H\'*inv[H*P*H\'+R]')
+    out.append('// NOTE the algorithm assumes R (measurement covariance matrix) is diagonal')
+    out.append('// i.e. the measurment noises are uncorrelated.')
+    out.append('// It therefore uses a serial update that requires no matrix inversion by')
+    out.append('// processing the measurements one at a time.')
+    out.append('// Algorithm - see Grewal and Andrews, "Kalman Filtering,2nd Ed" p.121 & p.253')
+    out.append('// - or see Simon, "Optimal State Estimation," 1st Ed, p.150')
+    out.append('// The SensorsUsed variable is a bitwise mask indicating which sensors')
+    out.append('// should be used in the update.')
+    out.append('// ************************************************')
+    out.append('')
+    out.append('static void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],')
+    out.append('                         float Y[NUMV], float P[NUMP], float X[NUMX],')
+    out.append('                         uint16_t SensorsUsed)')
+    out.append('{')
+    out.append('    float HP[NUMX];')
+    if all(kind != 'X' for row in H for _, kind in row):
+        out.append('')
+        out.append('    (void)H;')
+    for m in range(numv):
+        out.append('')
+        out.append('    if (SensorsUsed & (0x01 << %d)) { // use this sensor for update' % m)
+        for j in range(numx):
+            items = [product(kind, 'H[%d][%d]' % (m, k), 'P[%d]' % pindex(numx, k, j)) for k, kind in H[m]]
+            out.append('        HP[%d] = %s;' % (j, terms(None, items)))
+        items = [product(kind, 'H[%d][%d]' % (m, k), 'HP[%d]' % k) for k, kind in H[m]]
+        out.append('        SerialUpdateStep(P, X, HP, %s, Z[%d] - Y[%d]);' % (terms('R[%d]' % m, items), m, m))
+        out.append('    }')
+    out.append('}')
+    return out
+
+
+def generate(name, model):
+    numx = model['numx']
+    guard = '%s_KERNELS_H' % os.path.splitext(model['source'])[0].upper()
+    out = []
+    out.append('/**')
+    out.append(' * Generated by insgps_kernels.py for %s, do not edit.' % model['source'])
+    out.append(' *')
+    out.append(' * P is symmetric, only its upper triangle is stored, row by row.')
+    out.append(' */')
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('#if NUMX != %d || NUMW != %d || NUMV != %d' % (numx, model['numw'], model['numv']))
+    out.append('#error "%s does not match the model of %s"' % (guard, model['source']))
+    out.append('#endif')
+    out.append('')
+    out.append('#define NUMP %d // number of stored elements of P' % (numx * (numx + 1) // 2))
+    out.append('')
+    out += covariance_prediction(model)
+    out.append('')
+    out += serial_update(model)
+    out.append('')
+    out.append('#endif // %s' % guard)
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the INS/GPS EKF kernels.')
+    parser.add_argument('--model', required=True, choices=sorted(MODELS.keys()),
+                        help='number of states of the filter')
+    parser.add_argument('--outfile', required=True, help='header to write')
+    args = parser.parse_args()
+
+    model = MODELS[args.model]
+    check_model(args.model, model)
+    text = generate(args.model, model)
+
+    # only touch the header when it changes, so that the filter is not rebuilt every time
+    if os.path.exists(args.outfile):
+        with open(args.outfile) as f:
+            if f.read() == text:
+                return 0
+    outdir = os.path.dirname(args.outfile)
+    if outdir and not os.path.isdir(outdir):
+        os.makedirs(outdir)
+    with open(args.outfile, 'w') as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -274,6 +274,12 @@ correct_errors_erasures (unsigned char codeword[],
 {
   int r, i, j, err;
 
+  /* Nothing to locate if the codeword has no error and no erasure,
+     see decode_data() */
+  if (nerasures == 0 && !check_syndrome()) {
+    return(0);
+  }
+
   /* If you want to take advantage of erasure correction, be sure to
      set NErasures and ErasureLocs[] with the locations of erasures. 
      */
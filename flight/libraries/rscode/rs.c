@@ -38,20 +38,53 @@ int synBytes[MAXDEG];
 /* generator polynomial */
 int genPoly[MAXDEG*2];
 
+/* Set by decode_data when any of the syndrome bytes is not zero */
+static int synNonZero;
+
+/* Multiplication by the generator polynomial coefficients and by the
+ * roots a^1..a^NPARITY. Multiplying by a constant is linear over GF(2),
+ * so it is split in a low and a high nibble table, 32 bytes per constant:
+ * c*x = table[0][x & 0x0F] ^ table[1][x >> 4] */
+static unsigned char genMult[RS_ECC_NPARITY][2][16];
+static unsigned char synMult[RS_ECC_NPARITY][2][16];
+
+#define TMULT(table, x) ((table)[0][(x) & 0x0F] ^ (table)[1][(x) >> 4])
+
 //int DEBUG = FALSE;
 
 static void
 compute_genpoly (int nbytes, int genpoly[]);
 
+static void
+init_mult_table (int c, unsigned char table[2][16]);
+
 /* Initialize lookup tables, polynomials, etc. */
 void
 initialize_ecc ()
 {
+  int j;
+
   /* Initialize the galois field arithmetic tables */
     init_galois_tables();
 
     /* Compute the encoder generator polynomial */
     compute_genpoly(RS_ECC_NPARITY, genPoly);
+
+    /* Precompute the multiplications done for every byte of a packet */
+    for (j = 0; j < RS_ECC_NPARITY; j++) {
+      init_mult_table(genPoly[j], genMult[j]);
+      init_mult_table(gexp[j+1], synMult[j]);
+    }
+}
+
+static void
+init_mult_table (int c, unsigned char table[2][16])
+{
+  int n;
+  for (n = 0; n < 16; n++) {
+    table[0][n] = gmult(c, n);
+    table[1][n] = gmult(c, n << 4);
+  }
 }
 
 void
@@ -105,18 +138,29 @@ build_codeword (unsigned char msg[], int nbytes, unsigned char dst[])
  *
  * Computes the syndrome of a codeword. Puts the results
  * into the synBytes[] array.
+ *
+ * All the syndromes are evaluated at once (Horner's rule
+ * for each root) in a single pass over the codeword.
  */
  
 void
 decode_data(unsigned char data[], int nbytes)
 {
-  int i, j, sum;
-  for (j = 0; j < RS_ECC_NPARITY;  j++) {
-    sum	= 0;
-    for (i = 0; i < nbytes; i++) {
-      sum = data[i] ^ gmult(gexp[j+1], sum);
+  unsigned char syn[RS_ECC_NPARITY];
+  int i, j;
+
+  for (j = 0; j < RS_ECC_NPARITY; j++) syn[j] = 0;
+
+  for (i = 0; i < nbytes; i++) {
+    for (j = 0; j < RS_ECC_NPARITY; j++) {
+      syn[j] = data[i] ^ TMULT(synMult[j], syn[j]);
     }
-    synBytes[j]  = sum;
+  }
+
+  synNonZero = 0;
+  for (j = 0; j < RS_ECC_NPARITY; j++) {
+    synBytes[j] = syn[j];
+    synNonZero |= syn[j];
   }
 }
 
@@ -125,14 +169,7 @@ decode_data(unsigned char data[], int nbytes)
 int
 check_syndrome (void)
 {
- int i, nz = 0;
- for (i =0 ; i < RS_ECC_NPARITY; i++) {
-  if (synBytes[i] != 0) {
-      nz = 1;
-      break;
-  }
- }
- return nz;
+ return (synNonZero != 0);
 }
 
 
@@ -187,16 +224,17 @@ compute_genpoly (int nbytes, int genpoly[])
 void
 encode_data (unsigned char msg[], int nbytes, unsigned char dst[])
 {
-  int i, LFSR[RS_ECC_NPARITY+1],dbyte, j;
+  int i, dbyte, j;
+  unsigned char LFSR[RS_ECC_NPARITY];
 	
-  for(i=0; i < RS_ECC_NPARITY+1; i++) LFSR[i]=0;
+  for(i=0; i < RS_ECC_NPARITY; i++) LFSR[i]=0;
 
   for (i = 0; i < nbytes; i++) {
     dbyte = msg[i] ^ LFSR[RS_ECC_NPARITY-1];
     for (j = RS_ECC_NPARITY-1; j > 0; j--) {
-      LFSR[j] = LFSR[j-1] ^ gmult(genPoly[j], dbyte);
+      LFSR[j] = LFSR[j-1] ^ TMULT(genMult[j], dbyte);
     }
-    LFSR[0] = gmult(genPoly[0], dbyte);
+    LFSR[0] = TMULT(genMult[0], dbyte);
   }
 
   for (i = 0; i < RS_ECC_NPARITY; i++) 
@@ -104,7 +104,10 @@ void updateGpsSettings(__attribute__((unused)) UAVObjEvent *ev);
 // the new location with Set = true.
 #define GPS_HOMELOCATION_SET_DELAY 5000
 
+// on data, sleep this long to let a burst accumulate in the COM buffer
 #define GPS_LOOP_DELAY_MS          6
+// otherwise block in the COM layer until the next burst starts
+#define GPS_BLOCK_ON_NO_DATA_MS    20
 
 #ifdef PIOS_GPS_SETS_HOMELOCATION
 // Unfortunately need a good size stack for the WMM calculation
@@ -284,12 +287,10 @@ MODULE_INITCALL(GPSInitialize, GPSStart);
 static void gpsTask(__attribute__((unused)) void *parameters)
 {
     // 57600 baud = 5760 bytes per second
-    // PIOS serial buffers appear to be 32 bytes long
-    // that is a maximum of 5760/32 = 180 buffers per second
-    // that is 1/180 = 0.005555556 seconds per packet
-    // we must never wait more than 5ms since packet was last drained or it may overflow
-    // 100ms is way slow too, considering we do everything possible to make the sensor data as contemporary as possible
-    portTickType xDelay = 5 / portTICK_RATE_MS;
+    // the GPS COM buffers are 32 to 128 bytes long, that is 5.5 to 22ms of data
+    // the task only polls while a burst is coming in, sleeping GPS_LOOP_DELAY_MS between reads
+    // between bursts it blocks until the next byte (or the next DMA span) arrives
+    portTickType xDelay = GPS_BLOCK_ON_NO_DATA_MS / portTICK_RATE_MS;
     uint32_t timeNowMs  = xTaskGetTickCount() * portTICK_RATE_MS;
 
 #ifdef PIOS_GPS_SETS_HOMELOCATION
@@ -313,6 +314,8 @@ static void gpsTask(__attribute__((unused)) void *parameters)
 
     // Loop forever
     while (1) {
+        uint16_t cnt = 0;
+
         if (gpsPort) {
 #if defined(FULL_UBX_PARSER)
             // do autoconfig stuff for UBX GPS's
@@ -350,10 +353,10 @@ static void gpsTask(__attribute__((unused)) void *parameters)
             }
 #endif /* if defined(FULL_UBX_PARSER) */
 
-            uint16_t cnt;
             int res;
-            // This blocks the task until there is something on the buffer (or 100ms? passes)
+            // This blocks the task until there is something on the buffer (or GPS_BLOCK_ON_NO_DATA_MS passes)
             cnt = PIOS_COM_ReceiveBuffer(gpsPort, c, GPS_READ_BUFFER, xDelay);
+            xLastWakeTime = xTaskGetTickCount();
             res = PARSER_INCOMPLETE;
             if (cnt > 0) {
                 PERF_TIMED_SECTION_START(counterParse);
@@ -444,7 +447,11 @@ static void gpsTask(__attribute__((unused)) void *parameters)
                 }
             }
         } // if (gpsPort)
-        vTaskDelayUntil(&xLastWakeTime, GPS_LOOP_DELAY_MS / portTICK_RATE_MS);
+        // a full read means more data is waiting, otherwise let the rest of the burst come in
+        // (one byte per interrupt on most ports, whole spans on DMA ports)
+        if (!gpsPort || (cnt > 0 && cnt < GPS_READ_BUFFER)) {
+            vTaskDelayUntil(&xLastWakeTime, GPS_LOOP_DELAY_MS / portTICK_RATE_MS);
+        }
     } // while (1)
 }
 
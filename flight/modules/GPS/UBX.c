@@ -57,23 +57,23 @@ static uint32_t lastPvtTime = 0;
 typedef struct {
     uint8_t msgClass;
     uint8_t msgID;
-    void (*handler)(struct UBXPacket *, GPSPositionSensorData *GpsPosition);
+    void (*handler)(UBXPayload *, GPSPositionSensorData *GpsPosition);
 } ubx_message_handler;
 
 // parsing functions, roughly ordered by reception rate (higher rate messages on top)
-static void parse_ubx_nav_posllh(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_nav_velned(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_nav_sol(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_nav_dop(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_nav_posllh(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_nav_velned(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_nav_sol(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_nav_dop(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
 #if !defined(PIOS_GPS_MINIMAL)
-static void parse_ubx_nav_pvt(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_nav_timeutc(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_nav_svinfo(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_op_sys(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_op_mag(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_ack_ack(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_ack_nak(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
-static void parse_ubx_mon_ver(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_nav_pvt(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_nav_timeutc(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_nav_svinfo(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_op_sys(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_op_mag(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_ack_ack(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_ack_nak(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
+static void parse_ubx_mon_ver(UBXPayload *payload, GPSPositionSensorData *GpsPosition);
 #endif /* !defined(PIOS_GPS_MINIMAL) */
 
 const ubx_message_handler ubx_handler_table[] = {
@@ -106,125 +106,178 @@ struct UBX_ACK_NAK ubxLastNak;
 // If a PVT sentence is received in the last UBX_PVT_TIMEOUT (ms) timeframe it disables VELNED/POSLLH/SOL/TIMEUTC
 #define UBX_PVT_TIMEOUT (1000)
 
+// Length of the frame fields following the two sync chars
+#define UBX_HEADER_LEN   4 // class, id, len (little endian)
+#define UBX_CHECKSUM_LEN 2 // ck_a, ck_b
+
+// accumulate the Fletcher checksum of a span into ck_a, ck_b
+static void checksum_ubx_span(const uint8_t *data, uint16_t len, uint8_t *ck_a, uint8_t *ck_b)
+{
+    uint8_t a = *ck_a;
+    uint8_t b = *ck_b;
+
+    while (len--) {
+        a += *data++;
+        b += a;
+    }
+    *ck_a = a;
+    *ck_b = b;
+}
+
 // parse incoming character stream for messages in UBX binary format
+//
+// packets are located with a block scan for the sync chars
+// a packet entirely contained in rx is checksummed and decoded in place
+// only packets split across calls are reassembled in gps_rx_buffer
 int parse_ubx_stream(uint8_t *rx, uint16_t len, char *gps_rx_buffer, GPSPositionSensorData *GpsData, struct GPS_RX_STATS *gpsRxStats)
 {
     enum proto_states {
         START,
         UBX_SY2,
-        UBX_CLASS,
-        UBX_ID,
-        UBX_LEN1,
-        UBX_LEN2,
-        UBX_PAYLOAD,
-        UBX_CHK1,
-        UBX_CHK2,
-        FINISHED
+        UBX_FRAME
     };
     enum restart_states {
         RESTART_WITH_ERROR,
         RESTART_NO_ERROR
     };
-    static uint16_t rx_count = 0;
+    static uint16_t frame_count = 0; // bytes of the split packet stored in gps_rx_buffer
     static enum proto_states proto_state = START;
     struct UBXPacket *ubx    = (struct UBXPacket *)gps_rx_buffer;
     int ret = PARSER_INCOMPLETE; // message not (yet) complete
     uint16_t i = 0;
     uint16_t restart_index   = 0;
     enum restart_states restart_state;
-    uint8_t c;
+    uint16_t n;
+    uint8_t ck_a, ck_b;
 
-    // switch continue is the normal condition and comes back to here for another byte
+    // switch continue is the normal condition and comes back to here for the next span
     // switch break is the error state that branches to the end and restarts the scan at the byte after the first sync byte
     while (i < len) {
-        c = rx[i++];
         switch (proto_state) {
         case START: // detect protocol
-            if (c == UBX_SYNC1) { // first UBX sync char found
-                proto_state   = UBX_SY2;
-                // restart here, at byte after SYNC1, if we fail to parse
-                restart_index = i;
+        {
+            const uint8_t *sync = memchr(&rx[i], UBX_SYNC1, len - i);
+            if (!sync) {
+                i = len;
+                continue;
             }
+            // first UBX sync char found
+            // restart here, at byte after SYNC1, if we fail to parse
+            i = sync - rx + 1;
+            restart_index = i;
+            proto_state   = UBX_SY2;
             continue;
+        }
         case UBX_SY2:
-            if (c == UBX_SYNC2) { // second UBX sync char found
-                proto_state = UBX_CLASS;
-            } else {
-                restart_state = RESTART_NO_ERROR;
-                break;
+            if (rx[i] != UBX_SYNC2) {
+                // not a packet, this byte may be the next SYNC1
+                proto_state = START;
+                continue;
             }
-            continue;
-        case UBX_CLASS:
-            ubx->header.class = c;
-            proto_state      = UBX_ID;
-            continue;
-        case UBX_ID:
-            ubx->header.id   = c;
-            proto_state      = UBX_LEN1;
-            continue;
-        case UBX_LEN1:
-            ubx->header.len  = c;
-            proto_state      = UBX_LEN2;
-            continue;
-        case UBX_LEN2:
-            ubx->header.len += (c << 8);
-            if (ubx->header.len > sizeof(UBXPayload)) {
-                gpsRxStats->gpsRxOverflow++;
+            i++;
+            // decode in place if the whole packet is in this chunk
+            if (len - i >= UBX_HEADER_LEN) {
+                uint16_t payload_len = rx[i + 2] | (rx[i + 3] << 8);
+                if (payload_len > sizeof(UBXPayload)) {
+                    gpsRxStats->gpsRxOverflow++;
 #if defined(PIOS_GPS_MINIMAL)
-                restart_state = RESTART_NO_ERROR;
+                    restart_state = RESTART_NO_ERROR;
 #else
-                restart_state = RESTART_WITH_ERROR;
+                    restart_state = RESTART_WITH_ERROR;
 #endif
-                break;
-            } else {
-                if (ubx->header.len == 0) {
-                    proto_state = UBX_CHK1;
-                } else {
-                    proto_state = UBX_PAYLOAD;
-                    rx_count    = 0;
+                    break;
+                }
+                if (len - i >= UBX_HEADER_LEN + payload_len + UBX_CHECKSUM_LEN) {
+                    ck_a = 0;
+                    ck_b = 0;
+                    checksum_ubx_span(&rx[i], UBX_HEADER_LEN + payload_len, &ck_a, &ck_b);
+                    if (rx[i + UBX_HEADER_LEN + payload_len] != ck_a ||
+                        rx[i + UBX_HEADER_LEN + payload_len + 1] != ck_b) {
+                        gpsRxStats->gpsRxChkSumError++;
+                        restart_state = RESTART_WITH_ERROR;
+                        break;
+                    }
+                    gpsRxStats->gpsRxReceived++;
+                    proto_state = START;
+                    // overwrite PARSER_INCOMPLETE with PARSER_COMPLETE
+                    // but don't overwrite PARSER_ERROR with PARSER_COMPLETE
+                    // pass PARSER_ERROR to caller if it happens even once
+                    // only pass PARSER_COMPLETE back to caller if we parsed a full set of GPS data
+                    // that allows the caller to know if we are parsing GPS data
+                    // or just other packets for some reason (mis-configuration)
+                    if (parse_ubx_message(rx[i], rx[i + 1], (UBXPayload *)&rx[i + UBX_HEADER_LEN], GpsData) == GPSPOSITIONSENSOR_OBJID
+                        && ret == PARSER_INCOMPLETE) {
+                        ret = PARSER_COMPLETE;
+                    }
+                    i += UBX_HEADER_LEN + payload_len + UBX_CHECKSUM_LEN;
+                    continue;
                 }
             }
+            // packet continues in the next chunk, reassemble it
+            proto_state = UBX_FRAME;
+            frame_count = 0;
             continue;
-        case UBX_PAYLOAD:
-            if (rx_count < ubx->header.len) {
-                ubx->payload.payload[rx_count] = c;
-                if (++rx_count == ubx->header.len) {
-                    proto_state = UBX_CHK1;
+        case UBX_FRAME:
+            if (frame_count < UBX_HEADER_LEN) {
+                n = MIN(UBX_HEADER_LEN - frame_count, len - i);
+                memcpy((uint8_t *)&ubx->header + frame_count, &rx[i], n);
+                i += n;
+                frame_count += n;
+                if (frame_count == UBX_HEADER_LEN) {
+                    uint8_t *header = (uint8_t *)&ubx->header;
+                    ubx->header.len = header[2] | (header[3] << 8);
+                    if (ubx->header.len > sizeof(UBXPayload)) {
+                        gpsRxStats->gpsRxOverflow++;
+#if defined(PIOS_GPS_MINIMAL)
+                        restart_state = RESTART_NO_ERROR;
+#else
+                        restart_state = RESTART_WITH_ERROR;
+#endif
+                        break;
+                    }
                 }
+                continue;
             }
-            continue;
-        case UBX_CHK1:
-            ubx->header.ck_a = c;
-            proto_state = UBX_CHK2;
-            continue;
-        case UBX_CHK2:
-            ubx->header.ck_b = c;
+            if (frame_count < UBX_HEADER_LEN + ubx->header.len) {
+                n = MIN(UBX_HEADER_LEN + ubx->header.len - frame_count, len - i);
+                memcpy(&ubx->payload.payload[frame_count - UBX_HEADER_LEN], &rx[i], n);
+                i += n;
+                frame_count += n;
+                continue;
+            }
+            if (frame_count == UBX_HEADER_LEN + ubx->header.len) {
+                ubx->header.ck_a = rx[i++];
+                frame_count++;
+                continue;
+            }
+            ubx->header.ck_b = rx[i++];
             // OP GPSV9 sends data with bad checksums this appears to happen because it drops data
             // this has been proven by running it without autoconfig and testing:
             // data coming from OPV9 "GPS+MCU" port the checksum errors happen roughly every 5 to 30 seconds
             // same data coming from OPV9 "GPS Only" port the checksums are always good
             // this also occasionally causes parse_ubx_message() to issue alarms because not all the messages were received
             // see OP GPSV9 comment in parse_ubx_message() for further information
-            if (checksum_ubx_message(ubx)) {
-                gpsRxStats->gpsRxReceived++;
-                proto_state = START;
-                // overwrite PARSER_INCOMPLETE with PARSER_COMPLETE
-                // but don't overwrite PARSER_ERROR with PARSER_COMPLETE
-                // pass PARSER_ERROR to caller if it happens even once
-                // only pass PARSER_COMPLETE back to caller if we parsed a full set of GPS data
-                // that allows the caller to know if we are parsing GPS data
-                // or just other packets for some reason (mis-configuration)
-                if (parse_ubx_message(ubx, GpsData) == GPSPOSITIONSENSOR_OBJID
-                    && ret == PARSER_INCOMPLETE) {
-                    ret = PARSER_COMPLETE;
-                }
-            } else {
+            {
+                uint8_t header[UBX_HEADER_LEN] = { ubx->header.class, ubx->header.id, ubx->header.len & 0xff, ubx->header.len >> 8 };
+                ck_a = 0;
+                ck_b = 0;
+                checksum_ubx_span(header, UBX_HEADER_LEN, &ck_a, &ck_b);
+                checksum_ubx_span(ubx->payload.payload, ubx->header.len, &ck_a, &ck_b);
+            }
+            if (ubx->header.ck_a != ck_a || ubx->header.ck_b != ck_b) {
                 gpsRxStats->gpsRxChkSumError++;
                 restart_state = RESTART_WITH_ERROR;
                 break;
             }
+            gpsRxStats->gpsRxReceived++;
+            proto_state = START;
+            if (parse_ubx_message(ubx->header.class, ubx->header.id, &ubx->payload, GpsData) == GPSPOSITIONSENSOR_OBJID
+                && ret == PARSER_INCOMPLETE) {
+                ret = PARSER_COMPLETE;
+            }
             continue;
         default:
+            proto_state = START;
             continue;
         }
 
@@ -236,9 +289,7 @@ int parse_ubx_stream(uint8_t *rx, uint16_t len, char *gps_rx_buffer, GPSPosition
         if (restart_state == RESTART_WITH_ERROR) {
             ret = PARSER_ERROR; // inform caller that we found at least one error (along with 0 or more good packets)
         }
-        rx  += restart_index; // restart parsing just past the most recent SYNC1
-        len -= restart_index;
-        i    = 0;
+        i = restart_index; // restart parsing just past the most recent SYNC1
         proto_state = START;
     }
 
@@ -275,42 +326,12 @@ bool check_msgtracker(uint32_t tow, uint8_t msg_flag)
     return true;
 }
 
-bool checksum_ubx_message(struct UBXPacket *ubx)
-{
-    int i;
-    uint8_t ck_a, ck_b;
-
-    ck_a  = ubx->header.class;
-    ck_b  = ck_a;
-
-    ck_a += ubx->header.id;
-    ck_b += ck_a;
-
-    ck_a += ubx->header.len & 0xff;
-    ck_b += ck_a;
-
-    ck_a += ubx->header.len >> 8;
-    ck_b += ck_a;
-
-    for (i = 0; i < ubx->header.len; i++) {
-        ck_a += ubx->payload.payload[i];
-        ck_b += ck_a;
-    }
-
-    if (ubx->header.ck_a == ck_a &&
-        ubx->header.ck_b == ck_b) {
-        return true;
-    } else {
-        return false;
-    }
-}
-
-static void parse_ubx_nav_posllh(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition)
+static void parse_ubx_nav_posllh(UBXPayload *payload, GPSPositionSensorData *GpsPosition)
 {
     if (usePvt) {
         return;
     }
-    struct UBX_NAV_POSLLH *posllh = &ubx->payload.nav_posllh;
+    struct UBX_NAV_POSLLH *posllh = &payload->nav_posllh;
 
     if (check_msgtracker(posllh->iTOW, POSLLH_RECEIVED)) {
         if (GpsPosition->Status != GPSPOSITIONSENSOR_STATUS_NOFIX) {
@@ -322,12 +343,12 @@ static void parse_ubx_nav_posllh(struct UBXPacket *ubx, GPSPositionSensorData *G
     }
 }
 
-static void parse_ubx_nav_sol(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition)
+static void parse_ubx_nav_sol(UBXPayload *payload, GPSPositionSensorData *GpsPosition)
 {
     if (usePvt) {
         return;
     }
-    struct UBX_NAV_SOL *sol = &ubx->payload.nav_sol;
+    struct UBX_NAV_SOL *sol = &payload->nav_sol;
     if (check_msgtracker(sol->iTOW, SOL_RECEIVED)) {
         GpsPosition->Satellites = sol->numSV;
 
@@ -347,9 +368,9 @@ static void parse_ubx_nav_sol(struct UBXPacket *ubx, GPSPositionSensorData *GpsP
     }
 }
 
-static void parse_ubx_nav_dop(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition)
+static void parse_ubx_nav_dop(UBXPayload *payload, GPSPositionSensorData *GpsPosition)
 {
-    struct UBX_NAV_DOP *dop = &ubx->payload.nav_dop;
+    struct UBX_NAV_DOP *dop = &payload->nav_dop;
 
     if (check_msgtracker(dop->iTOW, DOP_RECEIVED)) {
         GpsPosition->HDOP = (float)dop->hDOP * 0.01f;
@@ -358,13 +379,13 @@ static void parse_ubx_nav_dop(struct UBXPacket *ubx, GPSPositionSensorData *GpsP
     }
 }
 
-static void parse_ubx_nav_velned(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition)
+static void parse_ubx_nav_velned(UBXPayload *payload, GPSPositionSensorData *GpsPosition)
 {
     if (usePvt) {
         return;
     }
     GPSVelocitySensorData GpsVelocity;
-    struct UBX_NAV_VELNED *velned = &ubx->payload.nav_velned;
+    struct UBX_NAV_VELNED *velned = &payload->nav_velned;
     if (check_msgtracker(velned->iTOW, VELNED_RECEIVED)) {
         if (GpsPosition->Status != GPSPOSITIONSENSOR_STATUS_NOFIX) {
             GpsVelocity.North        = (float)velned->velN / 100.0f;
@@ -378,12 +399,12 @@ static void parse_ubx_nav_velned(struct UBXPacket *ubx, GPSPositionSensorData *G
 }
 
 #if !defined(PIOS_GPS_MINIMAL)
-static void parse_ubx_nav_pvt(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition)
+static void parse_ubx_nav_pvt(UBXPayload *payload, GPSPositionSensorData *GpsPosition)
 {
     lastPvtTime = PIOS_DELAY_GetuS();
 
     GPSVelocitySensorData GpsVelocity;
-    struct UBX_NAV_PVT *pvt = &ubx->payload.nav_pvt;
+    struct UBX_NAV_PVT *pvt = &payload->nav_pvt;
     check_msgtracker(pvt->iTOW, (ALL_RECEIVED));
 
     GpsVelocity.North = (float)pvt->velN * 0.001f;
@@ -421,13 +442,13 @@ static void parse_ubx_nav_pvt(struct UBXPacket *ubx, GPSPositionSensorData *GpsP
     }
 }
 
-static void parse_ubx_nav_timeutc(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
+static void parse_ubx_nav_timeutc(UBXPayload *payload, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
 {
     if (usePvt) {
         return;
     }
 
-    struct UBX_NAV_TIMEUTC *timeutc = &ubx->payload.nav_timeutc;
+    struct UBX_NAV_TIMEUTC *timeutc = &payload->nav_timeutc;
     // Test if time is valid
     if ((timeutc->valid & TIMEUTC_VALIDTOW) && (timeutc->valid & TIMEUTC_VALIDWKN)) {
         // Time is valid, set GpsTime
@@ -447,11 +468,11 @@ static void parse_ubx_nav_timeutc(struct UBXPacket *ubx, __attribute__((unused))
     }
 }
 
-static void parse_ubx_nav_svinfo(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
+static void parse_ubx_nav_svinfo(UBXPayload *payload, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
 {
     uint8_t chan;
     GPSSatellitesData svdata;
-    struct UBX_NAV_SVINFO *svinfo = &ubx->payload.nav_svinfo;
+    struct UBX_NAV_SVINFO *svinfo = &payload->nav_svinfo;
 
     svdata.SatsInView = 0;
 
@@ -488,23 +509,23 @@ static void parse_ubx_nav_svinfo(struct UBXPacket *ubx, __attribute__((unused))
     GPSSatellitesSet(&svdata);
 }
 
-static void parse_ubx_ack_ack(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
+static void parse_ubx_ack_ack(UBXPayload *payload, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
 {
-    struct UBX_ACK_ACK *ack_ack = &ubx->payload.ack_ack;
+    struct UBX_ACK_ACK *ack_ack = &payload->ack_ack;
 
     ubxLastAck = *ack_ack;
 }
 
-static void parse_ubx_ack_nak(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
+static void parse_ubx_ack_nak(UBXPayload *payload, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
 {
-    struct UBX_ACK_NAK *ack_nak = &ubx->payload.ack_nak;
+    struct UBX_ACK_NAK *ack_nak = &payload->ack_nak;
 
     ubxLastNak = *ack_nak;
 }
 
-static void parse_ubx_mon_ver(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
+static void parse_ubx_mon_ver(UBXPayload *payload, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
 {
-    struct UBX_MON_VER *mon_ver = &ubx->payload.mon_ver;
+    struct UBX_MON_VER *mon_ver = &payload->mon_ver;
 
     ubxHwVersion  = atoi(mon_ver->hwVersion);
     ubxSensorType = (ubxHwVersion >= UBX_HW_VERSION_8) ? GPSPOSITIONSENSOR_SENSORTYPE_UBX8 :
@@ -514,9 +535,9 @@ static void parse_ubx_mon_ver(struct UBXPacket *ubx, __attribute__((unused)) GPS
     GPSPositionSensorSensorTypeSet((uint8_t *)&ubxSensorType);
 }
 
-static void parse_ubx_op_sys(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
+static void parse_ubx_op_sys(UBXPayload *payload, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
 {
-    struct UBX_OP_SYSINFO *sysinfo = &ubx->payload.op_sysinfo;
+    struct UBX_OP_SYSINFO *sysinfo = &payload->op_sysinfo;
     GPSExtendedStatusData data;
 
     data.FlightTime   = sysinfo->flightTime;
@@ -529,12 +550,12 @@ static void parse_ubx_op_sys(struct UBXPacket *ubx, __attribute__((unused)) GPSP
     GPSExtendedStatusSet(&data);
 }
 
-static void parse_ubx_op_mag(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
+static void parse_ubx_op_mag(UBXPayload *payload, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
 {
     if (!useMag) {
         return;
     }
-    struct UBX_OP_MAG *mag = &ubx->payload.op_mag;
+    struct UBX_OP_MAG *mag = &payload->op_mag;
     float mags[3] = { mag->x, mag->y, mag->z };
     auxmagsupport_publish_samples(mags, AUXMAGSENSOR_STATUS_OK);
 }
@@ -542,7 +563,7 @@ static void parse_ubx_op_mag(struct UBXPacket *ubx, __attribute__((unused)) GPSP
 
 // UBX message parser
 // returns UAVObjectID if a UAVObject structure is ready for further processing
-uint32_t parse_ubx_message(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition)
+uint32_t parse_ubx_message(uint8_t msgClass, uint8_t msgID, UBXPayload *payload, GPSPositionSensorData *GpsPosition)
 {
     uint32_t id = 0;
     static bool ubxInitialized = false;
@@ -558,8 +579,8 @@ uint32_t parse_ubx_message(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosi
     usePvt = (lastPvtTime) && (PIOS_DELAY_GetuSSince(lastPvtTime) < UBX_PVT_TIMEOUT * 1000);
     for (uint8_t i = 0; i < UBX_HANDLER_TABLE_SIZE; i++) {
         const ubx_message_handler *handler = &ubx_handler_table[i];
-        if (handler->msgClass == ubx->header.class && handler->msgID == ubx->header.id) {
-            handler->handler(ubx, GpsPosition);
+        if (handler->msgClass == msgClass && handler->msgID == msgID) {
+            handler->handler(payload, GpsPosition);
             break;
         }
     }
@@ -671,8 +671,7 @@ extern GPSPositionSensorSensorTypeOptions ubxSensorType;
 extern struct UBX_ACK_ACK ubxLastAck;
 extern struct UBX_ACK_NAK ubxLastNak;
 
-bool checksum_ubx_message(struct UBXPacket *);
-uint32_t parse_ubx_message(struct UBXPacket *, GPSPositionSensorData *);
+uint32_t parse_ubx_message(uint8_t msgClass, uint8_t msgID, UBXPayload *, GPSPositionSensorData *);
 
 int parse_ubx_stream(uint8_t *rx, uint16_t len, char *, GPSPositionSensorData *, struct GPS_RX_STATS *);
 void op_gpsv9_load_mag_settings();
@@ -37,18 +37,29 @@
 #include "debuglogentry.h"
 #include "flightstatus.h"
 
+// Number of DebugLogEntry instances used as a window when streaming entries
+#ifndef DEBUGLOG_STREAM_WINDOW
+#define DEBUGLOG_STREAM_WINDOW 8
+#endif
+
 // private variables
 static DebugLogSettingsData settings;
 static DebugLogControlData control;
 static DebugLogStatusData status;
 static FlightStatusData flightstatus;
 static DebugLogEntryData *entry; // would be better on stack but event dispatcher stack might be insufficient
+static uint16_t streamFlight;
+static uint16_t streamAcked;
+static uint16_t streamNext;
+static uint16_t streamEnd;
+static bool streamActive;
 
 // private functions
 static void SettingsUpdatedCb(UAVObjEvent *ev);
 static void ControlUpdatedCb(UAVObjEvent *ev);
 static void StatusUpdatedCb(UAVObjEvent *ev);
 static void FlightStatusUpdatedCb(UAVObjEvent *ev);
+static void StreamEntries(uint16_t flight, uint16_t acked);
 
 int32_t LoggingInitialize(void)
 {
@@ -56,6 +67,9 @@ int32_t LoggingInitialize(void)
     DebugLogControlInitialize();
     DebugLogStatusInitialize();
     DebugLogEntryInitialize();
+    for (uint16_t i = 1; i < DEBUGLOG_STREAM_WINDOW; i++) {
+        DebugLogEntryCreateInstance();
+    }
     FlightStatusInitialize();
     PIOS_DEBUGLOG_Initialize();
     entry = pios_malloc(sizeof(DebugLogEntryData));
@@ -139,10 +153,53 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
         if (armed == FLIGHTSTATUS_ARMED_DISARMED) {
             PIOS_DEBUGLOG_Format();
         }
+        streamActive = false;
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_STREAM) {
+        StreamEntries(control.Flight, control.Entry);
     }
     StatusUpdatedCb(ev);
 }
 
+/**
+ * Push the entries of a flight back to back, keeping at most
+ * DEBUGLOG_STREAM_WINDOW of them unacknowledged. Entry n goes out on
+ * DebugLogEntry instance n % DEBUGLOG_STREAM_WINDOW, so an instance is only
+ * reused once the GCS has acknowledged the entry it carried.
+ * \param[in] flight Flight to stream
+ * \param[in] acked Cumulative ack, all entries before it were received
+ */
+static void StreamEntries(uint16_t flight, uint16_t acked)
+{
+    if (!streamActive || flight != streamFlight || acked <= streamAcked) {
+        // New stream, or the GCS repeated its ack without progress:
+        // go back and resend the window from the first missing entry
+        streamFlight = flight;
+        streamNext   = acked;
+        streamEnd    = UINT16_MAX;
+        streamActive = true;
+    } else if (streamNext < acked) {
+        streamNext = acked;
+    }
+    streamAcked = acked;
+
+    while (streamNext <= streamEnd && streamNext - acked < DEBUGLOG_STREAM_WINDOW) {
+        memset(entry, 0, sizeof(DebugLogEntryData));
+        if (PIOS_DEBUGLOG_Read(entry, flight, streamNext) != 0) {
+            entry->Flight = flight;
+            entry->Entry  = streamNext;
+            entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
+        }
+        if (entry->Type == DEBUGLOGENTRY_TYPE_EMPTY) {
+            // last entry of the flight, nothing to read beyond it
+            streamEnd = streamNext;
+        }
+        DebugLogEntryInstSet(streamNext % DEBUGLOG_STREAM_WINDOW, entry);
+        // DebugLogEntry is sent on manual updates only
+        DebugLogEntryInstUpdated(streamNext % DEBUGLOG_STREAM_WINDOW);
+        streamNext++;
+    }
+}
+
 
 /**
  * @}
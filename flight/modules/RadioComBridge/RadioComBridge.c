@@ -110,6 +110,7 @@ static int32_t UAVTalkSendHandler(uint8_t *buf, int32_t length);
 static int32_t RadioSendHandler(uint8_t *buf, int32_t length);
 static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *rxbuffer, uint8_t count);
 static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *rxbuffer, uint8_t count);
+static UAVTalkRelayAction RadioObjectFilter(uint32_t objId);
 static void objectPersistenceUpdatedCb(UAVObjEvent *objEv);
 static void registerObject(UAVObjHandle obj);
 
@@ -654,34 +655,45 @@ static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConn
         if (state == UAVTALK_STATE_COMPLETE) {
             // We only want to unpack certain objects from the remote modem
             // Similarly we only want to relay certain objects to the telemetry port
-            uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
-            switch (objId) {
-            case OPLINKSTATUS_OBJID:
-            case OPLINKSETTINGS_OBJID:
-            case MetaObjectId(OPLINKSTATUS_OBJID):
-            case MetaObjectId(OPLINKSETTINGS_OBJID):
-                // Ignore object...
-                // These objects are shadowed by the modem and are not transmitted to the telemetry port
-                // - OPLINKSTATUS_OBJID : ground station will receive the OPLM link status instead
-                // - OPLINKSETTINGS_OBJID : ground station will read and write the OPLM settings instead
-                break;
-            case OPLINKRECEIVER_OBJID:
-            case MetaObjectId(OPLINKRECEIVER_OBJID):
-                // Receive object locally
-                // These objects are received by the modem and are not transmitted to the telemetry port
-                // - OPLINKRECEIVER_OBJID : not sure why
-                // some objects will send back a response to the remote modem
-                UAVTalkReceiveObject(inConnectionHandle);
-                break;
-            default:
-                // all other packets are relayed to the telemetry port
-                UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
-                break;
-            }
+            // Objects of batch packets are filtered one by one
+            UAVTalkRelayPacketFiltered(inConnectionHandle, outConnectionHandle, &RadioObjectFilter);
         }
     }
 }
 
+/**
+ * @brief Select what is done with an object received from the remote modem.
+ *
+ * @param[in] objId  The object ID.
+ * @return The relay action for the object.
+ */
+static UAVTalkRelayAction RadioObjectFilter(uint32_t objId)
+{
+    switch (objId) {
+    case OPLINKSTATUS_OBJID:
+    case OPLINKSETTINGS_OBJID:
+    case MetaObjectId(OPLINKSTATUS_OBJID):
+    case MetaObjectId(OPLINKSETTINGS_OBJID):
+        // Ignore object...
+        // These objects are shadowed by the modem and are not transmitted to the telemetry port
+        // - OPLINKSTATUS_OBJID : ground station will receive the OPLM link status instead
+        // - OPLINKSETTINGS_OBJID : ground station will read and write the OPLM settings instead
+        return UAVTALK_RELAY_DROP;
+
+    case OPLINKRECEIVER_OBJID:
+    case MetaObjectId(OPLINKRECEIVER_OBJID):
+        // Receive object locally
+        // These objects are received by the modem and are not transmitted to the telemetry port
+        // - OPLINKRECEIVER_OBJID : not sure why
+        // some objects will send back a response to the remote modem
+        return UAVTALK_RELAY_RECEIVE;
+
+    default:
+        // all other packets are relayed to the telemetry port
+        return UAVTALK_RELAY_FORWARD;
+    }
+}
+
 /**
  * @brief Callback that is called when the ObjectPersistence UAVObject is changed.
  * @param[in] objEv  The event that precipitated the callback.
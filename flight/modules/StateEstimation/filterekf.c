@@ -71,6 +71,8 @@ struct data {
     bool inited;
 
     PiOSDeltatimeConfig dtconfig;
+
+    insgps_handle_t     ekf;
 };
 
 // Private variables
@@ -86,6 +88,7 @@ static filterResult filter(stateFilter *self, stateEstimation *state);
 static inline bool invalid_var(float data);
 
 static void globalInit(void);
+static int32_t allocData(stateFilter *handle);
 
 
 static void globalInit(void)
@@ -98,21 +101,31 @@ static void globalInit(void)
     }
 }
 
+static int32_t allocData(stateFilter *handle)
+{
+    struct data *this = (struct data *)pios_malloc(sizeof(struct data));
+
+    // every filter runs its own instance of the EKF
+    PIOS_Assert(this);
+    this->ekf = INSGPSCreate();
+    PIOS_Assert(this->ekf);
+    handle->localdata = this;
+    return STACK_REQUIRED;
+}
+
 int32_t filterEKF13iInitialize(stateFilter *handle)
 {
     globalInit();
     handle->init      = &init13i;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
-    return STACK_REQUIRED;
+    return allocData(handle);
 }
 int32_t filterEKF13Initialize(stateFilter *handle)
 {
     globalInit();
     handle->init      = &init13;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
-    return STACK_REQUIRED;
+    return allocData(handle);
 }
 // XXX
 // TODO: Until the 16 state EKF is implemented, run 13 state, so compilation runs through
@@ -122,16 +135,14 @@ int32_t filterEKF16iInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &init13i;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
-    return STACK_REQUIRED;
+    return allocData(handle);
 }
 int32_t filterEKF16Initialize(stateFilter *handle)
 {
     globalInit();
     handle->init      = &init13;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
-    return STACK_REQUIRED;
+    return allocData(handle);
 }
 
 
@@ -195,6 +206,7 @@ static int32_t maininit(stateFilter *self)
 static filterResult filter(stateFilter *self, stateEstimation *state)
 {
     struct data *this    = (struct data *)self->localdata;
+    const struct NavStruct *nav = INSGetNav(this->ekf);
 
     const float zeros[3] = { 0.0f, 0.0f, 0.0f };
 
@@ -239,30 +251,30 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
         // Don't initialize until all sensors are read
         if (this->init_stage == 0) {
             // Reset the INS algorithm
-            INSGPSInit();
+            INSGPSInit(this->ekf);
             // variance is measured in mGaus, but internally the EKF works with a normalized  vector. Scale down by Be^2
             float Be2 = this->homeLocation.Be[0] * this->homeLocation.Be[0] + this->homeLocation.Be[1] * this->homeLocation.Be[1] + this->homeLocation.Be[2] * this->homeLocation.Be[2];
-            INSSetMagVar((float[3]) { this->ekfConfiguration.R.MagX / Be2,
-                                      this->ekfConfiguration.R.MagY / Be2,
-                                      this->ekfConfiguration.R.MagZ / Be2 }
+            INSSetMagVar(this->ekf, (float[3]) { this->ekfConfiguration.R.MagX / Be2,
+                                                 this->ekfConfiguration.R.MagY / Be2,
+                                                 this->ekfConfiguration.R.MagZ / Be2 }
                          );
-            INSSetAccelVar((float[3]) { this->ekfConfiguration.Q.AccelX,
-                                        this->ekfConfiguration.Q.AccelY,
-                                        this->ekfConfiguration.Q.AccelZ }
+            INSSetAccelVar(this->ekf, (float[3]) { this->ekfConfiguration.Q.AccelX,
+                                                   this->ekfConfiguration.Q.AccelY,
+                                                   this->ekfConfiguration.Q.AccelZ }
                            );
-            INSSetGyroVar((float[3]) { this->ekfConfiguration.Q.GyroX,
-                                       this->ekfConfiguration.Q.GyroY,
-                                       this->ekfConfiguration.Q.GyroZ }
+            INSSetGyroVar(this->ekf, (float[3]) { this->ekfConfiguration.Q.GyroX,
+                                                  this->ekfConfiguration.Q.GyroY,
+                                                  this->ekfConfiguration.Q.GyroZ }
                           );
-            INSSetGyroBiasVar((float[3]) { this->ekfConfiguration.Q.GyroDriftX,
-                                           this->ekfConfiguration.Q.GyroDriftY,
-                                           this->ekfConfiguration.Q.GyroDriftZ }
+            INSSetGyroBiasVar(this->ekf, (float[3]) { this->ekfConfiguration.Q.GyroDriftX,
+                                                      this->ekfConfiguration.Q.GyroDriftY,
+                                                      this->ekfConfiguration.Q.GyroDriftZ }
                               );
-            INSSetBaroVar(this->ekfConfiguration.R.BaroZ);
+            INSSetBaroVar(this->ekf, this->ekfConfiguration.R.BaroZ);
 
             // Initialize the gyro bias
             float gyro_bias[3] = { 0.0f, 0.0f, 0.0f };
-            INSSetGyroBias(gyro_bias);
+            INSSetGyroBias(this->ekf, gyro_bias);
 
             AttitudeStateData attitudeState;
             AttitudeStateGet(&attitudeState);
@@ -292,30 +304,30 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 
             RPY2Quaternion(&attitudeState.Roll, this->work.attitude);
 
-            INSSetState(this->work.pos, (float *)zeros, this->work.attitude, (float *)zeros, (float *)zeros);
+            INSSetState(this->ekf, this->work.pos, (float *)zeros, this->work.attitude, (float *)zeros, (float *)zeros);
 
-            INSResetP(EKFConfigurationPToArray(this->ekfConfiguration.P));
+            INSResetP(this->ekf, EKFConfigurationPToArray(this->ekfConfiguration.P));
         } else {
             // Run prediction a bit before any corrections
 
             float gyros[3] = { DEG2RAD(this->work.gyro[0]), DEG2RAD(this->work.gyro[1]), DEG2RAD(this->work.gyro[2]) };
-            INSStatePrediction(gyros, this->work.accel, dT);
+            INSStatePrediction(this->ekf, gyros, this->work.accel, dT);
 
             // Copy the attitude into the state
             // NOTE: updating gyr correctly is valid, because this code is reached only when SENSORUPDATES_gyro is already true
-            state->attitude[0] = Nav.q[0];
-            state->attitude[1] = Nav.q[1];
-            state->attitude[2] = Nav.q[2];
-            state->attitude[3] = Nav.q[3];
-            state->gyro[0]    -= RAD2DEG(Nav.gyro_bias[0]);
-            state->gyro[1]    -= RAD2DEG(Nav.gyro_bias[1]);
-            state->gyro[2]    -= RAD2DEG(Nav.gyro_bias[2]);
-            state->pos[0]   = Nav.Pos[0];
-            state->pos[1]   = Nav.Pos[1];
-            state->pos[2]   = Nav.Pos[2];
-            state->vel[0]   = Nav.Vel[0];
-            state->vel[1]   = Nav.Vel[1];
-            state->vel[2]   = Nav.Vel[2];
+            state->attitude[0] = nav->q[0];
+            state->attitude[1] = nav->q[1];
+            state->attitude[2] = nav->q[2];
+            state->attitude[3] = nav->q[3];
+            state->gyro[0]    -= RAD2DEG(nav->gyro_bias[0]);
+            state->gyro[1]    -= RAD2DEG(nav->gyro_bias[1]);
+            state->gyro[2]    -= RAD2DEG(nav->gyro_bias[2]);
+            state->pos[0]   = nav->Pos[0];
+            state->pos[1]   = nav->Pos[1];
+            state->pos[2]   = nav->Pos[2];
+            state->vel[0]   = nav->Vel[0];
+            state->vel[1]   = nav->Vel[1];
+            state->vel[2]   = nav->Vel[2];
             state->updated |= SENSORUPDATES_attitude | SENSORUPDATES_pos | SENSORUPDATES_vel;
         }
 
@@ -334,27 +346,27 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     float gyros[3] = { DEG2RAD(this->work.gyro[0]), DEG2RAD(this->work.gyro[1]), DEG2RAD(this->work.gyro[2]) };
 
     // Advance the state estimate
-    INSStatePrediction(gyros, this->work.accel, dT);
+    INSStatePrediction(this->ekf, gyros, this->work.accel, dT);
 
     // Copy the attitude into the state
     // NOTE: updating gyr correctly is valid, because this code is reached only when SENSORUPDATES_gyro is already true
-    state->attitude[0] = Nav.q[0];
-    state->attitude[1] = Nav.q[1];
-    state->attitude[2] = Nav.q[2];
-    state->attitude[3] = Nav.q[3];
-    state->gyro[0]    -= RAD2DEG(Nav.gyro_bias[0]);
-    state->gyro[1]    -= RAD2DEG(Nav.gyro_bias[1]);
-    state->gyro[2]    -= RAD2DEG(Nav.gyro_bias[2]);
-    state->pos[0]   = Nav.Pos[0];
-    state->pos[1]   = Nav.Pos[1];
-    state->pos[2]   = Nav.Pos[2];
-    state->vel[0]   = Nav.Vel[0];
-    state->vel[1]   = Nav.Vel[1];
-    state->vel[2]   = Nav.Vel[2];
+    state->attitude[0] = nav->q[0];
+    state->attitude[1] = nav->q[1];
+    state->attitude[2] = nav->q[2];
+    state->attitude[3] = nav->q[3];
+    state->gyro[0]    -= RAD2DEG(nav->gyro_bias[0]);
+    state->gyro[1]    -= RAD2DEG(nav->gyro_bias[1]);
+    state->gyro[2]    -= RAD2DEG(nav->gyro_bias[2]);
+    state->pos[0]   = nav->Pos[0];
+    state->pos[1]   = nav->Pos[1];
+    state->pos[2]   = nav->Pos[2];
+    state->vel[0]   = nav->Vel[0];
+    state->vel[1]   = nav->Vel[1];
+    state->vel[2]   = nav->Vel[2];
     state->updated |= SENSORUPDATES_attitude | SENSORUPDATES_pos | SENSORUPDATES_vel;
 
     // Advance the covariance estimate
-    INSCovariancePrediction(dT);
+    INSCovariancePrediction(this->ekf, dT);
 
     if (IS_SET(this->work.updated, SENSORUPDATES_mag)) {
         sensors |= MAG_SENSORS;
@@ -364,22 +376,22 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
         sensors |= BARO_SENSOR;
     }
 
-    INSSetMagNorth(this->homeLocation.Be);
+    INSSetMagNorth(this->ekf, this->homeLocation.Be);
 
     if (!this->usePos) {
         // position and velocity variance used in indoor mode
-        INSSetPosVelVar((float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
+        INSSetPosVelVar(this->ekf, (float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                                this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                                this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
                         (float[3]) { this->ekfConfiguration.FakeR.FakeGPSVelIndoor,
                                      this->ekfConfiguration.FakeR.FakeGPSVelIndoor,
                                      this->ekfConfiguration.FakeR.FakeGPSVelIndoor }
                         );
     } else {
         // position and velocity variance used in outdoor mode
-        INSSetPosVelVar((float[3]) { this->ekfConfiguration.R.GPSPosNorth,
-                                     this->ekfConfiguration.R.GPSPosEast,
-                                     this->ekfConfiguration.R.GPSPosDown },
+        INSSetPosVelVar(this->ekf, (float[3]) { this->ekfConfiguration.R.GPSPosNorth,
+                                                this->ekfConfiguration.R.GPSPosEast,
+                                                this->ekfConfiguration.R.GPSPosDown },
                         (float[3]) { this->ekfConfiguration.R.GPSVelNorth,
                                      this->ekfConfiguration.R.GPSVelEast,
                                      this->ekfConfiguration.R.GPSVelDown }
@@ -397,16 +409,16 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     if (IS_SET(this->work.updated, SENSORUPDATES_airspeed) && ((!IS_SET(this->work.updated, SENSORUPDATES_vel) && !IS_SET(this->work.updated, SENSORUPDATES_pos)) | !this->usePos)) {
         // HACK: feed airspeed into EKF as velocity, treat wind as 1e2 variance
         sensors |= HORIZ_SENSORS | VERT_SENSORS;
-        INSSetPosVelVar((float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
+        INSSetPosVelVar(this->ekf, (float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                                this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                                this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
                         (float[3]) { this->ekfConfiguration.FakeR.FakeGPSVelAirspeed,
                                      this->ekfConfiguration.FakeR.FakeGPSVelAirspeed,
                                      this->ekfConfiguration.FakeR.FakeGPSVelAirspeed }
                         );
         // rotate airspeed vector into NED frame - airspeed is measured in X axis only
         float R[3][3];
-        Quaternion2R(Nav.q, R);
+        Quaternion2R((float *)nav->q, R);
         float vtas[3] = { this->work.airspeed[1], 0.0f, 0.0f };
         rot_mult(R, vtas, this->work.vel);
     }
@@ -416,17 +428,17 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
      * although probably should occur within INS itself
      */
     if (sensors) {
-        INSCorrection(this->work.mag, this->work.pos, this->work.vel, this->work.baro[0], sensors);
+        INSCorrection(this->ekf, this->work.mag, this->work.pos, this->work.vel, this->work.baro[0], sensors);
     }
 
     EKFStateVarianceData vardata;
     EKFStateVarianceGet(&vardata);
-    INSGetP(EKFStateVariancePToArray(vardata.P));
+    INSGetP(this->ekf, EKFStateVariancePToArray(vardata.P));
     EKFStateVarianceSet(&vardata);
     int t;
     for (t = 0; t < EKFSTATEVARIANCE_P_NUMELEM; t++) {
         if (!IS_REAL(EKFStateVariancePToArray(vardata.P)[t]) || EKFStateVariancePToArray(vardata.P)[t] <= 0.0f) {
-            INSResetP(EKFConfigurationPToArray(this->ekfConfiguration.P));
+            INSResetP(this->ekf, EKFConfigurationPToArray(this->ekfConfiguration.P));
             this->init_stage = -1;
             break;
         }
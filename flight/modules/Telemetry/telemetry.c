@@ -305,6 +305,7 @@ int32_t TelemetryInitialize(void)
         TelemetryInitializeChannel(&localChannel);
         // Initialise UAVTalk
         localChannel.uavTalkCon = UAVTalkInitialize(&transmitLocalData);
+        UAVTalkSetOutputPort(localChannel.uavTalkCon, localChannel.getPort);
     }
 #endif /* ifdef HAS_RADIO */
 
@@ -318,6 +319,7 @@ int32_t TelemetryInitialize(void)
     TelemetryInitializeChannel(&radioChannel);
     // Initialise UAVTalk
     radioChannel.uavTalkCon = UAVTalkInitialize(&transmitRadioData);
+    UAVTalkSetOutputPort(radioChannel.uavTalkCon, radioChannel.getPort);
 
     return 0;
 }
@@ -616,12 +618,20 @@ static void telemetryTxTask(void *parameters)
             // Process event
             processObjEvent(channel, &ev);
         }
+        // send batched updates as soon as both queues are drained
+        if (uxQueueMessagesWaiting(channel->queue) == 0 && uxQueueMessagesWaiting(channel->priorityQueue) == 0) {
+            UAVTalkFlushBatch(channel->uavTalkCon);
+        }
 #else
         // wait on queue for updates (1 tick) then repeat cycle
         if (xQueueReceive(channel->queue, &ev, 1) == pdTRUE) {
             // Process event
             processObjEvent(channel, &ev);
         }
+        // send batched updates as soon as the queue is drained
+        if (uxQueueMessagesWaiting(channel->queue) == 0) {
+            UAVTalkFlushBatch(channel->uavTalkCon);
+        }
 #endif /* PIOS_TELEM_PRIORITY_QUEUE */
     }
 }
@@ -825,6 +835,7 @@ static void updateTelemetryStats()
     GCSTelemetryStatsData gcsStats;
     uint8_t forceUpdate;
     uint8_t connectionTimeout;
+    uint8_t oldStatus;
     uint32_t timeNow;
 
     // Get stats
@@ -877,6 +888,7 @@ static void updateTelemetryStats()
     }
 
     // Update connection state
+    oldStatus   = flightStats.Status;
     forceUpdate = 1;
     if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED) {
         // Wait for connection request
@@ -900,6 +912,17 @@ static void updateTelemetryStats()
         flightStats.Status = FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED;
     }
 
+    // Batch and delta updates only while connected, a GCS that supports them announces it during the handshake
+    if (flightStats.Status != oldStatus) {
+        bool connected = (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED);
+        UAVTalkSetBatching(radioChannel.uavTalkCon, connected);
+        UAVTalkSetDeltaUpdates(radioChannel.uavTalkCon, connected);
+#ifdef HAS_RADIO
+        UAVTalkSetBatching(localChannel.uavTalkCon, connected);
+        UAVTalkSetDeltaUpdates(localChannel.uavTalkCon, connected);
+#endif
+    }
+
     // TODO: check whether is there any error condition worth raising an alarm
     // Disconnection is actually a normal (non)working status so it is not raising alarms anymore.
     if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
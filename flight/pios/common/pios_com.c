@@ -501,6 +501,76 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
     return len;
 }
 
+/**
+ * Reserves a contiguous region of the tx buffer so that a packet can be built in place
+ * On success the port stays locked until PIOS_COM_CommitTxBuffer() is called
+ * \param[in] port COM port
+ * \param[in] len number of bytes to reserve
+ * \return pointer to the reserved region on success
+ * \return NULL if port not available, mutex can't be taken or no contiguous
+ *         region of len bytes is free, caller should fall back to PIOS_COM_SendBuffer()
+ */
+uint8_t *PIOS_COM_ReserveTxBuffer(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        return NULL;
+    }
+    PIOS_Assert(com_dev->has_tx);
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (xSemaphoreTake(com_dev->sendbuffer_sem, 5) != pdTRUE) {
+        return NULL;
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+    uint8_t *region = NULL;
+    /* A disconnected device is handled as a data sink by PIOS_COM_SendBuffer() */
+    if (!com_dev->driver->available || (com_dev->driver->available(com_dev->lower_id) & COM_AVAILABLE_TX)) {
+        region = fifoBuf_reserveData(&com_dev->tx, len);
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (!region) {
+        xSemaphoreGive(com_dev->sendbuffer_sem);
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+    return region;
+}
+
+/**
+ * Commits the data written to a region returned by PIOS_COM_ReserveTxBuffer()
+ * and starts the transmission
+ * \param[in] port COM port
+ * \param[in] len number of bytes written, zero discards the reservation
+ * \return -1 if port not available
+ * \return number of bytes committed on success
+ */
+int32_t PIOS_COM_CommitTxBuffer(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        return -1;
+    }
+
+    if (len > 0) {
+        fifoBuf_commitData(&com_dev->tx, len);
+
+        /* More data has been put in the tx buffer, make sure the tx is started */
+        if (com_dev->driver->tx_start) {
+            com_dev->driver->tx_start(com_dev->lower_id,
+                                      fifoBuf_getUsed(&com_dev->tx));
+        }
+    }
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreGive(com_dev->sendbuffer_sem);
+#endif /* PIOS_INCLUDE_FREERTOS */
+    return len;
+}
+
 /**
  * Sends a single character over given port
  * \param[in] port COM port
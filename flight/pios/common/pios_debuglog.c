@@ -64,6 +64,29 @@ static uint8_t next_read_buffer_index;
 
 static uint32_t used_buffer_space = 0;
 
+// Compressed entries pack many object updates as records. Each record refers
+// to a slot of the per entry object table and carries its data XORed with the
+// previous update of the same object in that entry, stored as runs of
+// unchanged bytes and literals. Every entry decodes on its own.
+#define LOG_COMPRESS_MAX_SLOTS 16
+#ifndef PIOS_DEBUGLOG_REFERENCE_SIZE
+#define PIOS_DEBUGLOG_REFERENCE_SIZE 512
+#endif
+#define LOG_COMPRESS_RUN       0x80
+#define LOG_COMPRESS_MAX_TOKEN 0x80
+
+struct log_slot {
+    uint32_t objid;
+    uint16_t instid;
+    uint16_t size;
+    uint8_t  *reference; // previous update, NULL if the arena had no room left
+};
+static struct log_slot slots[LOG_COMPRESS_MAX_SLOTS];
+static uint8_t reference_arena[PIOS_DEBUGLOG_REFERENCE_SIZE];
+static uint8_t slots_used;
+static uint16_t reference_used;
+static uint32_t last_record_time;
+
 #define CBTASK_PRIORITY   CALLBACK_TASK_AUXILIARY
 #define CALLBACK_PRIORITY CALLBACK_PRIORITY_LOW
 #define CB_TIMEOUT        100
@@ -72,6 +95,11 @@ static DelayedCallbackInfo *callbackHandle;
 
 /* Private Function Prototypes */
 static void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
+static bool compress_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
+static bool compress_runs(uint32_t *pos, size_t size, const uint8_t *data, const uint8_t *reference);
+static bool put_byte(uint32_t *pos, uint8_t value);
+static bool put_varint(uint32_t *pos, uint32_t value);
+static void enqueue_raw(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
 static bool write_current_buffer();
 static void writeTask();
 static uint8_t get_blocks_free();
@@ -239,41 +267,192 @@ void PIOS_DEBUGLOG_Format(void)
 
 void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
 {
-    DebugLogEntryData *entry;
+    if (compress_data(objid, instid, size, data)) {
+        return;
+    }
+    // the record does not fit into the current entry, start a new one
+    if (used_buffer_space) {
+        if (!write_current_buffer()) {
+            return;
+        }
+        if (compress_data(objid, instid, size, data)) {
+            return;
+        }
+    }
+    // too large for a compressed entry, store it on its own
+    enqueue_raw(objid, instid, size, data);
+}
+
+/**
+ * @brief Append an object update as a record to the current compressed entry
+ * @return false if the record does not fit, the entry is left unchanged
+ */
+static bool compress_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
+{
+    uint32_t now = PIOS_DELAY_GetuS();
+    uint32_t pos = used_buffer_space;
+    uint8_t prev_slots_used = slots_used;
+    uint16_t prev_reference_used = reference_used;
+    struct log_slot *slot;
+    uint8_t index;
+
+    if (size > LOG_ENTRY_MAX_DATA_SIZE) {
+        return false;
+    }
 
-    // start a new block
     if (!used_buffer_space) {
-        entry = current_buffer;
         memset(current_buffer->Data, 0xff, sizeof(current_buffer->Data));
-        used_buffer_space += size;
-    } else {
-        // if an instance is being filled and there is enough space, does enqueues new data.
-        if (used_buffer_space + size + LOG_ENTRY_HEADER_SIZE > LOG_ENTRY_MAX_DATA_SIZE) {
-            current_buffer->Type = DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS;
-            if (!write_current_buffer()) {
-                return;
+        current_buffer->Flight     = flightnum;
+        current_buffer->FlightTime = now;
+        current_buffer->Entry      = lognum;
+        current_buffer->Type       = DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS;
+        current_buffer->ObjectID   = 0;
+        current_buffer->InstanceID = 0;
+        current_buffer->Size       = 0;
+        slots_used       = 0;
+        reference_used   = 0;
+        last_record_time = now;
+    } else if (current_buffer->Type != DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS) {
+        return false;
+    }
+
+    for (index = 0; index < slots_used; index++) {
+        if (slots[index].objid == objid && slots[index].instid == instid) {
+            break;
+        }
+    }
+    slot = &slots[index];
+
+    if (index == slots_used) {
+        // first update of this object in the entry, define a new slot
+        if (slots_used >= LOG_COMPRESS_MAX_SLOTS) {
+            return false;
+        }
+        slot->objid     = objid;
+        slot->instid    = instid;
+        slot->size      = size;
+        slot->reference = NULL;
+        if (reference_used + size <= PIOS_DEBUGLOG_REFERENCE_SIZE) {
+            slot->reference = &reference_arena[reference_used];
+            memset(slot->reference, 0, size);
+            reference_used += size;
+        }
+        slots_used++;
+        if (!put_byte(&pos, index) ||
+            !put_byte(&pos, objid) || !put_byte(&pos, objid >> 8) ||
+            !put_byte(&pos, objid >> 16) || !put_byte(&pos, objid >> 24) ||
+            !put_byte(&pos, instid) || !put_byte(&pos, instid >> 8) ||
+            !put_varint(&pos, (size << 1) | (slot->reference != NULL))) {
+            goto rollback;
+        }
+    } else if (!put_byte(&pos, index)) {
+        goto rollback;
+    }
+
+    if (!put_varint(&pos, now - last_record_time) ||
+        !compress_runs(&pos, size, data, slot->reference)) {
+        goto rollback;
+    }
+
+    if (slot->reference) {
+        memcpy(slot->reference, data, size);
+    }
+    last_record_time     = now;
+    used_buffer_space    = pos;
+    current_buffer->Size = pos;
+    return true;
+
+rollback:
+    memset(&current_buffer->Data[used_buffer_space], 0xff, pos - used_buffer_space);
+    slots_used     = prev_slots_used;
+    reference_used = prev_reference_used;
+    return false;
+}
+
+/**
+ * @brief Encode data XORed with reference as runs of unchanged bytes and literals
+ * @param[in] reference previous update, NULL to encode the data as is
+ */
+static bool compress_runs(uint32_t *pos, size_t size, const uint8_t *data, const uint8_t *reference)
+{
+#define LOG_DELTA(i) (reference ? (data[i] ^ reference[i]) : data[i])
+    uint32_t i = 0;
+
+    while (i < size) {
+        uint32_t len = 0;
+        while (i + len < size && len < LOG_COMPRESS_MAX_TOKEN && !LOG_DELTA(i + len)) {
+            len++;
+        }
+        if (len >= 2 || i + len == size) {
+            if (!put_byte(pos, LOG_COMPRESS_RUN | (len - 1))) {
+                return false;
             }
-            entry = current_buffer;
-            memset(current_buffer->Data, 0xff, sizeof(current_buffer->Data));
-            used_buffer_space += size;
-        } else {
-            entry = (DebugLogEntryData *)&current_buffer->Data[used_buffer_space];
-            used_buffer_space += size + LOG_ENTRY_HEADER_SIZE;
+            i += len;
+            continue;
         }
+
+        // literal up to the next run of at least two unchanged bytes
+        len = 0;
+        while (i + len < size && len < LOG_COMPRESS_MAX_TOKEN &&
+               !(i + len + 1 < size && !LOG_DELTA(i + len) && !LOG_DELTA(i + len + 1))) {
+            len++;
+        }
+        if (!put_byte(pos, len - 1)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < len; j++) {
+            if (!put_byte(pos, LOG_DELTA(i + j))) {
+                return false;
+            }
+        }
+        i += len;
     }
+    return true;
 
-    entry->Flight     = flightnum;
-    entry->FlightTime = PIOS_DELAY_GetuS();
-    entry->Entry = lognum;
-    entry->Type = DEBUGLOGENTRY_TYPE_UAVOBJECT;
-    entry->ObjectID   = objid;
-    entry->InstanceID = instid;
+#undef LOG_DELTA
+}
+
+static bool put_byte(uint32_t *pos, uint8_t value)
+{
+    if (*pos >= LOG_ENTRY_MAX_DATA_SIZE) {
+        return false;
+    }
+    current_buffer->Data[(*pos)++] = value;
+    return true;
+}
+
+static bool put_varint(uint32_t *pos, uint32_t value)
+{
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        if (!put_byte(pos, byte)) {
+            return false;
+        }
+    } while (value);
+    return true;
+}
+
+static void enqueue_raw(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
+{
+    memset(current_buffer->Data, 0xff, sizeof(current_buffer->Data));
+    current_buffer->Flight     = flightnum;
+    current_buffer->FlightTime = PIOS_DELAY_GetuS();
+    current_buffer->Entry      = lognum;
+    current_buffer->Type       = DEBUGLOGENTRY_TYPE_UAVOBJECT;
+    current_buffer->ObjectID   = objid;
+    current_buffer->InstanceID = instid;
     if (size > sizeof(current_buffer->Data)) {
         size = sizeof(current_buffer->Data);
     }
-    entry->Size = size;
+    current_buffer->Size = size;
+    memcpy(current_buffer->Data, data, size);
 
-    memcpy(entry->Data, data, size);
+    // nothing else fits, the entry is written along with the next update
+    used_buffer_space = LOG_ENTRY_MAX_DATA_SIZE;
 }
 
 bool write_current_buffer()
@@ -46,10 +46,16 @@ struct pios_usart_cfg {
     struct stm32_gpio tx;
     struct stm32_gpio dtr;
     struct stm32_irq  irq;
+#if defined(STM32F4XX)
+    struct stm32_dma  dma; /* optional, receive by circular DMA if dma.rx.channel is set */
+#endif
 };
 
 extern int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg);
 extern const struct pios_usart_cfg *PIOS_USART_GetConfig(uint32_t usart_id);
+#if defined(STM32F4XX)
+extern void PIOS_USART_DMA_IRQ_Handler(USART_TypeDef *regs);
+#endif
 
 #endif /* PIOS_USART_PRIV_H */
 
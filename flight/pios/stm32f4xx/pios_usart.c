@@ -38,6 +38,11 @@
 
 #include <pios_usart_priv.h>
 
+/* Size of the ring written by the receive DMA, see pios_usart_cfg.dma */
+#ifndef PIOS_USART_RX_DMA_BUF_LEN
+#define PIOS_USART_RX_DMA_BUF_LEN 128
+#endif
+
 /* Provide a COM driver */
 static void PIOS_USART_ChangeBaud(uint32_t usart_id, uint32_t baud);
 static void PIOS_USART_SetCtrlLine(uint32_t usart_id, uint32_t mask, uint32_t state);
@@ -67,6 +72,9 @@ struct pios_usart_dev {
     uint32_t rx_in_context;
     pios_com_callback tx_out_cb;
     uint32_t tx_out_context;
+
+    uint8_t  *rx_dma_buf; /* NULL unless receiving by DMA */
+    uint16_t rx_dma_tail; /* next byte of the ring to hand to rx_in_cb */
 };
 
 static bool PIOS_USART_validate(struct pios_usart_dev *usart_dev)
@@ -115,6 +123,8 @@ static struct pios_usart_dev *PIOS_USART_alloc(void)
  * each physical IRQ to a specific registered device instance.
  */
 static void PIOS_USART_generic_irq_handler(uint32_t usart_id);
+static int32_t PIOS_USART_RxDMAInit(struct pios_usart_dev *usart_dev);
+static void PIOS_USART_RxDMADrain(struct pios_usart_dev *usart_dev, bool *need_yield);
 
 static uint32_t PIOS_USART_1_id;
 void USART1_IRQHandler(void) __attribute__((alias("PIOS_USART_1_irq_handler")));
@@ -158,6 +168,25 @@ static void PIOS_USART_6_irq_handler(void)
     PIOS_USART_generic_irq_handler(PIOS_USART_6_id);
 }
 
+static uint32_t *PIOS_USART_irq_id(USART_TypeDef *regs)
+{
+    switch ((uint32_t)regs) {
+    case (uint32_t)USART1:
+        return &PIOS_USART_1_id;
+    case (uint32_t)USART2:
+        return &PIOS_USART_2_id;
+    case (uint32_t)USART3:
+        return &PIOS_USART_3_id;
+    case (uint32_t)UART4:
+        return &PIOS_USART_4_id;
+    case (uint32_t)UART5:
+        return &PIOS_USART_5_id;
+    case (uint32_t)USART6:
+        return &PIOS_USART_6_id;
+    }
+    return NULL;
+}
+
 /**
  * Initialise a single USART device
  */
@@ -200,31 +229,25 @@ int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg)
     /* Configure the USART */
     USART_Init(usart_dev->cfg->regs, (USART_InitTypeDef *)&usart_dev->cfg->init);
 
+    /* Receive into a circular DMA buffer if the board provides a stream */
+    if (usart_dev->cfg->dma.rx.channel && PIOS_USART_RxDMAInit(usart_dev) != 0) {
+        goto out_fail;
+    }
+
     *usart_id = (uint32_t)usart_dev;
 
     /* Configure USART Interrupts */
-    switch ((uint32_t)usart_dev->cfg->regs) {
-    case (uint32_t)USART1:
-        PIOS_USART_1_id = (uint32_t)usart_dev;
-        break;
-    case (uint32_t)USART2:
-        PIOS_USART_2_id = (uint32_t)usart_dev;
-        break;
-    case (uint32_t)USART3:
-        PIOS_USART_3_id = (uint32_t)usart_dev;
-        break;
-    case (uint32_t)UART4:
-        PIOS_USART_4_id = (uint32_t)usart_dev;
-        break;
-    case (uint32_t)UART5:
-        PIOS_USART_5_id = (uint32_t)usart_dev;
-        break;
-    case (uint32_t)USART6:
-        PIOS_USART_6_id = (uint32_t)usart_dev;
-        break;
+    uint32_t *irq_id = PIOS_USART_irq_id(usart_dev->cfg->regs);
+    if (irq_id) {
+        *irq_id = (uint32_t)usart_dev;
     }
     NVIC_Init((NVIC_InitTypeDef *)&(usart_dev->cfg->irq.init));
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+    if (usart_dev->rx_dma_buf) {
+        /* Bursts are handed over when the line goes idle */
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_IDLE, ENABLE);
+    } else {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+    }
     USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
 
     // FIXME XXX Clear / reset uart here - sends NUL char else
@@ -246,7 +269,10 @@ static void PIOS_USART_RxStart(uint32_t usart_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+    /* The receive DMA never stops */
+    if (!usart_dev->rx_dma_buf) {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+    }
 }
 static void PIOS_USART_TxStart(uint32_t usart_id, __attribute__((unused)) uint16_t tx_bytes_avail)
 {
@@ -340,16 +366,26 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 
     PIOS_Assert(valid);
 
-    /* Force read of dr after sr to make sure to clear error flags */
     volatile uint16_t sr = usart_dev->cfg->regs->SR;
-    volatile uint8_t dr  = usart_dev->cfg->regs->DR;
-
-    /* Check if RXNE flag is set */
     bool rx_need_yield   = false;
-    if (sr & USART_SR_RXNE) {
-        uint8_t byte = dr;
-        if (usart_dev->rx_in_cb) {
-            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &byte, 1, NULL, &rx_need_yield);
+
+    if (usart_dev->rx_dma_buf) {
+        /* Check if IDLE flag is set, dr is read by the DMA otherwise */
+        if (sr & USART_SR_IDLE) {
+            /* Read of dr after sr clears the flag */
+            (void)usart_dev->cfg->regs->DR;
+            PIOS_USART_RxDMADrain(usart_dev, &rx_need_yield);
+        }
+    } else {
+        /* Force read of dr after sr to make sure to clear error flags */
+        volatile uint8_t dr = usart_dev->cfg->regs->DR;
+
+        /* Check if RXNE flag is set */
+        if (sr & USART_SR_RXNE) {
+            uint8_t byte = dr;
+            if (usart_dev->rx_in_cb) {
+                (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &byte, 1, NULL, &rx_need_yield);
+            }
         }
     }
 
@@ -382,6 +418,94 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 #endif /* PIOS_INCLUDE_FREERTOS */
 }
 
+/**
+ * Start the circular receive DMA into a ring of PIOS_USART_RX_DMA_BUF_LEN bytes.
+ * The ring is drained on idle line and when the DMA is half way or wraps around.
+ */
+static int32_t PIOS_USART_RxDMAInit(struct pios_usart_dev *usart_dev)
+{
+    const struct stm32_dma *dma = &usart_dev->cfg->dma;
+
+    usart_dev->rx_dma_buf = (uint8_t *)pios_malloc(PIOS_USART_RX_DMA_BUF_LEN);
+    if (!usart_dev->rx_dma_buf) {
+        return -1;
+    }
+    usart_dev->rx_dma_tail = 0;
+
+    DMA_DeInit(dma->rx.channel);
+    DMA_InitTypeDef DMAInit = dma->rx.init;
+    DMAInit.DMA_PeripheralBaseAddr = (uint32_t)&usart_dev->cfg->regs->DR;
+    DMAInit.DMA_Memory0BaseAddr    = (uint32_t)usart_dev->rx_dma_buf;
+    DMAInit.DMA_BufferSize = PIOS_USART_RX_DMA_BUF_LEN;
+    DMAInit.DMA_DIR  = DMA_DIR_PeripheralToMemory;
+    DMAInit.DMA_Mode = DMA_Mode_Circular;
+    DMA_Init(dma->rx.channel, &DMAInit); /* channel is actually stream ... */
+
+    DMA_ClearITPendingBit(dma->rx.channel, dma->irq.flags);
+    DMA_ITConfig(dma->rx.channel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    NVIC_Init((NVIC_InitTypeDef *)&dma->irq.init);
+
+    USART_DMACmd(usart_dev->cfg->regs, USART_DMAReq_Rx, ENABLE);
+    DMA_Cmd(dma->rx.channel, ENABLE);
+
+    return 0;
+}
+
+/**
+ * Hand the bytes written by the DMA since the last call to rx_in_cb,
+ * as at most two spans of the ring. Like in the byte interrupt, what
+ * does not fit in the upper layer buffer is dropped.
+ */
+static void PIOS_USART_RxDMADrain(struct pios_usart_dev *usart_dev, bool *need_yield)
+{
+    uint16_t head = PIOS_USART_RX_DMA_BUF_LEN - DMA_GetCurrDataCounter(usart_dev->cfg->dma.rx.channel);
+
+    if (head >= PIOS_USART_RX_DMA_BUF_LEN) {
+        head = 0;
+    }
+
+    while (usart_dev->rx_dma_tail != head) {
+        uint16_t end = (head > usart_dev->rx_dma_tail) ? head : PIOS_USART_RX_DMA_BUF_LEN;
+
+        if (usart_dev->rx_in_cb) {
+            bool yield = false;
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &usart_dev->rx_dma_buf[usart_dev->rx_dma_tail],
+                                        end - usart_dev->rx_dma_tail, NULL, &yield);
+            *need_yield |= yield;
+        }
+        usart_dev->rx_dma_tail = (end == PIOS_USART_RX_DMA_BUF_LEN) ? 0 : end;
+    }
+}
+
+/**
+ * Receive DMA half/full transfer interrupt, to be called by the board
+ * from the handler of the stream given in pios_usart_cfg.dma
+ * \param[in] regs USART the stream is receiving for
+ */
+void PIOS_USART_DMA_IRQ_Handler(USART_TypeDef *regs)
+{
+    uint32_t *irq_id = PIOS_USART_irq_id(regs);
+
+    PIOS_Assert(irq_id);
+
+    struct pios_usart_dev *usart_dev = (struct pios_usart_dev *)*irq_id;
+
+    bool valid = PIOS_USART_validate(usart_dev);
+
+    PIOS_Assert(valid);
+
+    DMA_ClearITPendingBit(usart_dev->cfg->dma.rx.channel, usart_dev->cfg->dma.irq.flags);
+
+    bool rx_need_yield = false;
+    PIOS_USART_RxDMADrain(usart_dev, &rx_need_yield);
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (rx_need_yield) {
+        vPortYield();
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+}
+
 #endif /* PIOS_INCLUDE_USART */
 
 /**
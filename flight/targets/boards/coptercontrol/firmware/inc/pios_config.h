@@ -186,6 +186,12 @@
 /* This can't be too high to stop eventdispatcher thread overflowing */
 #define PIOS_EVENTDISAPTCHER_QUEUE      10
 
+/* Fewer UAVObject data locks to save RAM */
+#define UAVOBJ_DATA_LOCKS               2
+
+/* No keyframe copies for UAVTalk delta updates to save RAM */
+#define UAVTALK_DELTA_SLOTS             0
+
 /* Revolution series */
 /* #define REVOLUTION */
 
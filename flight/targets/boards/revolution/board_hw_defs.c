@@ -792,7 +792,10 @@ static const struct flashfs_logfs_cfg flashfs_internal_cfg = {
 
 /*
  * MAIN USART
+ * Received by DMA2 Stream2, the stream has to interrupt at the USART priority
  */
+void PIOS_USART_main_dma_irq_handler(void);
+void DMA2_Stream2_IRQHandler(void) __attribute__((alias("PIOS_USART_main_dma_irq_handler")));
 static const struct pios_usart_cfg pios_usart_main_cfg = {
     .regs  = USART1,
     .remap = GPIO_AF_USART1,
@@ -832,7 +835,42 @@ static const struct pios_usart_cfg pios_usart_main_cfg = {
             .GPIO_PuPd  = GPIO_PuPd_UP
         },
     },
+    .dma                                       = {
+        .irq                                   = {
+            .flags = (DMA_IT_TCIF2 | DMA_IT_HTIF2),
+            .init  = {
+                .NVIC_IRQChannel    = DMA2_Stream2_IRQn,
+                .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+                .NVIC_IRQChannelSubPriority        = 0,
+                .NVIC_IRQChannelCmd = ENABLE,
+            },
+        },
+        .rx                                    = {
+            .channel = DMA2_Stream2,
+            .init    = {
+                .DMA_Channel            = DMA_Channel_4,
+                .DMA_PeripheralBaseAddr = (uint32_t)&(USART1->DR),
+                .DMA_DIR                = DMA_DIR_PeripheralToMemory,
+                .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+                .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+                .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+                .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+                .DMA_Mode               = DMA_Mode_Circular,
+                .DMA_Priority           = DMA_Priority_Low,
+                .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+                /* .DMA_FIFOThreshold */
+                .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+                .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+            },
+        },
+    },
 };
+
+void PIOS_USART_main_dma_irq_handler(void)
+{
+    /* Call into the generic code to handle the IRQ for this specific device */
+    PIOS_USART_DMA_IRQ_Handler(USART1);
+}
 #endif /* PIOS_INCLUDE_COM_TELEM */
 
 #ifdef PIOS_INCLUDE_DSM
@@ -969,7 +1007,10 @@ static const struct pios_sbus_cfg pios_sbus_cfg = {
 #ifdef PIOS_INCLUDE_COM_FLEXI
 /*
  * FLEXI PORT
+ * Received by DMA1 Stream1, the stream has to interrupt at the USART priority
  */
+void PIOS_USART_flexi_dma_irq_handler(void);
+void DMA1_Stream1_IRQHandler(void) __attribute__((alias("PIOS_USART_flexi_dma_irq_handler")));
 static const struct pios_usart_cfg pios_usart_flexi_cfg = {
     .regs  = USART3,
     .remap = GPIO_AF_USART3,
@@ -1010,8 +1051,43 @@ static const struct pios_usart_cfg pios_usart_flexi_cfg = {
             .GPIO_PuPd  = GPIO_PuPd_UP
         },
     },
+    .dma                                       = {
+        .irq                                   = {
+            .flags = (DMA_IT_TCIF1 | DMA_IT_HTIF1),
+            .init  = {
+                .NVIC_IRQChannel    = DMA1_Stream1_IRQn,
+                .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+                .NVIC_IRQChannelSubPriority        = 0,
+                .NVIC_IRQChannelCmd = ENABLE,
+            },
+        },
+        .rx                                    = {
+            .channel = DMA1_Stream1,
+            .init    = {
+                .DMA_Channel            = DMA_Channel_4,
+                .DMA_PeripheralBaseAddr = (uint32_t)&(USART3->DR),
+                .DMA_DIR                = DMA_DIR_PeripheralToMemory,
+                .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+                .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+                .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+                .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+                .DMA_Mode               = DMA_Mode_Circular,
+                .DMA_Priority           = DMA_Priority_Low,
+                .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+                /* .DMA_FIFOThreshold */
+                .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+                .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+            },
+        },
+    },
 };
 
+void PIOS_USART_flexi_dma_irq_handler(void)
+{
+    /* Call into the generic code to handle the IRQ for this specific device */
+    PIOS_USART_DMA_IRQ_Handler(USART3);
+}
+
 #endif /* PIOS_INCLUDE_COM_FLEXI */
 
 #ifdef PIOS_INCLUDE_DSM
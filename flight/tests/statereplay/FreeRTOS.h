@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       FreeRTOS.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      FreeRTOS replacement, the filters run in a single thread.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* The filters run in a single thread, driven by the replay clock */
+typedef void *xQueueHandle;
+typedef void *xSemaphoreHandle;
+typedef uint32_t portTickType;
+
+#define portMAX_DELAY                   ((portTickType)0xffffffff)
+#define portTICK_RATE_MS                ((portTickType)1)
+#define pdTRUE                          1
+#define pdFALSE                         0
+#define tskIDLE_PRIORITY                0
+
+#define pvPortMalloc(xSize)             (malloc(xSize))
+#define vPortFree(pv)                   (free(pv))
+
+static inline xSemaphoreHandle xSemaphoreCreateRecursiveMutex(void)
+{
+    return (xSemaphoreHandle)1;
+}
+
+static inline int xSemaphoreTakeRecursive(__attribute__((unused)) xSemaphoreHandle x, __attribute__((unused)) portTickType t)
+{
+    return pdTRUE;
+}
+
+static inline int xSemaphoreGiveRecursive(__attribute__((unused)) xSemaphoreHandle x)
+{
+    return pdTRUE;
+}
+
+portTickType xTaskGetTickCount(void);
+
+#endif /* FREERTOS_H */
+
+/**
+ * @}
+ */
@@ -0,0 +1,46 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       openpilot.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Host replacement of the board openpilot.h.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+/* Host replacement of the board openpilot.h for the state estimation replay */
+#include <pios.h>
+
+#include <uavobjectmanager.h>
+
+#include "alarms.h"
+#include <mathmisc.h>
+
+/* Modules are initialized and started by the replay */
+#define MODULE_INITCALL(ifn, sfn)
+
+#endif /* OPENPILOT_H */
+
+/**
+ * @}
+ */
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       pios.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      PiOS replacement with the few functions used by the filters.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "pios_config.h"
+#ifdef PIOS_INCLUDE_FREERTOS
+#include "FreeRTOS.h"
+#endif
+
+#define PIOS_Assert(x) \
+    if (!(x)) { abort(); \
+    }
+#define PIOS_DEBUG_Assert(x)     PIOS_Assert(x)
+#define PIOS_STATIC_ASSERT(test) ((void)sizeof(int[1 - 2 * !(test)]))
+
+#include "pios_mem.h"
+#include <pios_math.h>
+#include <pios_helpers.h>
+#include <pios_delay.h>
+#include <pios_deltatime.h>
+#include <pios_crc.h>
+#include <pios_callbackscheduler.h>
+
+#endif /* PIOS_H */
+
+/**
+ * @}
+ */
@@ -0,0 +1,42 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       pios_mem.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Memory allocation on the host.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_MEM_H
+#define PIOS_MEM_H
+
+#include <stdlib.h>
+
+/* Zeroed, so that replaying the same log always gives the same result */
+#define pios_fastheapmalloc(size) (calloc(1, size))
+#define pios_malloc(size)         (calloc(1, size))
+#define pios_free(p)              (free(p))
+
+#endif /* PIOS_MEM_H */
+
+/**
+ * @}
+ */
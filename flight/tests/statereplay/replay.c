@@ -0,0 +1,319 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       replay.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Drives the unmodified StateEstimation module on the host.
+ *
+ *             The callback scheduler and the system clock are replaced by a
+ *             replay clock, so the filters see the timing of the log and not
+ *             the one of the host, and run as fast as the host allows.
+ *
+ *             Every filter handed to the module is wrapped at link time
+ *             (-Wl,--wrap=filter...Initialize) to measure its execution time.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <time.h>
+
+#include <openpilot.h>
+#include <pios_callbackscheduler.h>
+#include <pios_notify.h>
+
+#include "inc/stateestimation.h"
+#include "statereplay.h"
+
+#include <accelsensor.h>
+#include <attitudesettings.h>
+#include <attitudestate.h>
+#include <flightstatus.h>
+#include <revosettings.h>
+
+// Private constants
+#define MAX_CALLBACKS     4
+#define MAX_FILTERS       16
+#define MAX_RUNS_PER_STEP 64
+
+// Private types
+struct DelayedCallbackInfoStruct {
+    DelayedCallback cb;
+    bool     dispatched;
+    bool     scheduled;
+    uint32_t dueUs;
+};
+
+struct timedFilter {
+    stateFilter  *handle;
+    filterResult (*filter)(stateFilter *self, stateEstimation *state);
+};
+
+// Private variables
+static uint32_t replayTimeUs;
+static struct DelayedCallbackInfoStruct callbacks[MAX_CALLBACKS];
+static uint8_t numCallbacks;
+static struct timedFilter timedFilters[MAX_FILTERS];
+static StateReplayFilterTiming filterTiming[MAX_FILTERS];
+static uint8_t numFilters;
+static int16_t forcedFusionAlgorithm = STATEREPLAY_FUSION_FROM_LOG;
+static bool stateUpdated;
+
+// Private functions
+static void revoSettingsUpdatedCb(UAVObjEvent *ev);
+static void stateUpdatedCb(UAVObjEvent *ev);
+static filterResult timedFilterRun(stateFilter *self, stateEstimation *state);
+static int32_t timeFilter(stateFilter *handle, const char *name, int32_t stack_required);
+static uint64_t nowNs(void);
+
+int32_t StateEstimationInitialize(void);
+int32_t StateEstimationStart(void);
+
+
+int32_t StateReplayInitialize(void)
+{
+    UAVObjInitialize();
+
+    // objects initialized by other modules on the board
+    AlarmsInitialize();
+    AccelSensorInitialize();
+    AttitudeSettingsInitialize();
+    FlightStatusInitialize();
+    AttitudeStateInitialize();
+
+    if (StateEstimationInitialize() != 0) {
+        return -1;
+    }
+
+    RevoSettingsConnectCallback(&revoSettingsUpdatedCb);
+    AttitudeStateConnectCallback(&stateUpdatedCb);
+
+    return StateEstimationStart();
+}
+
+void StateReplaySetFusionAlgorithm(int16_t fusionAlgorithm)
+{
+    forcedFusionAlgorithm = fusionAlgorithm;
+    revoSettingsUpdatedCb(NULL);
+}
+
+int32_t StateReplayUnpack(uint32_t objId, uint16_t instId, const uint8_t *data, uint32_t length)
+{
+    UAVObjHandle obj = UAVObjGetByID(objId);
+
+    if (!obj || UAVObjGetNumBytes(obj) != length) {
+        return -1;
+    }
+    return UAVObjUnpack(obj, instId, data);
+}
+
+bool StateReplayRun(uint32_t timeUs)
+{
+    replayTimeUs = timeUs;
+    stateUpdated = false;
+
+    for (uint8_t i = 0; i < numCallbacks; i++) {
+        struct DelayedCallbackInfoStruct *info = &callbacks[i];
+
+        // the callback dispatches itself as long as there are updated sensors
+        for (uint8_t runs = 0; runs < MAX_RUNS_PER_STEP; runs++) {
+            if (!info->dispatched && !(info->scheduled && (int32_t)(replayTimeUs - info->dueUs) >= 0)) {
+                break;
+            }
+            info->dispatched = false;
+            info->scheduled  = false;
+            info->cb();
+        }
+    }
+    return stateUpdated;
+}
+
+uint8_t StateReplayGetFilterTiming(const StateReplayFilterTiming **timing)
+{
+    *timing = filterTiming;
+    return numFilters;
+}
+
+/**
+ * Keep the fusion algorithm selected on the command line when the log carries RevoSettings
+ */
+static void revoSettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    if (forcedFusionAlgorithm == STATEREPLAY_FUSION_FROM_LOG) {
+        return;
+    }
+
+    RevoSettingsData revoSettings;
+    RevoSettingsGet(&revoSettings);
+    if (revoSettings.FusionAlgorithm != forcedFusionAlgorithm) {
+        revoSettings.FusionAlgorithm = (RevoSettingsFusionAlgorithmOptions)forcedFusionAlgorithm;
+        RevoSettingsSet(&revoSettings);
+    }
+}
+
+static void stateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    stateUpdated = true;
+}
+
+/*
+ * Filter timing
+ */
+static filterResult timedFilterRun(stateFilter *self, stateEstimation *state)
+{
+    for (uint8_t i = 0; i < numFilters; i++) {
+        if (timedFilters[i].handle == self) {
+            uint64_t start = nowNs();
+            filterResult result = timedFilters[i].filter(self, state);
+            uint64_t duration   = nowNs() - start;
+
+            filterTiming[i].calls++;
+            filterTiming[i].totalNs += duration;
+            if (duration > filterTiming[i].maxNs) {
+                filterTiming[i].maxNs = duration;
+            }
+            return result;
+        }
+    }
+    return FILTERRESULT_CRITICAL;
+}
+
+static int32_t timeFilter(stateFilter *handle, const char *name, int32_t stack_required)
+{
+    PIOS_Assert(numFilters < MAX_FILTERS);
+
+    timedFilters[numFilters].handle = handle;
+    timedFilters[numFilters].filter = handle->filter;
+    filterTiming[numFilters].name   = name;
+    handle->filter = &timedFilterRun;
+    numFilters++;
+    return stack_required;
+}
+
+#define TIMED_FILTER_INITIALIZE(fn, name) \
+    int32_t __real_##fn(stateFilter * handle); \
+    int32_t __wrap_##fn(stateFilter * handle); \
+    int32_t __wrap_##fn(stateFilter * handle) \
+    { \
+        return timeFilter(handle, name, __real_##fn(handle)); \
+    }
+
+TIMED_FILTER_INITIALIZE(filterMagInitialize, "mag")
+TIMED_FILTER_INITIALIZE(filterBaroiInitialize, "baroi")
+TIMED_FILTER_INITIALIZE(filterBaroInitialize, "baro")
+TIMED_FILTER_INITIALIZE(filterVelocityInitialize, "velocity")
+TIMED_FILTER_INITIALIZE(filterAltitudeInitialize, "altitude")
+TIMED_FILTER_INITIALIZE(filterAirInitialize, "air")
+TIMED_FILTER_INITIALIZE(filterStationaryInitialize, "stationary")
+TIMED_FILTER_INITIALIZE(filterLLAInitialize, "lla")
+TIMED_FILTER_INITIALIZE(filterCFInitialize, "cf")
+TIMED_FILTER_INITIALIZE(filterCFMInitialize, "cfm")
+TIMED_FILTER_INITIALIZE(filterEKF13iInitialize, "ekf13i")
+TIMED_FILTER_INITIALIZE(filterEKF13Initialize, "ekf13")
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Replay clock, 1 raw tick is 1us
+ */
+uint32_t PIOS_DELAY_GetRaw()
+{
+    return replayTimeUs;
+}
+
+uint32_t PIOS_DELAY_GetuS()
+{
+    return replayTimeUs;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+    return replayTimeUs - raw;
+}
+
+uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later)
+{
+    return later - raw;
+}
+
+uint32_t PIOS_DELAY_GetuSSince(uint32_t t)
+{
+    return replayTimeUs - t;
+}
+
+portTickType xTaskGetTickCount(void)
+{
+    return (portTickType)(replayTimeUs / 1000);
+}
+
+/*
+ * Callback scheduler, callbacks are run from StateReplayRun()
+ */
+DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
+    DelayedCallback cb,
+    __attribute__((unused)) DelayedCallbackPriority priority,
+    __attribute__((unused)) DelayedCallbackPriorityTask priorityTask,
+    __attribute__((unused)) int16_t callbackID,
+    __attribute__((unused)) uint32_t stacksize)
+{
+    if (numCallbacks >= MAX_CALLBACKS) {
+        return NULL;
+    }
+    DelayedCallbackInfo *info = &callbacks[numCallbacks++];
+    memset(info, 0, sizeof(*info));
+    info->cb = cb;
+    return info;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Schedule(DelayedCallbackInfo *cbinfo, int32_t milliseconds, DelayedCallbackUpdateMode updatemode)
+{
+    uint32_t due = replayTimeUs + (uint32_t)milliseconds * 1000;
+
+    if (cbinfo->scheduled) {
+        bool sooner = (int32_t)(due - cbinfo->dueUs) < 0;
+        if (!((updatemode & CALLBACK_UPDATEMODE_SOONER) && sooner) && !((updatemode & CALLBACK_UPDATEMODE_LATER) && !sooner)) {
+            return 0;
+        }
+        cbinfo->dueUs = due;
+        return 2;
+    }
+    cbinfo->scheduled = true;
+    cbinfo->dueUs     = due;
+    return 1;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
+{
+    cbinfo->dispatched = true;
+    return 1;
+}
+
+void PIOS_NOTIFY_StartNotification(__attribute__((unused)) pios_notify_notification notification, __attribute__((unused)) pios_notify_priority priority)
+{}
+
+/**
+ * @}
+ */
@@ -0,0 +1,412 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       statereplay.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Command line driver replaying an .opl log through the
+ *             StateEstimation filters.
+ *
+ *             The sensor objects of the log (GyroSensor, AccelSensor,
+ *             MagSensor, BaroSensor, GPS...) are fed to the module as fast as
+ *             possible, the estimated state is written as CSV and the time
+ *             spent in each filter is reported at the end.
+ *
+ *             Settings found in the log (RevoSettings, EKFConfiguration,
+ *             HomeLocation...) are applied as they come, objects that are not
+ *             used by the module are skipped.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <stdio.h>
+#include <getopt.h>
+#include <time.h>
+
+#include <openpilot.h>
+
+#include "statereplay.h"
+
+#include <attitudestate.h>
+#include <positionstate.h>
+#include <velocitystate.h>
+#include <revosettings.h>
+
+// UAVTalk framing, see uavtalk_priv.h
+#define UAVTALK_SYNC_VAL          0x3C
+#define UAVTALK_TIMESTAMPED       0x80
+#define UAVTALK_TYPE_OBJ          0x20
+#define UAVTALK_TYPE_OBJ_ACK      0x22
+#define UAVTALK_MIN_HEADER_LENGTH 10
+#define UAVTALK_CHECKSUM_LENGTH   1
+
+// Each record of an .opl log is a 32 bit timestamp in ms, a 64 bit size and the data
+#define OPL_RECORD_HEADER_LENGTH  12
+#define OPL_MAX_RECORD_SIZE       (1024 * 1024)
+
+// Columns of the CSV output after the time, see writeHeader()
+#define STATE_COLUMNS             13
+#define REFERENCE_LINE_LENGTH     512
+#define DEFAULT_TOLERANCE         1e-4
+
+struct replayStats {
+    uint32_t records;
+    uint32_t objects;
+    uint32_t skipped;
+    uint32_t corrupted;
+    uint32_t rows;
+    uint32_t mismatches;
+    uint32_t firstTimeMs;
+    uint32_t lastTimeMs;
+};
+
+static const struct {
+    const char *name;
+    RevoSettingsFusionAlgorithmOptions value;
+} fusionAlgorithms[] = {
+    { "basiccomplementary",         REVOSETTINGS_FUSIONALGORITHM_BASICCOMPLEMENTARY         },
+    { "complementarymag",           REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAG           },
+    { "complementarymaggpsoutdoor", REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAGGPSOUTDOOR },
+    { "ins13indoor",                REVOSETTINGS_FUSIONALGORITHM_INS13INDOOR                },
+    { "gpsnavigationins13",         REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS13         },
+};
+
+static uint32_t readLE(const uint8_t *buf, uint8_t bytes)
+{
+    uint32_t value = 0;
+
+    while (bytes--) {
+        value = (value << 8) | buf[bytes];
+    }
+    return value;
+}
+
+/**
+ * Decode all UAVTalk object packets of one log record
+ */
+static void decodeRecord(const uint8_t *buf, uint32_t size, struct replayStats *stats)
+{
+    uint32_t pos = 0;
+
+    while (pos + UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH <= size) {
+        if (buf[pos] != UAVTALK_SYNC_VAL) {
+            pos++;
+            continue;
+        }
+
+        const uint8_t *packet = &buf[pos];
+        uint8_t type    = packet[1];
+        uint16_t length = readLE(&packet[2], 2);
+        uint8_t headerLength = UAVTALK_MIN_HEADER_LENGTH + ((type & UAVTALK_TIMESTAMPED) ? 2 : 0);
+
+        if (length < headerLength || pos + length + UAVTALK_CHECKSUM_LENGTH > size ||
+            PIOS_CRC_updateCRC(0, packet, length) != packet[length]) {
+            stats->corrupted++;
+            pos++;
+            continue;
+        }
+
+        uint8_t baseType = type & ~UAVTALK_TIMESTAMPED;
+        if (baseType == UAVTALK_TYPE_OBJ || baseType == UAVTALK_TYPE_OBJ_ACK) {
+            if (StateReplayUnpack(readLE(&packet[4], 4), readLE(&packet[8], 2), &packet[headerLength], length - headerLength) == 0) {
+                stats->objects++;
+            } else {
+                stats->skipped++;
+            }
+        }
+        pos += length + UAVTALK_CHECKSUM_LENGTH;
+    }
+}
+
+static void writeHeader(FILE *out)
+{
+    fprintf(out, "time_ms,q1,q2,q3,q4,roll,pitch,yaw,pos_north,pos_east,pos_down,vel_north,vel_east,vel_down\n");
+}
+
+static void writeRow(FILE *out, uint32_t timeMs, const double *values)
+{
+    fprintf(out, "%u", timeMs);
+    for (uint8_t i = 0; i < STATE_COLUMNS; i++) {
+        fprintf(out, ",%.7g", values[i]);
+    }
+    fprintf(out, "\n");
+}
+
+static void getState(double *values)
+{
+    AttitudeStateData attitude;
+    PositionStateData position;
+    VelocityStateData velocity;
+
+    AttitudeStateGet(&attitude);
+    PositionStateGet(&position);
+    VelocityStateGet(&velocity);
+
+    const float state[STATE_COLUMNS] = {
+        attitude.q1,    attitude.q2,   attitude.q3, attitude.q4,
+        attitude.Roll,  attitude.Pitch, attitude.Yaw,
+        position.North, position.East, position.Down,
+        velocity.North, velocity.East, velocity.Down,
+    };
+    for (uint8_t i = 0; i < STATE_COLUMNS; i++) {
+        values[i] = state[i];
+    }
+}
+
+/**
+ * Compare a state with the next row of a reference output, as written by writeRow()
+ * Values match when they differ by less than tolerance, relative to the reference above 1.
+ * \return true if the row matches
+ */
+static bool checkRow(FILE *reference, uint32_t timeMs, const double *values, double tolerance)
+{
+    char line[REFERENCE_LINE_LENGTH];
+
+    if (!fgets(line, sizeof(line), reference)) {
+        fprintf(stderr, "%u ms: missing from the reference\n", timeMs);
+        return false;
+    }
+
+    char *pos = line;
+    uint32_t refTimeMs = strtoul(pos, &pos, 10);
+    if (refTimeMs != timeMs) {
+        fprintf(stderr, "%u ms: reference row is at %u ms\n", timeMs, refTimeMs);
+        return false;
+    }
+    for (uint8_t i = 0; i < STATE_COLUMNS; i++) {
+        if (*pos != ',') {
+            fprintf(stderr, "%u ms: truncated reference row\n", timeMs);
+            return false;
+        }
+        double expected = strtod(pos + 1, &pos);
+        if (!(fabs(values[i] - expected) <= tolerance * fmax(1.0, fabs(expected)))) {
+            fprintf(stderr, "%u ms: column %u is %.7g, reference is %.7g\n", timeMs, i + 1, values[i], expected);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int32_t replay(FILE *log, FILE *out, FILE *reference, double tolerance, struct replayStats *stats)
+{
+    uint8_t header[OPL_RECORD_HEADER_LENGTH];
+    uint8_t *buf = NULL;
+    uint32_t bufSize = 0;
+
+    while (fread(header, sizeof(header), 1, log) == 1) {
+        uint32_t timeMs = readLE(header, 4);
+        uint32_t sizeLow  = readLE(&header[4], 4);
+        uint32_t sizeHigh = readLE(&header[8], 4);
+
+        if (sizeHigh != 0 || sizeLow == 0 || sizeLow > OPL_MAX_RECORD_SIZE) {
+            fprintf(stderr, "corrupted record at offset %ld\n", ftell(log) - (long)sizeof(header));
+            free(buf);
+            return -1;
+        }
+        if (sizeLow > bufSize) {
+            uint8_t *newBuf = (uint8_t *)realloc(buf, sizeLow);
+            if (!newBuf) {
+                free(buf);
+                return -1;
+            }
+            buf     = newBuf;
+            bufSize = sizeLow;
+        }
+        if (fread(buf, sizeLow, 1, log) != 1) {
+            // truncated log, the last record was only partially written
+            break;
+        }
+
+        if (stats->records++ == 0) {
+            stats->firstTimeMs = timeMs;
+        }
+        stats->lastTimeMs = timeMs;
+
+        decodeRecord(buf, sizeLow, stats);
+        if (StateReplayRun(timeMs * 1000)) {
+            double values[STATE_COLUMNS];
+            getState(values);
+            writeRow(out, timeMs, values);
+            stats->rows++;
+            if (reference && !checkRow(reference, timeMs, values, tolerance)) {
+                stats->mismatches++;
+            }
+        }
+    }
+    free(buf);
+    return 0;
+}
+
+static void printTiming(const struct replayStats *stats, double wallSeconds)
+{
+    double logSeconds = (stats->lastTimeMs - stats->firstTimeMs) / 1000.0;
+    const StateReplayFilterTiming *timing;
+    uint8_t numFilters = StateReplayGetFilterTiming(&timing);
+
+    fprintf(stderr, "replayed %.1fs of log in %.3fs", logSeconds, wallSeconds);
+    if (wallSeconds > 0.0) {
+        fprintf(stderr, " (%.0fx real time)", logSeconds / wallSeconds);
+    }
+    fprintf(stderr, "\n%u records, %u objects, %u skipped, %u corrupted packets, %u states\n",
+            stats->records, stats->objects, stats->skipped, stats->corrupted, stats->rows);
+
+    fprintf(stderr, "%-12s %10s %10s %10s %10s\n", "filter", "calls", "mean[us]", "max[us]", "total[ms]");
+    for (uint8_t i = 0; i < numFilters; i++) {
+        if (timing[i].calls == 0) {
+            continue;
+        }
+        fprintf(stderr, "%-12s %10u %10.3f %10.3f %10.3f\n", timing[i].name, timing[i].calls,
+                timing[i].totalNs / 1000.0 / timing[i].calls, timing[i].maxNs / 1000.0, timing[i].totalNs / 1e6);
+    }
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [options] <log.opl>\n", name);
+    fprintf(stderr, "  -a, --algorithm <name>  filter chain, default is the FusionAlgorithm of the log:\n");
+    for (uint8_t i = 0; i < NELEMENTS(fusionAlgorithms); i++) {
+        fprintf(stderr, "                          %s\n", fusionAlgorithms[i].name);
+    }
+    fprintf(stderr, "  -o, --output <file>     write the estimated state to file instead of stdout\n");
+    fprintf(stderr, "  -r, --reference <file>  compare the estimated state with a previous output, fail on differences\n");
+    fprintf(stderr, "  -t, --tolerance <value> allowed difference when comparing, default is %g\n", DEFAULT_TOLERANCE);
+    fprintf(stderr, "  -q, --quiet             do not report the filter timing\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct option options[] = {
+        { "algorithm", required_argument, NULL, 'a' },
+        { "output",    required_argument, NULL, 'o' },
+        { "reference", required_argument, NULL, 'r' },
+        { "tolerance", required_argument, NULL, 't' },
+        { "quiet",     no_argument,       NULL, 'q' },
+        { "help",      no_argument,       NULL, 'h' },
+        { NULL,        0,                 NULL, 0   },
+    };
+    int16_t fusionAlgorithm = STATEREPLAY_FUSION_FROM_LOG;
+    const char *outName     = NULL;
+    const char *refName     = NULL;
+    double tolerance = DEFAULT_TOLERANCE;
+    bool quiet = false;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "a:o:r:t:qh", options, NULL)) != -1) {
+        switch (opt) {
+        case 'a':
+            for (uint8_t i = 0; i < NELEMENTS(fusionAlgorithms); i++) {
+                if (!strcmp(optarg, fusionAlgorithms[i].name)) {
+                    fusionAlgorithm = fusionAlgorithms[i].value;
+                }
+            }
+            if (fusionAlgorithm == STATEREPLAY_FUSION_FROM_LOG) {
+                fprintf(stderr, "unknown filter chain %s\n", optarg);
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'o':
+            outName = optarg;
+            break;
+        case 'r':
+            refName = optarg;
+            break;
+        case 't':
+            tolerance = atof(optarg);
+            break;
+        case 'q':
+            quiet   = true;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE *log = fopen(argv[optind], "rb");
+    if (!log) {
+        perror(argv[optind]);
+        return 1;
+    }
+    FILE *out = outName ? fopen(outName, "w") : stdout;
+    if (!out) {
+        perror(outName);
+        fclose(log);
+        return 1;
+    }
+    char line[REFERENCE_LINE_LENGTH];
+    FILE *reference = refName ? fopen(refName, "r") : NULL;
+    if (refName && !reference) {
+        perror(refName);
+        fclose(log);
+        return 1;
+    }
+    // skip the header of the reference
+    if (reference && !fgets(line, sizeof(line), reference)) {
+        fprintf(stderr, "%s: empty reference\n", refName);
+        fclose(reference);
+        fclose(log);
+        return 1;
+    }
+
+    if (StateReplayInitialize() != 0) {
+        fprintf(stderr, "failed to initialize the state estimation\n");
+        return 1;
+    }
+    StateReplaySetFusionAlgorithm(fusionAlgorithm);
+
+    struct replayStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    writeHeader(out);
+    int32_t result = replay(log, out, reference, tolerance, &stats);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (reference) {
+        // the reference must not hold more states than the replay produced
+        if (fgets(line, sizeof(line), reference)) {
+            fprintf(stderr, "reference has more states than the replay\n");
+            stats.mismatches++;
+        }
+        fclose(reference);
+        fprintf(stderr, "%u of %u states differ from the reference\n", stats.mismatches, stats.rows);
+    }
+    fclose(log);
+    if (out != stdout) {
+        fclose(out);
+    }
+    if (!quiet) {
+        printTiming(&stats, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+    }
+    return (result == 0 && stats.mismatches == 0) ? 0 : 1;
+}
+
+/**
+ * @}
+ */
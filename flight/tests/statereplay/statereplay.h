@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       statereplay.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Runs the StateEstimation module and its filters on the host,
+ *             fed with UAVObjects decoded from a log.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef STATEREPLAY_H
+#define STATEREPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STATEREPLAY_FUSION_FROM_LOG -1
+
+// Execution time of one filter of the StateEstimation module
+typedef struct {
+    const char *name;
+    uint32_t   calls;
+    uint64_t   totalNs;
+    uint64_t   maxNs;
+} StateReplayFilterTiming;
+
+/**
+ * Register the UAVObjects and initialize the StateEstimation module
+ * \return 0 on success or -1 if initialisation failed
+ */
+int32_t StateReplayInitialize(void);
+
+/**
+ * Select the filter chain (RevoSettingsFusionAlgorithmOptions), overriding
+ * the RevoSettings found in the log. STATEREPLAY_FUSION_FROM_LOG follows the log.
+ */
+void StateReplaySetFusionAlgorithm(int16_t fusionAlgorithm);
+
+/**
+ * Update an object with data decoded from the log
+ * \return 0 on success, -1 if the object is unknown or its size does not match
+ */
+int32_t StateReplayUnpack(uint32_t objId, uint16_t instId, const uint8_t *data, uint32_t length);
+
+/**
+ * Advance the replay clock and run the state estimation as often as it was dispatched
+ * \return true if the estimated state was updated
+ */
+bool StateReplayRun(uint32_t timeUs);
+
+/**
+ * Execution time of the filters that were initialized by the module
+ * \return the number of entries in timing
+ */
+uint8_t StateReplayGetFilterTiming(const StateReplayFilterTiming **timing);
+
+#endif /* STATEREPLAY_H */
+
+/**
+ * @}
+ */
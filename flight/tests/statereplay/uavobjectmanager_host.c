@@ -0,0 +1,363 @@
+/**
+ ******************************************************************************
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       uavobjectmanager_host.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Minimal single threaded object manager used to run the
+ *             StateEstimation filters on the host.
+ *
+ *             Objects are kept in a plain list, there are no event queues:
+ *             callbacks are invoked synchronously from the setter, which is
+ *             what the event dispatcher eventually does on the board.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <openpilot.h>
+
+#define MAX_CALLBACKS 4
+
+struct ObjCallback {
+    UAVObjEventCallback cb;
+    uint8_t eventMask;
+};
+
+struct HostObject {
+    struct HostObject *next;
+    uint32_t id;
+    bool     isSingleInstance;
+    bool     isSettings;
+    bool     isPriority;
+    uint32_t numBytes;
+    uint16_t numInstances;
+    uint8_t  *data; // numInstances * numBytes
+    UAVObjMetadata     metadata;
+    struct ObjCallback callbacks[MAX_CALLBACKS];
+};
+
+// Private variables
+static struct HostObject *objects;
+static UAVObjStats stats;
+
+// Private functions
+static void invokeCallbacks(struct HostObject *obj, uint16_t instId, UAVObjEventType event);
+static uint8_t *instanceData(struct HostObject *obj, uint16_t instId);
+
+
+int32_t UAVObjInitialize()
+{
+    objects = NULL;
+    memset(&stats, 0, sizeof(stats));
+    return 0;
+}
+
+void UAVObjGetStats(UAVObjStats *statsOut)
+{
+    *statsOut = stats;
+}
+
+void UAVObjClearStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+UAVObjHandle UAVObjRegister(uint32_t id, bool isSingleInstance, bool isSettings, bool isPriority, uint32_t num_bytes, UAVObjInitializeCallback initCb)
+{
+    struct HostObject *obj = (struct HostObject *)calloc(1, sizeof(struct HostObject));
+
+    if (!obj) {
+        return NULL;
+    }
+    obj->data = (uint8_t *)calloc(1, num_bytes);
+    if (!obj->data) {
+        free(obj);
+        return NULL;
+    }
+    obj->id = id;
+    obj->isSingleInstance = isSingleInstance;
+    obj->isSettings   = isSettings;
+    obj->isPriority   = isPriority;
+    obj->numBytes     = num_bytes;
+    obj->numInstances = 1;
+    obj->next   = objects;
+    objects     = obj;
+
+    if (initCb) {
+        initCb((UAVObjHandle)obj, 0);
+    }
+    return (UAVObjHandle)obj;
+}
+
+UAVObjHandle UAVObjGetByID(uint32_t id)
+{
+    for (struct HostObject *obj = objects; obj; obj = obj->next) {
+        if (obj->id == id) {
+            return (UAVObjHandle)obj;
+        }
+    }
+    return NULL;
+}
+
+uint32_t UAVObjGetID(UAVObjHandle obj_handle)
+{
+    return ((struct HostObject *)obj_handle)->id;
+}
+
+uint32_t UAVObjGetNumBytes(UAVObjHandle obj_handle)
+{
+    return ((struct HostObject *)obj_handle)->numBytes;
+}
+
+uint16_t UAVObjGetNumInstances(UAVObjHandle obj_handle)
+{
+    return ((struct HostObject *)obj_handle)->numInstances;
+}
+
+uint16_t UAVObjCreateInstance(UAVObjHandle obj_handle, UAVObjInitializeCallback initCb)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    if (obj->isSingleInstance || obj->numInstances >= UAVOBJ_MAX_INSTANCES) {
+        return 0;
+    }
+    uint8_t *data = (uint8_t *)realloc(obj->data, (obj->numInstances + 1) * obj->numBytes);
+    if (!data) {
+        return 0;
+    }
+    obj->data = data;
+    memset(instanceData(obj, obj->numInstances), 0, obj->numBytes);
+    uint16_t instId = obj->numInstances++;
+    if (initCb) {
+        initCb(obj_handle, instId);
+    }
+    return instId;
+}
+
+bool UAVObjIsSingleInstance(UAVObjHandle obj_handle)
+{
+    return ((struct HostObject *)obj_handle)->isSingleInstance;
+}
+
+bool UAVObjIsMetaobject(__attribute__((unused)) UAVObjHandle obj_handle)
+{
+    return false;
+}
+
+bool UAVObjIsSettings(UAVObjHandle obj_handle)
+{
+    return ((struct HostObject *)obj_handle)->isSettings;
+}
+
+bool UAVObjIsPriority(UAVObjHandle obj_handle)
+{
+    return ((struct HostObject *)obj_handle)->isPriority;
+}
+
+/**
+ * Unpack an object received from a log, creating missing instances on the way.
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *dataIn)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    while (instId >= obj->numInstances) {
+        if (UAVObjCreateInstance(obj_handle, NULL) == 0) {
+            return -1;
+        }
+    }
+    memcpy(instanceData(obj, instId), dataIn, obj->numBytes);
+    invokeCallbacks(obj, instId, EV_UNPACKED);
+    return 0;
+}
+
+int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut)
+{
+    return UAVObjGetInstanceData(obj_handle, instId, dataOut);
+}
+
+int32_t UAVObjSetData(UAVObjHandle obj_handle, const void *dataIn)
+{
+    return UAVObjSetInstanceData(obj_handle, 0, dataIn);
+}
+
+int32_t UAVObjSetDataField(UAVObjHandle obj_handle, const void *dataIn, uint32_t offset, uint32_t size)
+{
+    return UAVObjSetInstanceDataField(obj_handle, 0, dataIn, offset, size);
+}
+
+int32_t UAVObjGetData(UAVObjHandle obj_handle, void *dataOut)
+{
+    return UAVObjGetInstanceData(obj_handle, 0, dataOut);
+}
+
+int32_t UAVObjGetDataField(UAVObjHandle obj_handle, void *dataOut, uint32_t offset, uint32_t size)
+{
+    return UAVObjGetInstanceDataField(obj_handle, 0, dataOut, offset, size);
+}
+
+int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId, const void *dataIn)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    return UAVObjSetInstanceDataField(obj_handle, instId, dataIn, 0, obj->numBytes);
+}
+
+int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, const void *dataIn, uint32_t offset, uint32_t size)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    if (instId >= obj->numInstances || offset + size > obj->numBytes) {
+        return -1;
+    }
+    memcpy(instanceData(obj, instId) + offset, dataIn, size);
+    invokeCallbacks(obj, instId, EV_UPDATED);
+    return 0;
+}
+
+int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId, void *dataOut)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    return UAVObjGetInstanceDataField(obj_handle, instId, dataOut, 0, obj->numBytes);
+}
+
+int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    if (instId >= obj->numInstances || offset + size > obj->numBytes) {
+        return -1;
+    }
+    memcpy(dataOut, instanceData(obj, instId) + offset, size);
+    return 0;
+}
+
+int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata *dataIn)
+{
+    ((struct HostObject *)obj_handle)->metadata = *dataIn;
+    return 0;
+}
+
+int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata *dataOut)
+{
+    *dataOut = ((struct HostObject *)obj_handle)->metadata;
+    return 0;
+}
+
+int8_t UAVObjReadOnly(__attribute__((unused)) UAVObjHandle obj_handle)
+{
+    return 0;
+}
+
+int32_t UAVObjConnectQueue(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused)) xQueueHandle queue, __attribute__((unused)) uint8_t eventMask)
+{
+    // nothing consumes queues on the host
+    return 0;
+}
+
+int32_t UAVObjDisconnectQueue(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused)) xQueueHandle queue)
+{
+    return 0;
+}
+
+int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb, uint8_t eventMask, __attribute__((unused)) bool fast)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    for (int i = 0; i < MAX_CALLBACKS; i++) {
+        if (!obj->callbacks[i].cb || obj->callbacks[i].cb == cb) {
+            obj->callbacks[i].cb = cb;
+            obj->callbacks[i].eventMask = eventMask;
+            return 0;
+        }
+    }
+    stats.eventCallbackErrors++;
+    stats.lastCallbackErrorID = obj->id;
+    return -1;
+}
+
+int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb)
+{
+    struct HostObject *obj = (struct HostObject *)obj_handle;
+
+    for (int i = 0; i < MAX_CALLBACKS; i++) {
+        if (obj->callbacks[i].cb == cb) {
+            obj->callbacks[i].cb = NULL;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void UAVObjRequestUpdate(__attribute__((unused)) UAVObjHandle obj_handle)
+{}
+
+void UAVObjRequestInstanceUpdate(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused)) uint16_t instId)
+{}
+
+void UAVObjUpdated(UAVObjHandle obj_handle)
+{
+    UAVObjInstanceUpdated(obj_handle, 0);
+}
+
+void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
+{
+    invokeCallbacks((struct HostObject *)obj_handle, instId, EV_UPDATED_MANUAL);
+}
+
+void UAVObjLogging(__attribute__((unused)) UAVObjHandle obj_handle)
+{}
+
+void UAVObjInstanceLogging(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused)) uint16_t instId)
+{}
+
+void UAVObjIterate(void (*iterator)(UAVObjHandle obj))
+{
+    for (struct HostObject *obj = objects; obj; obj = obj->next) {
+        iterator((UAVObjHandle)obj);
+    }
+}
+
+static uint8_t *instanceData(struct HostObject *obj, uint16_t instId)
+{
+    return obj->data + (uint32_t)instId * obj->numBytes;
+}
+
+static void invokeCallbacks(struct HostObject *obj, uint16_t instId, UAVObjEventType event)
+{
+    UAVObjEvent ev = {
+        .obj         = (UAVObjHandle)obj,
+        .instId      = instId,
+        .event       = event,
+        .lowPriority = false,
+    };
+
+    for (int i = 0; i < MAX_CALLBACKS; i++) {
+        if (obj->callbacks[i].cb && (obj->callbacks[i].eventMask == EV_MASK_ALL || (obj->callbacks[i].eventMask & event))) {
+            obj->callbacks[i].cb(&ev);
+        }
+    }
+}
+
+/**
+ * @}
+ */
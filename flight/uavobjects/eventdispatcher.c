@@ -44,6 +44,12 @@
 #define CALLBACK_PRIORITY    CALLBACK_PRIORITY_CRITICAL
 #define TASK_PRIORITY        CALLBACK_TASK_FLIGHTCONTROL
 #define MAX_UPDATE_PERIOD_MS 1000
+#define HEAP_BLOCK_SIZE      16
+#define HEAP_MAX_BLOCKS      32
+#define HEAP_NONE            0xFFFF
+
+// The heap is stored in blocks that are allocated as it grows and never moved or freed
+#define HEAP_ENTRY(index)    (mHeapBlocks[(index) / HEAP_BLOCK_SIZE][(index) % HEAP_BLOCK_SIZE])
 
 // Private types
 
@@ -65,12 +71,16 @@ struct PeriodicObjectListStruct {
     EventCallbackInfo evInfo; /** Event callback information */
     uint16_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
     int32_t  timeToNextUpdateMs; /** Time delay to the next update */
+    uint16_t heapIndex; /** Position in the heap, or HEAP_NONE if no periodic updates are scheduled */
     struct PeriodicObjectListStruct *next; /** Needed by linked list library (utlist.h) */
 };
 typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList *mObjList;
+static PeriodicObjectList **mHeapBlocks[HEAP_MAX_BLOCKS]; /** Min-heap of scheduled entries ordered by timeToNextUpdateMs */
+static uint16_t mHeapSize;
+static uint16_t mHeapCapacity;
 static xQueueHandle mQueue;
 static DelayedCallbackInfo *eventSchedulerCallback;
 static xSemaphoreHandle mMutex;
@@ -82,6 +92,10 @@ static void eventTask();
 static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static uint16_t randomizePeriod(uint16_t periodMs);
+static int32_t heapReserve();
+static int32_t heapInsert(PeriodicObjectList *objEntry);
+static void heapRemove(PeriodicObjectList *objEntry);
+static void heapUpdate(PeriodicObjectList *objEntry);
 
 
 /**
@@ -91,7 +105,10 @@ static uint16_t randomizePeriod(uint16_t periodMs);
 int32_t EventDispatcherInitialize()
 {
     // Initialize variables
-    mObjList = NULL;
+    mObjList      = NULL;
+    memset(mHeapBlocks, 0, sizeof(mHeapBlocks));
+    mHeapSize     = 0;
+    mHeapCapacity = 0;
     memset(&mStats, 0, sizeof(EventStats));
 
     // Create mMutex
@@ -227,9 +244,15 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
             return -1;
         }
     }
+    // Make room in the heap first, the entry could not be freed on heap_1 targets
+    if (periodMs > 0 && heapReserve() != 0) {
+        xSemaphoreGiveRecursive(mMutex);
+        return -1;
+    }
     // Create handle
     objEntry = (PeriodicObjectList *)pios_malloc(sizeof(PeriodicObjectList));
     if (objEntry == NULL) {
+        xSemaphoreGiveRecursive(mMutex);
         return -1;
     }
     objEntry->evInfo.ev.obj      = ev->obj;
@@ -238,7 +261,12 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     objEntry->evInfo.cb = cb;
     objEntry->evInfo.queue       = queue;
     objEntry->updatePeriodMs     = periodMs;
-    objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+    objEntry->timeToNextUpdateMs = xTaskGetTickCount() * portTICK_RATE_MS + randomizePeriod(periodMs); // avoid bunching of updates
+    objEntry->heapIndex = HEAP_NONE;
+    // Schedule the first update, it can not fail once room is reserved
+    if (periodMs > 0) {
+        heapInsert(objEntry);
+    }
     // Add to list
     LL_APPEND(mObjList, objEntry);
     // Release lock
@@ -269,10 +297,19 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
             objEntry->evInfo.ev.event == ev->event) {
             // Object found, update period
             objEntry->updatePeriodMs     = periodMs;
-            objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+            objEntry->timeToNextUpdateMs = xTaskGetTickCount() * portTICK_RATE_MS + randomizePeriod(periodMs); // avoid bunching of updates
+            // Reschedule
+            int32_t result = 0;
+            if (periodMs == 0) {
+                heapRemove(objEntry);
+            } else if (objEntry->heapIndex == HEAP_NONE) {
+                result = heapInsert(objEntry);
+            } else {
+                heapUpdate(objEntry);
+            }
             // Release lock
             xSemaphoreGiveRecursive(mMutex);
-            return 0;
+            return result;
         }
     }
     // If this point is reached the object was not found
@@ -312,6 +349,7 @@ static void eventTask()
 
 /**
  * Handle periodic updates for all objects.
+ * Only the entries that are due are visited, they are taken from the top of the heap.
  * \return The system time until the next update (in ms) or -1 if failed
  */
 static int32_t processPeriodicUpdates()
@@ -320,48 +358,170 @@ static int32_t processPeriodicUpdates()
     int32_t timeNow;
     int32_t timeToNextUpdate;
     int32_t offset;
+    uint16_t remaining;
 
     // Get lock
     xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = xTaskGetTickCount() * portTICK_RATE_MS + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(mObjList, objEntry) {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0) {
-            // Check if time for the next update
-            timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
-            if (objEntry->timeToNextUpdateMs <= timeNow) {
-                // Reset timer
-                offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
-                objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-                // Invoke callback, if one
-                if (objEntry->evInfo.cb != 0) {
-                    objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-                }
-                // Push event to queue, if one
-                if (objEntry->evInfo.queue != 0) {
-                    if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
-                        if (objEntry->evInfo.ev.obj != NULL) {
-                            mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
-                        }
-                        ++mStats.eventErrors;
-                    }
+    // Pop every entry whose timer has expired, reschedule it and then transmit the object.
+    // A callback can reschedule its entry to timeNow again through eventPeriodicUpdate(),
+    // so at most as many entries as were scheduled are handled per call, the rest is left
+    // for the next call which is then scheduled right away.
+    timeNow   = xTaskGetTickCount() * portTICK_RATE_MS;
+    remaining = mHeapSize;
+    while (remaining-- > 0 && mHeapSize > 0 && HEAP_ENTRY(0)->timeToNextUpdateMs <= timeNow) {
+        objEntry = HEAP_ENTRY(0);
+        // Reset timer, the callback may update the entry so it is rescheduled first
+        offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
+        objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
+        heapUpdate(objEntry);
+        // Invoke callback, if one
+        if (objEntry->evInfo.cb != 0) {
+            objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+        }
+        // Push event to queue, if one
+        if (objEntry->evInfo.queue != 0) {
+            if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
+                if (objEntry->evInfo.ev.obj != NULL) {
+                    mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
                 }
-            }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate) {
-                timeToNextUpdate = objEntry->timeToNextUpdateMs;
+                ++mStats.eventErrors;
             }
         }
     }
 
+    // The smallest delay to the next update is at the top of the heap
+    timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+    if (mHeapSize > 0 && HEAP_ENTRY(0)->timeToNextUpdateMs < timeToNextUpdate) {
+        timeToNextUpdate = HEAP_ENTRY(0)->timeToNextUpdateMs;
+    }
+
     // Done
     xSemaphoreGiveRecursive(mMutex);
     return timeToNextUpdate;
 }
 
+/**
+ * Place an entry at a heap position and keep its index up to date
+ */
+static inline void heapSet(uint16_t index, PeriodicObjectList *objEntry)
+{
+    HEAP_ENTRY(index) = objEntry;
+    objEntry->heapIndex = index;
+}
+
+/**
+ * Move an entry towards the top of the heap until its parent is due earlier
+ */
+static void heapSiftUp(uint16_t index)
+{
+    PeriodicObjectList *objEntry = HEAP_ENTRY(index);
+
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        if (HEAP_ENTRY(parent)->timeToNextUpdateMs <= objEntry->timeToNextUpdateMs) {
+            break;
+        }
+        heapSet(index, HEAP_ENTRY(parent));
+        index = parent;
+    }
+    heapSet(index, objEntry);
+}
+
+/**
+ * Move an entry towards the bottom of the heap until its children are due later
+ */
+static void heapSiftDown(uint16_t index)
+{
+    PeriodicObjectList *objEntry = HEAP_ENTRY(index);
+
+    for (;;) {
+        uint16_t child = 2 * index + 1;
+        if (child >= mHeapSize) {
+            break;
+        }
+        if (child + 1 < mHeapSize && HEAP_ENTRY(child + 1)->timeToNextUpdateMs < HEAP_ENTRY(child)->timeToNextUpdateMs) {
+            child++;
+        }
+        if (objEntry->timeToNextUpdateMs <= HEAP_ENTRY(child)->timeToNextUpdateMs) {
+            break;
+        }
+        heapSet(index, HEAP_ENTRY(child));
+        index = child;
+    }
+    heapSet(index, objEntry);
+}
+
+/**
+ * Make sure the heap has room for one more entry, adding a block if needed.
+ * Blocks are never released, registered entries are never removed either.
+ * \return Success (0), failure (-1)
+ */
+static int32_t heapReserve()
+{
+    if (mHeapSize < mHeapCapacity) {
+        return 0;
+    }
+    if (mHeapCapacity >= HEAP_MAX_BLOCKS * HEAP_BLOCK_SIZE) {
+        return -1;
+    }
+    PeriodicObjectList **block = (PeriodicObjectList **)pios_malloc(HEAP_BLOCK_SIZE * sizeof(PeriodicObjectList *));
+    if (block == NULL) {
+        return -1;
+    }
+    mHeapBlocks[mHeapCapacity / HEAP_BLOCK_SIZE] = block;
+    mHeapCapacity += HEAP_BLOCK_SIZE;
+    return 0;
+}
+
+/**
+ * Schedule an entry for periodic updates
+ * \return Success (0), failure (-1)
+ */
+static int32_t heapInsert(PeriodicObjectList *objEntry)
+{
+    if (heapReserve() != 0) {
+        return -1;
+    }
+
+    heapSet(mHeapSize, objEntry);
+    heapSiftUp(mHeapSize++);
+    return 0;
+}
+
+/**
+ * Remove an entry from the periodic updates, if it is scheduled
+ */
+static void heapRemove(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    if (index == HEAP_NONE) {
+        return;
+    }
+    objEntry->heapIndex = HEAP_NONE;
+
+    // Fill the hole with the last entry and restore the heap order
+    if (index != --mHeapSize) {
+        heapSet(index, HEAP_ENTRY(mHeapSize));
+        heapUpdate(HEAP_ENTRY(index));
+    }
+}
+
+/**
+ * Restore the heap order after the update time of an entry changed
+ */
+static void heapUpdate(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    if (index > 0 && HEAP_ENTRY((index - 1) / 2)->timeToNextUpdateMs > objEntry->timeToNextUpdateMs) {
+        heapSiftUp(index);
+    } else {
+        heapSiftDown(index);
+    }
+}
+
 /**
  * Return a psedorandom integer from 0 to periodMs
  * Based on the Park-Miller-Carta Pseudo-Random Number Generator
@@ -33,6 +33,19 @@
 
 // Constants
 
+// Number of mutexes protecting object data, objects are spread over them by ID
+#ifndef UAVOBJ_DATA_LOCKS
+#define UAVOBJ_DATA_LOCKS        8
+#endif
+
+// Single instance objects up to this size are read without taking their lock
+#ifndef UAVOBJ_SEQLOCK_MAX_BYTES
+#define UAVOBJ_SEQLOCK_MAX_BYTES 64
+#endif
+
+// Lock-free read attempts before a reader falls back to taking the lock
+#define UAVOBJ_SEQLOCK_RETRIES   3
+
 // Private types
 
 // Macros
@@ -101,6 +114,7 @@ struct UAVOBase {
         bool isSingle      : 1;
         bool isSettings    : 1;
         bool isPriority    : 1;
+        bool isSeqlocked   : 1;
     } flags;
 } __attribute__((packed));
 
@@ -120,6 +134,11 @@ struct UAVOData {
      */
     struct UAVOMeta metaObj;
     uint16_t instance_size;
+    /*
+     * Sequence counter for lock-free reads of seqlocked objects,
+     * odd while a write is in progress.
+     */
+    volatile uint16_t seq;
 } __attribute__((packed, aligned(4)));
 
 /* Augmented type for Single Instance Data UAVO */
@@ -169,5 +188,7 @@ struct UAVOMulti {
 // Private functions
 int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType event);
 InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId);
+void lockObjectData(struct UAVOBase *obj, bool write);
+void unlockObjectData(struct UAVOBase *obj, bool write);
 
 #endif /* UAVOBJECTPRIVATE_H_ */
@@ -34,12 +34,15 @@
 #include "openpilot.h"
 #include "pios_struct_helper.h"
 #include "inc/uavobjectprivate.h"
+#include "uavobjectsinit.h"
 
 // Private functions
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask, bool fast);
 static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
+static int16_t idTableIndex(uint32_t id);
+static bool readSeqlocked(struct UAVOData *obj, void *dataOut, uint32_t offset, uint32_t size);
 
 
 int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused))  uint16_t instId)
@@ -53,6 +56,7 @@ int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId) __attribute__((we
 
 // Private variables
 static xSemaphoreHandle mutex;
+static xSemaphoreHandle dataLocks[UAVOBJ_DATA_LOCKS];
 static const UAVObjMetadata defMetadata = {
     .flags                    = (ACCESS_READWRITE << UAVOBJ_ACCESS_SHIFT |
               ACCESS_READWRITE << UAVOBJ_GCS_ACCESS_SHIFT |
@@ -67,6 +71,14 @@ static const UAVObjMetadata defMetadata = {
 
 static UAVObjStats stats;
 
+/*
+ * Lookup table for UAVObjGetByID(), indexed like the generated (sorted) ID
+ * list. A slot is written once, after its object is fully registered, so it
+ * can be read without taking the mutex.
+ */
+static const uint32_t idTable[UAVOBJECTS_COUNT] = { UAVOBJECTS_SORTED_IDS };
+static struct UAVOData *idTableObjects[UAVOBJECTS_COUNT];
+
 
 static inline bool IsMetaobject(UAVObjHandle obj_handle)
 {
@@ -100,6 +112,14 @@ static inline bool IsPriority(UAVObjHandle obj_handle)
     return uavo_base->flags.isPriority;
 }
 
+static inline bool IsSeqlocked(UAVObjHandle obj_handle)
+{
+    /* Recover the common object header */
+    struct UAVOBase *uavo_base = (struct UAVOBase *)obj_handle;
+
+    return uavo_base->flags.isSeqlocked;
+}
+
 /**
  * Is this a metaobject?
  * \param[in] obj The object handle
@@ -165,6 +185,7 @@ int32_t UAVObjInitialize()
     // Initialize the uavo handle table
     memset(__start__uavo_handles, 0,
            (uintptr_t)__stop__uavo_handles - (uintptr_t)__start__uavo_handles);
+    memset(idTableObjects, 0, sizeof(idTableObjects));
 
     // Create mutex
     mutex = xSemaphoreCreateRecursiveMutex();
@@ -172,6 +193,14 @@ int32_t UAVObjInitialize()
         return -1;
     }
 
+    // Create the object data locks
+    for (uint8_t n = 0; n < UAVOBJ_DATA_LOCKS; ++n) {
+        dataLocks[n] = xSemaphoreCreateRecursiveMutex();
+        if (dataLocks[n] == NULL) {
+            return -1;
+        }
+    }
+
     // Done
     return 0;
 }
@@ -292,11 +321,17 @@ UAVObjHandle UAVObjRegister(uint32_t id,
                             UAVObjInitializeCallback initCb)
 {
     struct UAVOData *uavo_data = NULL;
+    int16_t idx = idTableIndex(id);
+
+    /* Only objects known to the generated ID table can be registered */
+    if (idx < 0) {
+        return NULL;
+    }
 
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
     /* Don't allow duplicate registrations */
-    if (UAVObjGetByID(id)) {
+    if (idTableObjects[idx]) {
         goto unlock_exit;
     }
 
@@ -314,6 +349,8 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     /* Fill in the details about this UAVO */
     uavo_data->id = id;
     uavo_data->instance_size = num_bytes;
+    uavo_data->seq = 0;
+    uavo_data->base.flags.isSeqlocked = isSingleInstance && num_bytes <= UAVOBJ_SEQLOCK_MAX_BYTES;
     if (isSettings) {
         uavo_data->base.flags.isSettings = true;
         // settings defaults to being sent with priority
@@ -341,38 +378,64 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     instanceAutoUpdated((UAVObjHandle)uavo_data, 0);
     instanceAutoUpdated((UAVObjHandle) & (uavo_data->metaObj), 0);
 
+    /* Publish the object for lookups by ID */
+    idTableObjects[idx] = uavo_data;
+
 unlock_exit:
     xSemaphoreGiveRecursive(mutex);
     return (UAVObjHandle)uavo_data;
 }
 
 /**
- * Retrieve an object from the list given its id
+ * Find the index of an object ID in the generated ID table
+ * \param[in] id The object ID
+ * \return The table index or -1 if the ID is unknown
+ */
+static int16_t idTableIndex(uint32_t id)
+{
+    int16_t low  = 0;
+    int16_t high = UAVOBJECTS_COUNT - 1;
+
+    while (low <= high) {
+        int16_t mid = (low + high) / 2;
+        if (idTable[mid] < id) {
+            low = mid + 1;
+        } else if (idTable[mid] > id) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Retrieve an object given its id. This does not take the object manager
+ * lock and does not depend on the number of registered objects.
  * \param[in] The object ID
  * \return The object or NULL if not found.
  */
 UAVObjHandle UAVObjGetByID(uint32_t id)
 {
-    UAVObjHandle *found_obj = (UAVObjHandle *)NULL;
+    struct UAVOData *obj;
+    int16_t idx;
 
-    // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-    // Look for object
-    UAVO_LIST_ITERATE(tmp_obj)
-    if (tmp_obj->id == id) {
-        found_obj = (UAVObjHandle *)tmp_obj;
-        goto unlock_exit;
+    // Look for a data object
+    idx = idTableIndex(id);
+    if (idx >= 0) {
+        return (UAVObjHandle)idTableObjects[idx];
     }
-    if (MetaObjectId(tmp_obj->id) == id) {
-        found_obj = (UAVObjHandle *)&(tmp_obj->metaObj);
-        goto unlock_exit;
+
+    // Look for the metaobject of a data object
+    idx = idTableIndex(id - 1);
+    if (idx >= 0) {
+        obj = idTableObjects[idx];
+        if (obj) {
+            return (UAVObjHandle) & (obj->metaObj);
+        }
     }
-}
 
-unlock_exit:
-xSemaphoreGiveRecursive(mutex);
-return found_obj;
+    return (UAVObjHandle)NULL;
 }
 
 /**
@@ -522,11 +585,18 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *da
 {
     PIOS_Assert(obj_handle);
 
-    // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
     int32_t rc = -1;
 
+    // If the instance does not exist create it and any other instances before it
+    if (!IsMetaobject(obj_handle) && instId >= UAVObjGetNumInstances(obj_handle)) {
+        xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+        createInstance((struct UAVOData *)obj_handle, instId);
+        xSemaphoreGiveRecursive(mutex);
+    }
+
+    // Lock
+    lockObjectData((struct UAVOBase *)obj_handle, true);
+
     if (IsMetaobject(obj_handle)) {
         if (instId != 0) {
             goto unlock_exit;
@@ -541,24 +611,22 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *da
 
         // Get the instance
         instEntry = getInstance(obj, instId);
-
-        // If the instance does not exist create it and any other instances before it
         if (instEntry == NULL) {
-            instEntry = createInstance(obj, instId);
-            if (instEntry == NULL) {
-                goto unlock_exit;
-            }
+            goto unlock_exit;
         }
         // Set the data
         memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
     }
 
-    // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
     rc = 0;
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, true);
+
+    // Fire event
+    if (rc == 0) {
+        sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
+    }
     return rc;
 }
 
@@ -573,8 +641,14 @@ int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut)
 {
     PIOS_Assert(obj_handle);
 
+    // Lock-free path for small single instance objects
+    if (IsSeqlocked(obj_handle) && instId == 0 &&
+        readSeqlocked((struct UAVOData *)obj_handle, dataOut, 0, ((struct UAVOData *)obj_handle)->instance_size)) {
+        return 0;
+    }
+
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjectData((struct UAVOBase *)obj_handle, false);
 
     int32_t rc = -1;
 
@@ -602,7 +676,7 @@ int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut)
     rc = 0;
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, false);
     return rc;
 }
 
@@ -618,7 +692,7 @@ uint8_t UAVObjUpdateCRC(UAVObjHandle obj_handle, uint16_t instId, uint8_t crc)
     PIOS_Assert(obj_handle);
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjectData((struct UAVOBase *)obj_handle, false);
 
     if (IsMetaobject(obj_handle)) {
         if (instId != 0) {
@@ -642,7 +716,7 @@ uint8_t UAVObjUpdateCRC(UAVObjHandle obj_handle, uint16_t instId, uint8_t crc)
     }
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, false);
     return crc;
 }
 
@@ -657,7 +731,7 @@ void UAVObjInstanceWriteToLog(UAVObjHandle obj_handle, uint16_t instId)
     PIOS_Assert(obj_handle);
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjectData((struct UAVOBase *)obj_handle, false);
 
     if (IsMetaobject(obj_handle)) {
         if (instId != 0) {
@@ -681,7 +755,7 @@ void UAVObjInstanceWriteToLog(UAVObjHandle obj_handle, uint16_t instId)
     }
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, false);
 }
 #else /* ifdef PIOS_INCLUDE_DEBUGLOG */
 void UAVObjInstanceWriteToLog(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused)) uint16_t instId) {}
@@ -914,7 +988,7 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
     PIOS_Assert(obj_handle);
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjectData((struct UAVOBase *)obj_handle, true);
 
     int32_t rc = -1;
 
@@ -943,12 +1017,15 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
         memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
     }
 
-    // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
     rc = 0;
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, true);
+
+    // Fire event
+    if (rc == 0) {
+        sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
+    }
     return rc;
 }
 
@@ -964,7 +1041,7 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
     PIOS_Assert(obj_handle);
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjectData((struct UAVOBase *)obj_handle, true);
 
     int32_t rc = -1;
 
@@ -1008,13 +1085,15 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
         memcpy(InstanceData(instEntry) + offset, dataIn, size);
     }
 
-
-    // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
     rc = 0;
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, true);
+
+    // Fire event
+    if (rc == 0) {
+        sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
+    }
     return rc;
 }
 
@@ -1030,8 +1109,14 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 {
     PIOS_Assert(obj_handle);
 
+    // Lock-free path for small single instance objects
+    if (IsSeqlocked(obj_handle) && instId == 0 &&
+        readSeqlocked((struct UAVOData *)obj_handle, dataOut, 0, ((struct UAVOData *)obj_handle)->instance_size)) {
+        return 0;
+    }
+
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjectData((struct UAVOBase *)obj_handle, false);
 
     int32_t rc = -1;
 
@@ -1061,7 +1146,7 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
     rc = 0;
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, false);
     return rc;
 }
 
@@ -1076,8 +1161,15 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
 {
     PIOS_Assert(obj_handle);
 
+    // Lock-free path for small single instance objects
+    if (IsSeqlocked(obj_handle) && instId == 0 &&
+        (size + offset) <= ((struct UAVOData *)obj_handle)->instance_size &&
+        readSeqlocked((struct UAVOData *)obj_handle, dataOut, offset, size)) {
+        return 0;
+    }
+
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjectData((struct UAVOBase *)obj_handle, false);
 
     int32_t rc = -1;
 
@@ -1119,7 +1211,7 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
     rc = 0;
 
 unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
+    unlockObjectData((struct UAVOBase *)obj_handle, false);
     return rc;
 }
 
@@ -1138,11 +1230,8 @@ int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata *dataIn)
         return -1;
     }
 
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
     UAVObjSetData((UAVObjHandle)MetaObjectPtr((struct UAVOData *)obj_handle), dataIn);
 
-    xSemaphoreGiveRecursive(mutex);
     return 0;
 }
 
@@ -1156,9 +1245,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata *dataOut)
 {
     PIOS_Assert(obj_handle);
 
-    // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
     // Get metadata
     if (IsMetaobject(obj_handle)) {
         memcpy(dataOut, &defMetadata, sizeof(UAVObjMetadata));
@@ -1167,8 +1253,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata *dataOut)
                       dataOut);
     }
 
-    // Unlock
-    xSemaphoreGiveRecursive(mutex);
     return 0;
 }
 
@@ -1439,9 +1523,7 @@ void UAVObjRequestUpdate(UAVObjHandle obj_handle)
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATE_REQ);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1461,9 +1543,7 @@ void UAVObjUpdated(UAVObjHandle obj_handle)
 void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED_MANUAL);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1474,9 +1554,7 @@ void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /*
@@ -1496,9 +1574,7 @@ void UAVObjLogging(UAVObjHandle obj_handle)
 void UAVObjInstanceLogging(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_LOGGING_MANUAL);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1525,6 +1601,10 @@ xSemaphoreGiveRecursive(mutex);
 
 /**
  * Send a triggered event to all event queues registered on the object.
+ * Does not take any lock, the event list of an object is only appended to
+ * and its entries are never freed, see connectObj() and disconnectObj().
+ * The queue and callback of an entry can be cleared or set at any time,
+ * so each one is read once and only that copy is used.
  */
 int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType triggered_event)
 {
@@ -1541,22 +1621,26 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
 
     LL_FOREACH(obj->next_event, event) {
         if (event->eventMask == 0 || (event->eventMask & triggered_event) != 0) {
+            xQueueHandle queue     = *(xQueueHandle volatile *)&event->queue;
+            UAVObjEventCallback cb = *(UAVObjEventCallback volatile *)&event->cb;
+
             // Send to queue if a valid queue is registered
-            if (event->queue) {
+            if (queue) {
                 // will not block
-                if (xQueueSend(event->queue, &msg, 0) != pdTRUE) {
-                    ++stats.eventQueueErrors;
+                if (xQueueSend(queue, &msg, 0) != pdTRUE) {
+                    // no lock here, counters are updated atomically
+                    __sync_fetch_and_add(&stats.eventQueueErrors, 1);
                     stats.lastQueueErrorID = UAVObjGetID(obj);
                 }
             }
 
             // Invoke callback (from event task) if a valid one is registered
-            if (event->cb) {
+            if (cb) {
                 if (event->fast) {
-                    event->cb(&msg);
-                } else if (EventCallbackDispatch(&msg, event->cb) != pdTRUE) {
+                    cb(&msg);
+                } else if (EventCallbackDispatch(&msg, cb) != pdTRUE) {
                     // invoke callback from the event task, will not block
-                    ++stats.eventCallbackErrors;
+                    __sync_fetch_and_add(&stats.eventCallbackErrors, 1);
                     stats.lastCallbackErrorID = UAVObjGetID(obj);
                 }
             }
@@ -1568,6 +1652,7 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
 
 /**
  * Create a new object instance, return the instance info or NULL if failure.
+ * Must be called with the object manager mutex held.
  */
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
 {
@@ -1603,9 +1688,11 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
         return NULL;
     }
     memset(instEntry, 0, size);
-    LL_APPEND(((struct UAVOMulti *)obj)->instance0.next, instEntry);
 
+    lockObjectData(&obj->base, true);
+    LL_APPEND(((struct UAVOMulti *)obj)->instance0.next, instEntry);
     ((struct UAVOMulti *)obj)->num_instances++;
+    unlockObjectData(&obj->base, true);
 
     // Fire event
     instanceAutoUpdated((UAVObjHandle)obj, instId);
@@ -1661,6 +1748,77 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
     }
 }
 
+/**
+ * Get the data lock protecting an object, metaobjects share the lock of their parent object
+ */
+static inline xSemaphoreHandle getDataLock(struct UAVOBase *obj)
+{
+    struct UAVOData *uavo_data;
+
+    if (obj->flags.isMeta) {
+        uavo_data = container_of((struct UAVOMeta *)obj, struct UAVOData, metaObj);
+    } else {
+        uavo_data = (struct UAVOData *)obj;
+    }
+    return dataLocks[(uavo_data->id >> 1) % UAVOBJ_DATA_LOCKS];
+}
+
+/**
+ * Lock the data of an object.
+ * \param[in] obj The object
+ * \param[in] write True if the object data will be modified, this starts a
+ * write section for seqlocked objects
+ */
+void lockObjectData(struct UAVOBase *obj, bool write)
+{
+    xSemaphoreTakeRecursive(getDataLock(obj), portMAX_DELAY);
+    if (write && obj->flags.isSeqlocked) {
+        ((struct UAVOData *)obj)->seq++;
+        __sync_synchronize();
+    }
+}
+
+/**
+ * Unlock the data of an object.
+ * \param[in] obj The object
+ * \param[in] write Must match the value passed to lockObjectData()
+ */
+void unlockObjectData(struct UAVOBase *obj, bool write)
+{
+    if (write && obj->flags.isSeqlocked) {
+        __sync_synchronize();
+        ((struct UAVOData *)obj)->seq++;
+    }
+    xSemaphoreGiveRecursive(getDataLock(obj));
+}
+
+/**
+ * Copy data out of a seqlocked object without taking its lock.
+ * A reader that preempted a writer would spin forever on a single core, so if a
+ * write is in progress (or keeps interfering) give up and let the caller take the lock.
+ * \param[in] obj The object
+ * \param[out] dataOut The destination buffer
+ * \param[in] offset Offset of the first byte to read
+ * \param[in] size Number of bytes to read
+ * \return true if a consistent copy was made, false if the lock has to be taken
+ */
+static bool readSeqlocked(struct UAVOData *obj, void *dataOut, uint32_t offset, uint32_t size)
+{
+    for (uint8_t retry = 0; retry < UAVOBJ_SEQLOCK_RETRIES; ++retry) {
+        uint16_t seq = obj->seq;
+        if (seq & 1) {
+            return false;
+        }
+        __sync_synchronize();
+        memcpy(dataOut, (uint8_t *)ObjSingleInstanceDataOffset(obj) + offset, size);
+        __sync_synchronize();
+        if (obj->seq == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * Connect an event queue to the object, if the queue is already connected then the event mask is only updated.
  * \param[in] obj The object handle
@@ -1673,6 +1831,7 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
                           UAVObjEventCallback cb, uint8_t eventMask, bool fast)
 {
     struct ObjectEventEntry *event;
+    struct ObjectEventEntry *unused = NULL;
     struct UAVOBase *obj;
 
     // Check that the queue is not already connected, if it is simply update event mask
@@ -1684,6 +1843,19 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
             event->fast = fast;
             return 0;
         }
+        if (event->queue == NULL && event->cb == NULL && unused == NULL) {
+            unused = event;
+        }
+    }
+
+    // Reuse an entry left over by disconnectObj()
+    if (unused) {
+        unused->eventMask = eventMask;
+        unused->fast = fast;
+        __sync_synchronize();
+        unused->queue = queue;
+        unused->cb    = cb;
+        return 0;
     }
 
     // Add queue to list
@@ -1695,6 +1867,9 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     event->cb        = cb;
     event->eventMask = eventMask;
     event->fast      = fast;
+    event->next      = NULL;
+    // The entry must be complete before sendEvent() can see it
+    __sync_synchronize();
     LL_APPEND(obj->next_event, event);
 
     // Done
@@ -1714,13 +1889,14 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     struct ObjectEventEntry *event;
     struct UAVOBase *obj;
 
-    // Find queue and remove it
+    // Find queue and clear its entry, the entry is kept in the list (and reused
+    // by connectObj()) so that sendEvent() can walk the list without locking
     obj = (struct UAVOBase *)obj_handle;
     LL_FOREACH(obj->next_event, event) {
         if ((event->queue == queue
              && event->cb == cb)) {
-            LL_DELETE(obj->next_event, event);
-            vPortFree(event);
+            event->queue = NULL;
+            event->cb    = NULL;
             return 0;
         }
     }
@@ -43,30 +43,38 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
 
+    int32_t rc = -1;
+
+    lockObjectData((struct UAVOBase *)obj_handle, false);
+
     if (UAVObjIsMetaobject(obj_handle)) {
         if (instId != 0) {
-            return -1;
+            goto unlock_exit;
         }
 
         if (PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle)) != 0) {
-            return -1;
+            goto unlock_exit;
         }
     } else {
         InstanceHandle instEntry = getInstance((struct UAVOData *)obj_handle, instId);
 
         if (instEntry == NULL) {
-            return -1;
+            goto unlock_exit;
         }
 
         if (InstanceData(instEntry) == NULL) {
-            return -1;
+            goto unlock_exit;
         }
 
         if (PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle)) != 0) {
-            return -1;
+            goto unlock_exit;
         }
     }
-    return 0;
+    rc = 0;
+
+unlock_exit:
+    unlockObjectData((struct UAVOBase *)obj_handle, false);
+    return rc;
 }
 
 
@@ -82,34 +90,39 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
 
+    int32_t rc = -1;
+
+    lockObjectData((struct UAVOBase *)obj_handle, true);
+
     if (UAVObjIsMetaobject(obj_handle)) {
         if (instId != 0) {
-            return -1;
+            goto unlock_exit;
         }
 
-        // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle)) == 0) {
-            sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
-        } else {
-            return -1;
+        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle)) != 0) {
+            goto unlock_exit;
         }
     } else {
         InstanceHandle instEntry = getInstance((struct UAVOData *)obj_handle, instId);
 
         if (instEntry == NULL) {
-            return -1;
+            goto unlock_exit;
         }
 
-        // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle)) == 0) {
-            sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
-        } else {
-            return -1;
+        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle)) != 0) {
+            goto unlock_exit;
         }
     }
+    rc = 0;
 
+unlock_exit:
+    unlockObjectData((struct UAVOBase *)obj_handle, true);
 
-    return 0;
+    // Fire event on success
+    if (rc == 0) {
+        sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
+    }
+    return rc;
 }
 
 /**
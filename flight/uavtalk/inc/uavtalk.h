@@ -31,6 +31,7 @@
 
 // Public types
 typedef int32_t (*UAVTalkOutputStream)(uint8_t *data, int32_t length);
+typedef uint32_t (*UAVTalkOutputPort)();
 
 typedef struct {
     uint32_t txBytes;
@@ -48,18 +49,26 @@ typedef struct {
 
 typedef void *UAVTalkConnection;
 
+typedef enum { UAVTALK_RELAY_FORWARD = 0, UAVTALK_RELAY_RECEIVE, UAVTALK_RELAY_DROP } UAVTalkRelayAction;
+typedef UAVTalkRelayAction (*UAVTalkRelayFilter)(uint32_t objId);
+
 typedef enum { UAVTALK_STATE_ERROR = 0, UAVTALK_STATE_SYNC, UAVTALK_STATE_TYPE, UAVTALK_STATE_SIZE, UAVTALK_STATE_OBJID, UAVTALK_STATE_INSTID, UAVTALK_STATE_TIMESTAMP, UAVTALK_STATE_DATA, UAVTALK_STATE_CS, UAVTALK_STATE_COMPLETE } UAVTalkRxState;
 
 // Public functions
 UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream);
 int32_t UAVTalkSetOutputStream(UAVTalkConnection connection, UAVTalkOutputStream outputStream);
 UAVTalkOutputStream UAVTalkGetOutputStream(UAVTalkConnection connection);
+int32_t UAVTalkSetOutputPort(UAVTalkConnection connection, UAVTalkOutputPort outputPort);
 int32_t UAVTalkSendObject(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
 int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
 int32_t UAVTalkSendObjectRequest(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, int32_t timeoutMs);
+int32_t UAVTalkSetBatching(UAVTalkConnection connection, bool enabled);
+int32_t UAVTalkFlushBatch(UAVTalkConnection connection);
+int32_t UAVTalkSetDeltaUpdates(UAVTalkConnection connection, bool enabled);
 UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t *rxbuffer, uint8_t length);
 UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle, uint8_t *rxbuffer, uint8_t length, uint8_t *position);
 int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle);
+int32_t UAVTalkRelayPacketFiltered(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, UAVTalkRelayFilter filter);
 int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle);
 void UAVTalkGetStats(UAVTalkConnection connection, UAVTalkStats *stats, bool reset);
 void UAVTalkAddStats(UAVTalkConnection connection, UAVTalkStats *stats, bool reset);
@@ -46,6 +46,40 @@
 #define UAVTALK_MIN_PACKET_LENGTH  UAVTALK_MAX_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH
 #define UAVTALK_MAX_PACKET_LENGTH  UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH
 
+// batch record header : object ID(4), instance ID(2), data length(1)
+// the length lets relays split batches holding objects they do not know
+#define UAVTALK_BATCH_RECORD_HEADER_LENGTH 7
+
+// batch payload is also limited by the GCS receive buffer
+#define UAVTALK_MAX_BATCH_PAYLOAD_LENGTH   ((UAVOBJECTS_LARGEST < 255) ? UAVOBJECTS_LARGEST : 255)
+
+// delta payload : keyframe CRC(1), changed blocks, bitmap of changed blocks
+// the instance ID of a delta is the number of its keyframe, deltas are only sent against a keyframe the peer acked
+// keyframes are delta packets holding the whole object, their instance ID is UAVTALK_DELTA_KEYFRAME | number
+#define UAVTALK_DELTA_KEYFRAME             0x8000
+#define UAVTALK_DELTA_KEYFRAME_IDS         0x7FFF
+#define UAVTALK_DELTA_BLOCK_SIZE           4
+#define UAVTALK_DELTA_BITMAP_LENGTH        ((UAVOBJECTS_LARGEST + 8 * UAVTALK_DELTA_BLOCK_SIZE - 1) / (8 * UAVTALK_DELTA_BLOCK_SIZE))
+
+// number of objects per connection that can be sent as deltas, each one keeps a copy of its keyframe
+#ifndef UAVTALK_DELTA_SLOTS
+#define UAVTALK_DELTA_SLOTS                8
+#endif
+
+// smaller objects are not worth a keyframe copy
+#ifndef UAVTALK_DELTA_MIN_SIZE
+#define UAVTALK_DELTA_MIN_SIZE             48
+#endif
+
+// number of deltas sent between two full updates, also the number of full updates
+// sent while waiting for a keyframe ack before sending the keyframe again
+#define UAVTALK_DELTA_KEYFRAME_INTERVAL    16
+
+// a slot not used for that long can be given to another object
+#ifndef UAVTALK_DELTA_SLOT_IDLE_MS
+#define UAVTALK_DELTA_SLOT_IDLE_MS         2000
+#endif
+
 typedef struct {
     uint8_t  type;
     uint16_t packet_size;
@@ -60,9 +94,22 @@ typedef struct {
     uint16_t rxPacketLength;
 } UAVTalkInputProcessor;
 
+typedef struct {
+    uint32_t     objId;
+    uint8_t      *keyframe;
+    uint16_t     size;
+    uint16_t     keyframeId;
+    uint8_t      crc;
+    uint8_t      updates;
+    bool         hasKeyframe;
+    bool         acked;
+    portTickType lastUsed;
+} UAVTalkDeltaSlot;
+
 typedef struct {
     uint8_t canari;
     UAVTalkOutputStream outStream;
+    UAVTalkOutputPort   outPort;
     xSemaphoreHandle    lock;
     xSemaphoreHandle    transLock;
     xSemaphoreHandle    respSema;
@@ -73,6 +120,13 @@ typedef struct {
     UAVTalkInputProcessor iproc;
     uint8_t      *rxBuffer;
     uint8_t      *txBuffer;
+    bool         batchEnabled;
+    bool         batchPeer;
+    uint16_t     batchLength;
+    uint16_t     batchCount;
+    bool         deltaEnabled;
+    bool         deltaPeer;
+    UAVTalkDeltaSlot *deltaSlots;
 } UAVTalkConnectionData;
 
 #define UAVTALK_CANARI          0xCA
@@ -86,6 +140,8 @@ typedef struct {
 #define UAVTALK_TYPE_OBJ_ACK    (UAVTALK_TYPE_VER | 0x02)
 #define UAVTALK_TYPE_ACK        (UAVTALK_TYPE_VER | 0x03)
 #define UAVTALK_TYPE_NACK       (UAVTALK_TYPE_VER | 0x04)
+#define UAVTALK_TYPE_OBJ_BATCH  (UAVTALK_TYPE_VER | 0x05)
+#define UAVTALK_TYPE_OBJ_DELTA  (UAVTALK_TYPE_VER | 0x06)
 #define UAVTALK_TYPE_OBJ_TS     (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 #define UAVTALK_TYPE_OBJ_ACK_TS (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_ACK)
 
@@ -51,6 +51,15 @@
 static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId, int32_t timeout);
 static int32_t sendObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
 static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t packSingleObject(uint8_t *buffer, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj, int32_t length);
+static int32_t batchObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t batchSingleObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t flushBatch(UAVTalkConnectionData *connection);
+static int32_t receiveBatch(UAVTalkConnectionData *connection, uint16_t count, uint8_t *data, uint32_t length);
+static int32_t sendDelta(UAVTalkConnectionData *connection, uint32_t objId, UAVObjHandle obj);
+static UAVTalkDeltaSlot *getDeltaSlot(UAVTalkConnectionData *connection, uint32_t objId, int32_t length);
+static void deltaAck(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId);
+static int32_t sendTxBuffer(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint16_t length);
 static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t *data);
 static void updateAck(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId);
 // UavTalk Process FSM functions
@@ -81,6 +90,14 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     connection->iproc.rxPacketLength = 0;
     connection->iproc.state = UAVTALK_STATE_SYNC;
     connection->outStream   = outputStream;
+    connection->outPort     = NULL;
+    connection->batchEnabled = false;
+    connection->batchPeer   = false;
+    connection->batchLength = 0;
+    connection->batchCount  = 0;
+    connection->deltaEnabled = false;
+    connection->deltaPeer   = false;
+    connection->deltaSlots  = NULL;
     connection->lock = xSemaphoreCreateRecursiveMutex();
     connection->transLock   = xSemaphoreCreateRecursiveMutex();
     // allocate buffers
@@ -136,6 +153,33 @@ UAVTalkOutputStream UAVTalkGetOutputStream(UAVTalkConnection connectionHandle)
     return connection->outStream;
 }
 
+/**
+ * Set the COM port behind the output stream, packets are then packed
+ * directly into the port tx buffer whenever there is room for them.
+ * The output stream is still used when the tx buffer has no contiguous space.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] outputPort Function pointer that returns the current COM port (or 0), NULL to disable
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetOutputPort(UAVTalkConnection connectionHandle, UAVTalkOutputPort outputPort)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    // set output port
+    connection->outPort = outputPort;
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return 0;
+}
+
 /**
  * Get communication statistics counters
  * \param[in] connection UAVTalkConnection to be used
@@ -297,6 +341,107 @@ int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjH
     }
 }
 
+/**
+ * Allow unacked object updates to be grouped into batch packets.
+ * Batches are only sent once the other end has announced that it understands them,
+ * by sending a batch packet itself (usually an empty one).
+ * The owner of the connection must call UAVTalkFlushBatch() when it runs out of updates to send.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] enabled Selects if updates can be batched, disabling also forgets the peer announcement
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetBatching(UAVTalkConnection connectionHandle, bool enabled)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    int32_t ret = flushBatch(connection);
+    connection->batchEnabled = enabled;
+    if (!enabled) {
+        connection->batchPeer = false;
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
+/**
+ * Send the pending batch packet, if any.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkFlushBatch(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    int32_t ret = flushBatch(connection);
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
+/**
+ * Allow large single instance objects to be sent as deltas against the last acked full update.
+ * Deltas are only sent once the other end has announced that it understands them,
+ * by sending an empty delta packet.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] enabled Selects if deltas can be sent, disabling also forgets the peer announcement
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetDeltaUpdates(UAVTalkConnection connectionHandle, bool enabled)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    int32_t ret = 0;
+    if (enabled && !connection->deltaSlots && UAVTALK_DELTA_SLOTS > 0) {
+        // Slots are allocated once and never released, idle ones are handed over to other objects
+        connection->deltaSlots = pios_malloc(UAVTALK_DELTA_SLOTS * sizeof(UAVTalkDeltaSlot));
+        if (connection->deltaSlots) {
+            memset(connection->deltaSlots, 0, UAVTALK_DELTA_SLOTS * sizeof(UAVTalkDeltaSlot));
+        }
+    }
+    if (enabled && !connection->deltaSlots) {
+        enabled = false;
+        ret     = -1;
+    }
+
+    connection->deltaEnabled = enabled;
+    if (!enabled) {
+        connection->deltaPeer = false;
+        // Make sure the next peer gets full updates first
+        for (uint8_t n = 0; connection->deltaSlots && n < UAVTALK_DELTA_SLOTS; ++n) {
+            connection->deltaSlots[n].hasKeyframe = false;
+            connection->deltaSlots[n].acked = false;
+        }
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
 /**
  * Execute the requested transaction on an object.
  * \param[in] connection UAVTalkConnection to be used
@@ -349,7 +494,14 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type
         }
     } else if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS) {
         xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
-        ret = sendObject(connection, type, UAVObjGetID(obj), instId, obj);
+        if (type == UAVTALK_TYPE_OBJ && connection->deltaEnabled && connection->deltaPeer &&
+            UAVObjIsSingleInstance(obj) && UAVObjGetNumBytes(obj) >= UAVTALK_DELTA_MIN_SIZE) {
+            ret = sendDelta(connection, UAVObjGetID(obj), obj);
+        } else if (type == UAVTALK_TYPE_OBJ && connection->batchEnabled && connection->batchPeer) {
+            ret = batchObject(connection, UAVObjGetID(obj), instId, obj);
+        } else {
+            ret = sendObject(connection, type, UAVObjGetID(obj), instId, obj);
+        }
         xSemaphoreGiveRecursive(connection->lock);
     }
     return ret;
@@ -486,6 +638,9 @@ int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnecti
     // Lock
     xSemaphoreTakeRecursive(outConnection->lock, portMAX_DELAY);
 
+    // Keep packet order, the pending batch also lives in txBuffer
+    flushBatch(outConnection);
+
     outConnection->txBuffer[0] = UAVTALK_SYNC_VAL;
     // Setup type
     outConnection->txBuffer[1] = inIproc->type;
@@ -540,6 +695,105 @@ int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnecti
     return ret;
 }
 
+/**
+ * Relay a completely received packet, or receive it locally, depending on its object ID.
+ * Each object of a batch packet is handled on its own, the ones to relay are sent as a new batch.
+ * \param[in] inConnectionHandle UAVTalkConnection the packet was received on
+ * \param[in] outConnectionHandle UAVTalkConnection to relay the packet to
+ * \param[in] filter Tells what to do with an object
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkRelayPacketFiltered(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, UAVTalkRelayFilter filter)
+{
+    UAVTalkConnectionData *inConnection;
+
+    CHECKCONHANDLE(inConnectionHandle, inConnection, return -1);
+    UAVTalkInputProcessor *inIproc = &inConnection->iproc;
+
+    // Empty batches announce batch support, they are relayed like any other packet
+    if (inIproc->type != UAVTALK_TYPE_OBJ_BATCH || inIproc->instId == 0) {
+        switch (filter(inIproc->objId)) {
+        case UAVTALK_RELAY_FORWARD:
+            return UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+
+        case UAVTALK_RELAY_RECEIVE:
+            return UAVTalkReceiveObject(inConnectionHandle);
+
+        default:
+            return 0;
+        }
+    }
+
+    // The input packet must be completely parsed.
+    if (inIproc->state != UAVTALK_STATE_COMPLETE) {
+        inConnection->stats.rxErrors++;
+
+        return -1;
+    }
+
+    UAVTalkConnectionData *outConnection;
+    CHECKCONHANDLE(outConnectionHandle, outConnection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(outConnection->lock, portMAX_DELAY);
+
+    uint32_t position = 0;
+    int32_t ret = 0;
+    for (uint16_t n = 0; n < inIproc->instId; ++n) {
+        if (position + UAVTALK_BATCH_RECORD_HEADER_LENGTH > inIproc->length) {
+            ret = -1;
+            break;
+        }
+        uint8_t *record = &inConnection->rxBuffer[position];
+        uint32_t objId  = record[0] | (record[1] << 8) | (record[2] << 16) | ((uint32_t)record[3] << 24);
+        uint16_t instId = record[4] | (record[5] << 8);
+        uint16_t recordLength = UAVTALK_BATCH_RECORD_HEADER_LENGTH + record[6];
+
+        position += recordLength;
+        if (position > inIproc->length || recordLength > UAVTALK_MAX_BATCH_PAYLOAD_LENGTH) {
+            ret = -1;
+            break;
+        }
+
+        switch (filter(objId)) {
+        case UAVTALK_RELAY_FORWARD:
+            // Copy the record to the pending batch of the output connection
+            if (outConnection->batchLength + recordLength > UAVTALK_MAX_BATCH_PAYLOAD_LENGTH && flushBatch(outConnection) == -1) {
+                ret = -1;
+            }
+            memcpy(&outConnection->txBuffer[UAVTALK_MIN_HEADER_LENGTH + outConnection->batchLength], record, recordLength);
+            outConnection->batchLength += recordLength;
+            outConnection->batchCount++;
+            break;
+
+        case UAVTALK_RELAY_RECEIVE:
+        {
+            UAVObjHandle obj = UAVObjGetByID(objId);
+            if (!obj || UAVObjGetNumBytes(obj) != record[6] ||
+                receiveObject(inConnection, UAVTALK_TYPE_OBJ, objId, instId, &record[UAVTALK_BATCH_RECORD_HEADER_LENGTH]) == -1) {
+                ret = -1;
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    // Send the relayed objects right away, like UAVTalkRelayPacket() does
+    if (flushBatch(outConnection) == -1) {
+        ret = -1;
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(outConnection->lock);
+
+    // Done
+    return ret;
+}
+
 /**
  * Complete receiving a UAVTalk packet.  This will cause the packet to be unpacked, acked, etc.
  * \param[in] connectionHandle UAVTalkConnection to be used
@@ -557,6 +811,20 @@ int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle)
         return -1;
     }
 
+    if (iproc->type == UAVTALK_TYPE_OBJ_BATCH) {
+        // The instance ID field of a batch holds the number of objects
+        return receiveBatch(connection, iproc->instId, connection->rxBuffer, iproc->length);
+    }
+
+    if (iproc->type == UAVTALK_TYPE_OBJ_DELTA) {
+        // Only the empty announcement is expected, no keyframes are kept on this side
+        if (iproc->objId != 0) {
+            return -1;
+        }
+        connection->deltaPeer = true;
+        return 0;
+    }
+
     return receiveObject(connection, iproc->type, iproc->objId, iproc->instId, connection->rxBuffer);
 }
 
@@ -683,6 +951,8 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
         if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
             // Check if an ACK is pending
             updateAck(connection, type, objId, instId);
+            // Check if a keyframe is acked
+            deltaAck(connection, objId, instId);
         } else {
             ret = -1;
         }
@@ -789,28 +1059,8 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
         return -1;
     }
 
-    // Setup sync byte
-    connection->txBuffer[0] = UAVTALK_SYNC_VAL;
-    // Setup type
-    connection->txBuffer[1] = type;
-    // next 2 bytes are reserved for data length (inserted here later)
-    // Setup object ID
-    connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
-    connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
-    connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
-    connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
-    // Setup instance ID
-    connection->txBuffer[8] = (uint8_t)(instId & 0xFF);
-    connection->txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
-    int32_t headerLength = 10;
-
-    // Add timestamp when the transaction type is appropriate
-    if (type & UAVTALK_TIMESTAMPED) {
-        portTickType time = xTaskGetTickCount();
-        connection->txBuffer[10] = (uint8_t)(time & 0xFF);
-        connection->txBuffer[11] = (uint8_t)((time >> 8) & 0xFF);
-        headerLength += 2;
-    }
+    // Keep packet order, the pending batch also lives in txBuffer
+    flushBatch(connection);
 
     // Determine data length
     int32_t length;
@@ -826,33 +1076,477 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
         return -1;
     }
 
+    int32_t headerLength = (type & UAVTALK_TIMESTAMPED) ? UAVTALK_MAX_HEADER_LENGTH : UAVTALK_MIN_HEADER_LENGTH;
+    uint16_t tx_msg_len  = headerLength + length + UAVTALK_CHECKSUM_LENGTH;
+    int32_t rc;
+
+    // Pack in place into the port tx buffer when possible, this saves copying the whole packet
+    uint32_t outPort  = connection->outPort ? connection->outPort() : 0;
+    uint8_t *txBuffer = outPort ? PIOS_COM_ReserveTxBuffer(outPort, tx_msg_len) : NULL;
+    if (txBuffer) {
+        if (packSingleObject(txBuffer, type, objId, instId, obj, length) == -1) {
+            // Discard the reservation
+            PIOS_COM_CommitTxBuffer(outPort, 0);
+            connection->stats.txErrors++;
+            return -1;
+        }
+        rc = PIOS_COM_CommitTxBuffer(outPort, tx_msg_len);
+    } else {
+        if (packSingleObject(connection->txBuffer, type, objId, instId, obj, length) == -1) {
+            connection->stats.txErrors++;
+            return -1;
+        }
+        rc = (*connection->outStream)(connection->txBuffer, tx_msg_len);
+    }
+
+    // Update stats
+    if (rc == tx_msg_len) {
+        ++connection->stats.txObjects;
+        connection->stats.txObjectBytes += length;
+        connection->stats.txBytes += tx_msg_len;
+    } else {
+        // Port closed or still busy after PIOS_COM_SendBuffer() waited for it, retrying here
+        // would only hold the connection lock longer. Acked updates are retried by the caller,
+        // plain updates are superseded by the next one.
+        connection->stats.txErrors++;
+        connection->stats.txBytes += (rc > 0) ? rc : 0;
+        return -1;
+    }
+
+    // Done
+    return 0;
+}
+
+/**
+ * Build a complete packet (header, object data and checksum) into a buffer.
+ * \param[in] buffer Buffer to pack into, must hold the whole packet
+ * \param[in] type Transaction type
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID
+ * \param[in] obj Object handle to pack (null when type is NACK)
+ * \param[in] length Length of the object data
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t packSingleObject(uint8_t *buffer, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj, int32_t length)
+{
+    // Setup sync byte
+    buffer[0] = UAVTALK_SYNC_VAL;
+    // Setup type
+    buffer[1] = type;
+    // next 2 bytes are reserved for data length (inserted here later)
+    // Setup object ID
+    buffer[4] = (uint8_t)(objId & 0xFF);
+    buffer[5] = (uint8_t)((objId >> 8) & 0xFF);
+    buffer[6] = (uint8_t)((objId >> 16) & 0xFF);
+    buffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+    // Setup instance ID
+    buffer[8] = (uint8_t)(instId & 0xFF);
+    buffer[9] = (uint8_t)((instId >> 8) & 0xFF);
+    int32_t headerLength = UAVTALK_MIN_HEADER_LENGTH;
+
+    // Add timestamp when the transaction type is appropriate
+    if (type & UAVTALK_TIMESTAMPED) {
+        portTickType time = xTaskGetTickCount();
+        buffer[10] = (uint8_t)(time & 0xFF);
+        buffer[11] = (uint8_t)((time >> 8) & 0xFF);
+        headerLength += 2;
+    }
+
     // Copy data (if any)
     if (length > 0) {
-        if (UAVObjPack(obj, instId, &connection->txBuffer[headerLength]) == -1) {
-            connection->stats.txErrors++;
+        if (UAVObjPack(obj, instId, &buffer[headerLength]) == -1) {
             return -1;
         }
     }
 
     // Store the packet length
-    connection->txBuffer[2] = (uint8_t)((headerLength + length) & 0xFF);
-    connection->txBuffer[3] = (uint8_t)(((headerLength + length) >> 8) & 0xFF);
+    buffer[2] = (uint8_t)((headerLength + length) & 0xFF);
+    buffer[3] = (uint8_t)(((headerLength + length) >> 8) & 0xFF);
 
     // Calculate and store checksum
-    connection->txBuffer[headerLength + length] = PIOS_CRC_updateCRC(0, connection->txBuffer, headerLength + length);
+    buffer[headerLength + length] = PIOS_CRC_updateCRC(0, buffer, headerLength + length);
 
-    // Send object
-    uint16_t tx_msg_len = headerLength + length + UAVTALK_CHECKSUM_LENGTH;
+    return 0;
+}
+
+/**
+ * Add an object update to the pending batch packet.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances
+ * \param[in] obj Object handle to send
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t batchObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj)
+{
+    uint32_t numInst;
+    uint32_t n;
+    int32_t ret;
+
+    // If all instances are requested and this is a single instance object, force instance ID to zero
+    if ((instId == UAVOBJ_ALL_INSTANCES) && UAVObjIsSingleInstance(obj)) {
+        instId = 0;
+    }
+
+    if (instId == UAVOBJ_ALL_INSTANCES) {
+        // Get number of instances
+        numInst = UAVObjGetNumInstances(obj);
+        // Add all instances in reverse order, like sendObject()
+        ret     = 0;
+        for (n = 0; n < numInst; ++n) {
+            ret = batchSingleObject(connection, objId, numInst - n - 1, obj);
+            if (ret == -1) {
+                break;
+            }
+        }
+    } else {
+        ret = batchSingleObject(connection, objId, instId, obj);
+    }
+
+    return ret;
+}
+
+/**
+ * Add a single object instance to the pending batch packet.
+ * The batch is built in txBuffer and sent when the next record would not fit.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] obj Object handle to send
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t batchSingleObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj)
+{
+    int32_t length = UAVObjGetNumBytes(obj);
+    int32_t recordLength = UAVTALK_BATCH_RECORD_HEADER_LENGTH + length;
+
+    if (recordLength > UAVTALK_MAX_BATCH_PAYLOAD_LENGTH) {
+        // Too large to share a packet, send it on its own
+        return sendSingleObject(connection, UAVTALK_TYPE_OBJ, objId, instId, obj);
+    }
+
+    if (connection->batchLength + recordLength > UAVTALK_MAX_BATCH_PAYLOAD_LENGTH) {
+        if (flushBatch(connection) == -1) {
+            return -1;
+        }
+    }
+
+    // Setup object ID and instance ID, followed by the object data
+    uint8_t *record = &connection->txBuffer[UAVTALK_MIN_HEADER_LENGTH + connection->batchLength];
+    record[0] = (uint8_t)(objId & 0xFF);
+    record[1] = (uint8_t)((objId >> 8) & 0xFF);
+    record[2] = (uint8_t)((objId >> 16) & 0xFF);
+    record[3] = (uint8_t)((objId >> 24) & 0xFF);
+    record[4] = (uint8_t)(instId & 0xFF);
+    record[5] = (uint8_t)((instId >> 8) & 0xFF);
+    record[6] = (uint8_t)length;
+    if (UAVObjPack(obj, instId, &record[UAVTALK_BATCH_RECORD_HEADER_LENGTH]) == -1) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    connection->batchLength += recordLength;
+    connection->batchCount++;
+
+    // Update stats, the packet bytes are accounted when the batch is sent
+    ++connection->stats.txObjects;
+    connection->stats.txObjectBytes += length;
+
+    return 0;
+}
+
+/**
+ * Send the pending batch packet, if any.
+ * Header is the usual one, with a zero object ID and the number of objects as instance ID.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t flushBatch(UAVTalkConnectionData *connection)
+{
+    if (connection->batchCount == 0) {
+        return 0;
+    }
+
+    uint16_t count  = connection->batchCount;
+    uint16_t length = connection->batchLength;
+    connection->batchCount  = 0;
+    connection->batchLength = 0;
+
+    // No object ID, number of objects in the instance ID
+    return sendTxBuffer(connection, UAVTALK_TYPE_OBJ_BATCH, 0, count, length);
+}
+
+/**
+ * Receive a batch packet, each object is handled like an OBJ message.
+ * Receiving a batch also tells that the other end understands them.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] count Number of objects in the batch
+ * \param[in] data Batch payload
+ * \param[in] length Payload length
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t receiveBatch(UAVTalkConnectionData *connection, uint16_t count, uint8_t *data, uint32_t length)
+{
+    uint32_t position = 0;
+    int32_t ret = 0;
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    connection->batchPeer = true;
+
+    for (uint16_t n = 0; n < count; ++n) {
+        if (position + UAVTALK_BATCH_RECORD_HEADER_LENGTH > length) {
+            ret = -1;
+            break;
+        }
+        uint8_t *record = &data[position];
+        uint32_t objId  = record[0] | (record[1] << 8) | (record[2] << 16) | ((uint32_t)record[3] << 24);
+        uint16_t instId = record[4] | (record[5] << 8);
+
+        position += UAVTALK_BATCH_RECORD_HEADER_LENGTH + record[6];
+        if (position > length) {
+            ret = -1;
+            break;
+        }
+        // Unknown objects are skipped, the record length gives the next one
+        UAVObjHandle obj = UAVObjGetByID(objId);
+        if (!obj || UAVObjGetNumBytes(obj) != record[6] ||
+            receiveObject(connection, UAVTALK_TYPE_OBJ, objId, instId, &record[UAVTALK_BATCH_RECORD_HEADER_LENGTH]) == -1) {
+            ret = -1;
+        }
+    }
+
+    if (position != length) {
+        ret = -1;
+    }
+
+    // Unlock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    // Done
+    return ret;
+}
+
+/**
+ * Send a single instance object as a delta against the last full update (keyframe) acked by the peer.
+ * The delta holds the keyframe CRC, the blocks that changed since the keyframe and a bitmap of those blocks,
+ * so losing one does not break the next ones. Its instance ID is the number of the keyframe.
+ * Keyframes are full delta packets with UAVTALK_DELTA_KEYFRAME set in their instance ID, the peer acks them
+ * with the same instance ID. Full updates are sent until the last keyframe is acked, so a delta is never made
+ * against a keyframe the peer did not get.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] obj Object handle to send
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t sendDelta(UAVTalkConnectionData *connection, uint32_t objId, UAVObjHandle obj)
+{
+    int32_t length = UAVObjGetNumBytes(obj);
+    UAVTalkDeltaSlot *slot = getDeltaSlot(connection, objId, length);
+
+    if (!slot) {
+        // Out of slots, send the whole object
+        return sendObject(connection, UAVTALK_TYPE_OBJ, objId, 0, obj);
+    }
+    slot->lastUsed = xTaskGetTickCount();
+
+    // Keep packet order, the pending batch also lives in txBuffer
+    flushBatch(connection);
+
+    // Pack the object one byte after the header, where the delta data starts
+    uint8_t *data = &connection->txBuffer[UAVTALK_MIN_HEADER_LENGTH + 1];
+    if (UAVObjPack(obj, 0, data) == -1) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    // Find changed blocks
+    uint8_t bitmap[UAVTALK_DELTA_BITMAP_LENGTH];
+    uint16_t numBlocks    = (length + UAVTALK_DELTA_BLOCK_SIZE - 1) / UAVTALK_DELTA_BLOCK_SIZE;
+    uint16_t bitmapLength = (numBlocks + 7) / 8;
+    uint16_t deltaLength  = 1 + bitmapLength;
+    memset(bitmap, 0, bitmapLength);
+    if (slot->acked) {
+        for (uint16_t n = 0; n < numBlocks; ++n) {
+            uint16_t offset    = n * UAVTALK_DELTA_BLOCK_SIZE;
+            uint16_t blockSize = (length - offset < UAVTALK_DELTA_BLOCK_SIZE) ? length - offset : UAVTALK_DELTA_BLOCK_SIZE;
+            if (memcmp(&data[offset], &slot->keyframe[offset], blockSize) != 0) {
+                bitmap[n / 8] |= 1 << (n % 8);
+                deltaLength   += blockSize;
+            }
+        }
+    }
+
+    int32_t rc;
+    if (!slot->hasKeyframe || slot->updates >= UAVTALK_DELTA_KEYFRAME_INTERVAL || (slot->acked && deltaLength >= length)) {
+        // Send a new keyframe, deltas are made against it once acked
+        uint16_t keyframeId = (slot->keyframeId + 1) % UAVTALK_DELTA_KEYFRAME_IDS;
+        memmove(data - 1, data, length);
+        rc = sendTxBuffer(connection, UAVTALK_TYPE_OBJ_DELTA, objId, UAVTALK_DELTA_KEYFRAME | keyframeId, length);
+        if (rc == 0) {
+            memcpy(slot->keyframe, data - 1, length);
+            slot->keyframeId  = keyframeId;
+            slot->crc = PIOS_CRC_updateCRC(0, slot->keyframe, length);
+            slot->updates     = 0;
+            slot->hasKeyframe = true;
+            slot->acked = false;
+        }
+    } else if (!slot->acked) {
+        // Still waiting for the keyframe ack, send a plain full update
+        memmove(data - 1, data, length);
+        rc = sendTxBuffer(connection, UAVTALK_TYPE_OBJ, objId, 0, length);
+        if (rc == 0) {
+            slot->updates++;
+        }
+    } else {
+        // Move the changed blocks to the front, they never overlap blocks still to be read
+        uint16_t position = 0;
+        for (uint16_t n = 0; n < numBlocks; ++n) {
+            if (bitmap[n / 8] & (1 << (n % 8))) {
+                uint16_t offset    = n * UAVTALK_DELTA_BLOCK_SIZE;
+                uint16_t blockSize = (length - offset < UAVTALK_DELTA_BLOCK_SIZE) ? length - offset : UAVTALK_DELTA_BLOCK_SIZE;
+                memmove(&data[position], &data[offset], blockSize);
+                position += blockSize;
+            }
+        }
+        memcpy(&data[position], bitmap, bitmapLength);
+        data[-1] = slot->crc;
+        rc = sendTxBuffer(connection, UAVTALK_TYPE_OBJ_DELTA, objId, slot->keyframeId, deltaLength);
+        if (rc == 0) {
+            slot->updates++;
+        }
+    }
+
+    if (rc == 0) {
+        ++connection->stats.txObjects;
+        connection->stats.txObjectBytes += length;
+    }
+
+    return rc;
+}
+
+/**
+ * Get the delta slot of an object.
+ * A free slot is bound to the object when needed, or else the slot idle for the
+ * longest time if it has been idle for UAVTALK_DELTA_SLOT_IDLE_MS and is large enough.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] length Object length
+ * \return The slot, NULL if all slots are busy with other objects
+ */
+static UAVTalkDeltaSlot *getDeltaSlot(UAVTalkConnectionData *connection, uint32_t objId, int32_t length)
+{
+    UAVTalkDeltaSlot *idle = NULL;
+    portTickType now = xTaskGetTickCount();
+
+    for (uint8_t n = 0; n < UAVTALK_DELTA_SLOTS; ++n) {
+        UAVTalkDeltaSlot *slot = &connection->deltaSlots[n];
+        if (slot->keyframe && slot->objId == objId) {
+            return slot;
+        }
+        if (!slot->keyframe) {
+            // Slots are used in order, there is no match after the first unused one
+            slot->keyframe = pios_malloc(length);
+            if (!slot->keyframe) {
+                break;
+            }
+            slot->size  = length;
+            slot->objId = objId;
+            slot->hasKeyframe = false;
+            slot->acked = false;
+            return slot;
+        }
+        portTickType idleTime = now - slot->lastUsed;
+        if (slot->size >= length && idleTime >= UAVTALK_DELTA_SLOT_IDLE_MS / portTICK_RATE_MS &&
+            (!idle || idleTime > (portTickType)(now - idle->lastUsed))) {
+            idle = slot;
+        }
+    }
+
+    if (idle) {
+        // Keyframes are never freed, F1 targets use heap_1
+        idle->objId = objId;
+        idle->hasKeyframe = false;
+        idle->acked = false;
+    }
+    return idle;
+}
+
+/**
+ * Mark the keyframe of an object as received by the peer.
+ * Only the ack of the last keyframe sent counts, acks of older keyframes
+ * and of ordinary acked updates are ignored.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID of the ACK
+ * \param[in] instId The instance ID of the ACK
+ */
+static void deltaAck(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId)
+{
+    if (!(instId & UAVTALK_DELTA_KEYFRAME)) {
+        return;
+    }
+    for (uint8_t n = 0; connection->deltaSlots && n < UAVTALK_DELTA_SLOTS; ++n) {
+        UAVTalkDeltaSlot *slot = &connection->deltaSlots[n];
+        if (slot->keyframe && slot->objId == objId) {
+            if (slot->hasKeyframe && !slot->acked && instId == (UAVTALK_DELTA_KEYFRAME | slot->keyframeId)) {
+                slot->acked   = true;
+                slot->updates = 0;
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * Complete the header and checksum of a packet whose payload is already in txBuffer, then send it.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] type Transaction type, can not be timestamped
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID
+ * \param[in] length Payload length
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t sendTxBuffer(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint16_t length)
+{
+    if (!connection->outStream) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    // Setup sync byte, type and packet length
+    connection->txBuffer[0] = UAVTALK_SYNC_VAL;
+    connection->txBuffer[1] = type;
+    connection->txBuffer[2] = (uint8_t)((UAVTALK_MIN_HEADER_LENGTH + length) & 0xFF);
+    connection->txBuffer[3] = (uint8_t)(((UAVTALK_MIN_HEADER_LENGTH + length) >> 8) & 0xFF);
+    // Setup object ID
+    connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
+    connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
+    connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
+    connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+    // Setup instance ID
+    connection->txBuffer[8] = (uint8_t)(instId & 0xFF);
+    connection->txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
+
+    // Calculate and store checksum
+    connection->txBuffer[UAVTALK_MIN_HEADER_LENGTH + length] = PIOS_CRC_updateCRC(0, connection->txBuffer, UAVTALK_MIN_HEADER_LENGTH + length);
+
+    // Send packet
+    uint16_t tx_msg_len = UAVTALK_MIN_HEADER_LENGTH + length + UAVTALK_CHECKSUM_LENGTH;
     int32_t rc = (*connection->outStream)(connection->txBuffer, tx_msg_len);
 
     // Update stats
     if (rc == tx_msg_len) {
-        ++connection->stats.txObjects;
-        connection->stats.txObjectBytes += length;
         connection->stats.txBytes += tx_msg_len;
     } else {
         connection->stats.txErrors++;
-        // TODO rc == -1 connection not open, -2 buffer full should retry
         connection->stats.txBytes += (rc > 0) ? rc : 0;
         return -1;
     }
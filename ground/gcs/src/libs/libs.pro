@@ -8,6 +8,7 @@ SUBDIRS = \
     aggregation \
     extensionsystem \
     utils \
+    opldecoder \
     opmapcontrol \
     qwt \
     sdlgamepad
@@ -0,0 +1,310 @@
+/**
+ ******************************************************************************
+ *
+ * @file       opldecoder.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSLibraries GCS Libraries
+ * @{
+ * @addtogroup OplDecoder
+ * @{
+ * @brief Batch decoder of GCS .opl logs into per field columns
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "opldecoder.h"
+
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QTextStream>
+#include <QtEndian>
+#include <QDebug>
+
+#include <utils/crc.h>
+
+// .opl record : timestamp(4), data size(8), one UAVTalk frame
+#define RECORD_HEADER_SIZE 12
+#define MAX_RECORD_SIZE    (1024 * 1024)
+
+// UAVTalk frame : sync(1), type (1), size(2), object ID(4), instance ID(2), data, crc(1)
+#define SYNC_VAL           0x3C
+#define TYPE_MASK          0xF8
+#define TYPE_VER           0x20
+#define TYPE_OBJ           (TYPE_VER | 0x00)
+#define TYPE_OBJ_ACK       (TYPE_VER | 0x02)
+#define HEADER_LENGTH      10
+#define CHECKSUM_LENGTH    1
+
+// Below this many records per thread splitting the work does not pay off
+#define MIN_CHUNK_RECORDS  4096
+
+struct OplDecoder::Chunk {
+    int first;
+    int last;
+    int skipped;
+    QHash<quint32, OplObjectColumns> columns;
+};
+
+class OplChunkTask : public QRunnable {
+public:
+    OplChunkTask(const OplDecoder *decoder, OplDecoder::Chunk *chunk) : m_decoder(decoder), m_chunk(chunk) {}
+
+    void run()
+    {
+        m_decoder->decodeChunk(m_chunk);
+    }
+
+private:
+    const OplDecoder *m_decoder;
+    OplDecoder::Chunk *m_chunk;
+};
+
+int OplFieldInfo::typeSize(FieldType type)
+{
+    switch (type) {
+    case INT16:
+    case UINT16:
+        return 2;
+
+    case INT32:
+    case UINT32:
+    case FLOAT32:
+        return 4;
+
+    default:
+        return 1;
+    }
+}
+
+double OplColumn::value(int sample, quint32 element) const
+{
+    int index = sample * m_elements + element;
+
+    switch (m_type) {
+    case OplFieldInfo::INT8:
+        return values<qint8>()[index];
+
+    case OplFieldInfo::INT16:
+        return values<qint16>()[index];
+
+    case OplFieldInfo::INT32:
+        return values<qint32>()[index];
+
+    case OplFieldInfo::UINT16:
+        return values<quint16>()[index];
+
+    case OplFieldInfo::UINT32:
+        return values<quint32>()[index];
+
+    case OplFieldInfo::FLOAT32:
+        return values<float>()[index];
+
+    default:
+        return values<quint8>()[index];
+    }
+}
+
+OplObjectColumns::OplObjectColumns(const OplObjectInfo &info) :
+    m_objId(info.objId), m_name(info.name)
+{
+    foreach(const OplFieldInfo &field, info.fields) {
+        m_columns << OplColumn(field);
+    }
+}
+
+void OplObjectColumns::append(quint32 timeStamp, quint16 instId, const quint8 *data, const OplObjectInfo &info)
+{
+    m_timeStamps << timeStamp;
+    m_instIds << instId;
+    for (int i = 0; i < info.fields.size(); i++) {
+        const OplFieldInfo &field = info.fields.at(i);
+        m_columns[i].data().append((const char *)data + field.offset, OplFieldInfo::typeSize(field.type) * field.elements);
+    }
+}
+
+void OplObjectColumns::append(const OplObjectColumns &other)
+{
+    m_timeStamps += other.m_timeStamps;
+    m_instIds    += other.m_instIds;
+    for (int i = 0; i < m_columns.size(); i++) {
+        m_columns[i].data().append(other.m_columns.at(i).data());
+    }
+}
+
+bool OplObjectColumns::writeCSV(QIODevice *device) const
+{
+    QTextStream stream(device);
+
+    stream << "timestamp,instance";
+    foreach(const OplColumn &column, m_columns) {
+        if (column.elements() == 1) {
+            stream << ',' << column.name();
+        } else {
+            for (quint32 element = 0; element < column.elements(); element++) {
+                stream << ',' << column.name() << '[' << element << ']';
+            }
+        }
+    }
+    stream << '\n';
+
+    for (int sample = 0; sample < count(); sample++) {
+        stream << m_timeStamps.at(sample) << ',' << m_instIds.at(sample);
+        foreach(const OplColumn &column, m_columns) {
+            for (quint32 element = 0; element < column.elements(); element++) {
+                stream << ',' << column.value(sample, element);
+            }
+        }
+        stream << '\n';
+    }
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+OplDecoder::OplDecoder(const QList<OplObjectInfo> &objects) :
+    m_data(0), m_frames(0), m_skippedFrames(0)
+{
+    foreach(const OplObjectInfo &object, objects) {
+        m_objects.insert(object.objId, object);
+    }
+}
+
+const OplObjectColumns *OplDecoder::object(quint32 objId) const
+{
+    QHash<quint32, OplObjectColumns>::const_iterator it = m_columns.constFind(objId);
+
+    return (it != m_columns.constEnd()) ? &it.value() : 0;
+}
+
+/**
+ * Decode a log file, replacing the results of a previous call.
+ * \param threads number of decoding threads, 0 for one per core
+ */
+bool OplDecoder::decode(const QString &fileName, int threads)
+{
+    m_columns.clear();
+    m_records.clear();
+    m_frames = 0;
+    m_skippedFrames = 0;
+    m_errorString.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    QByteArray contents;
+    uchar *mapped     = file.map(0, size);
+    if (mapped) {
+        m_data = mapped;
+    } else {
+        // Not every file system can map files, fall back to reading it
+        contents = file.readAll();
+        m_data   = (const quint8 *)contents.constData();
+    }
+
+    // Find the records, only their headers are touched
+    qint64 offset = 0;
+    while (offset + RECORD_HEADER_SIZE <= size) {
+        qint64 dataSize = qFromLittleEndian<qint64>(m_data + offset + sizeof(quint32));
+        if (dataSize < 1 || dataSize > MAX_RECORD_SIZE || offset + RECORD_HEADER_SIZE + dataSize > size) {
+            qDebug() << "OplDecoder - log truncated or corrupted at offset" << offset;
+            break;
+        }
+        m_records << offset;
+        offset += RECORD_HEADER_SIZE + dataSize;
+    }
+    m_frames = m_records.size();
+
+    if (threads <= 0) {
+        threads = QThread::idealThreadCount();
+    }
+    threads = qBound(1, m_frames / MIN_CHUNK_RECORDS, qMax(threads, 1));
+
+    QVector<Chunk> chunks(threads);
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int i = 0; i < threads; i++) {
+        chunks[i].first   = (qint64)m_frames * i / threads;
+        chunks[i].last    = (qint64)m_frames * (i + 1) / threads;
+        chunks[i].skipped = 0;
+        pool.start(new OplChunkTask(this, &chunks[i]));
+    }
+    pool.waitForDone();
+
+    // Chunks are consecutive, appending them keeps the log order
+    for (int i = 0; i < threads; i++) {
+        m_skippedFrames += chunks[i].skipped;
+        QHash<quint32, OplObjectColumns>::const_iterator it;
+        for (it = chunks[i].columns.constBegin(); it != chunks[i].columns.constEnd(); ++it) {
+            QHash<quint32, OplObjectColumns>::iterator merged = m_columns.find(it.key());
+            if (merged == m_columns.end()) {
+                m_columns.insert(it.key(), it.value());
+            } else {
+                merged.value().append(it.value());
+            }
+        }
+    }
+
+    m_records.clear();
+    m_data = 0;
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    return true;
+}
+
+void OplDecoder::decodeChunk(Chunk *chunk) const
+{
+    for (int i = chunk->first; i < chunk->last; i++) {
+        const quint8 *record = m_data + m_records.at(i);
+        quint32 timeStamp    = qFromLittleEndian<quint32>(record);
+        qint64 size = qFromLittleEndian<qint64>(record + sizeof(quint32));
+        const quint8 *frame  = record + RECORD_HEADER_SIZE;
+
+        if (size < HEADER_LENGTH + CHECKSUM_LENGTH || frame[0] != SYNC_VAL ||
+            (frame[1] & TYPE_MASK) != TYPE_VER || (frame[1] != TYPE_OBJ && frame[1] != TYPE_OBJ_ACK)) {
+            chunk->skipped++;
+            continue;
+        }
+
+        quint16 length = qFromLittleEndian<quint16>(frame + 2);
+        quint32 objId  = qFromLittleEndian<quint32>(frame + 4);
+        quint16 instId = qFromLittleEndian<quint16>(frame + 8);
+
+        QHash<quint32, OplObjectInfo>::const_iterator info = m_objects.constFind(objId);
+        if (info == m_objects.constEnd() || length + CHECKSUM_LENGTH > size ||
+            length != HEADER_LENGTH + info->numBytes ||
+            Utils::Crc::updateCRC(0, frame, length) != frame[length]) {
+            chunk->skipped++;
+            continue;
+        }
+
+        QHash<quint32, OplObjectColumns>::iterator columns = chunk->columns.find(objId);
+        if (columns == chunk->columns.end()) {
+            columns = chunk->columns.insert(objId, OplObjectColumns(info.value()));
+        }
+        columns.value().append(timeStamp, instId, frame + HEADER_LENGTH, info.value());
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
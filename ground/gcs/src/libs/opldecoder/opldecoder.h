@@ -0,0 +1,208 @@
+/**
+ ******************************************************************************
+ *
+ * @file       opldecoder.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSLibraries GCS Libraries
+ * @{
+ * @addtogroup OplDecoder
+ * @{
+ * @brief Batch decoder of GCS .opl logs into per field columns
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OPLDECODER_H
+#define OPLDECODER_H
+
+#include "opldecoder_global.h"
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QIODevice>
+
+/**
+ * Layout of an object as found in the generated UAVObject classes. The
+ * decoder does not depend on the object manager, callers describe the
+ * objects they are interested in.
+ */
+struct OPLDECODER_EXPORT OplFieldInfo {
+    // Same order as UAVObjectField::FieldType
+    typedef enum { INT8 = 0, INT16, INT32, UINT8, UINT16, UINT32, FLOAT32, ENUM, BITFIELD, STRING } FieldType;
+
+    QString   name;
+    FieldType type;
+    quint32   elements;
+    quint32   offset;
+
+    static int typeSize(FieldType type);
+};
+
+struct OPLDECODER_EXPORT OplObjectInfo {
+    quint32 objId;
+    QString name;
+    quint32 numBytes;
+    QList<OplFieldInfo> fields;
+};
+
+/**
+ * All samples of one field, stored as packed little endian values of the
+ * field type, elements of a sample next to each other.
+ */
+class OPLDECODER_EXPORT OplColumn {
+public:
+    OplColumn() : m_type(OplFieldInfo::UINT8), m_elements(1) {}
+    OplColumn(const OplFieldInfo &field) : m_name(field.name), m_type(field.type), m_elements(field.elements) {}
+
+    QString name() const
+    {
+        return m_name;
+    }
+    OplFieldInfo::FieldType type() const
+    {
+        return m_type;
+    }
+    quint32 elements() const
+    {
+        return m_elements;
+    }
+    int count() const
+    {
+        return m_data.size() / (OplFieldInfo::typeSize(m_type) * m_elements);
+    }
+
+    // Raw access, T must match type()
+    template<typename T>
+    const T *values() const
+    {
+        return reinterpret_cast<const T *>(m_data.constData());
+    }
+
+    double value(int sample, quint32 element = 0) const;
+
+    QByteArray & data()
+    {
+        return m_data;
+    }
+    const QByteArray &data() const
+    {
+        return m_data;
+    }
+
+private:
+    QString m_name;
+    OplFieldInfo::FieldType m_type;
+    quint32 m_elements;
+    QByteArray m_data;
+};
+
+/**
+ * Every update of one object found in a log, one column per field.
+ */
+class OPLDECODER_EXPORT OplObjectColumns {
+public:
+    OplObjectColumns() : m_objId(0) {}
+    OplObjectColumns(const OplObjectInfo &info);
+
+    quint32 objId() const
+    {
+        return m_objId;
+    }
+    QString name() const
+    {
+        return m_name;
+    }
+    int count() const
+    {
+        return m_timeStamps.size();
+    }
+    const QVector<quint32> &timeStamps() const
+    {
+        return m_timeStamps;
+    }
+    const QVector<quint16> &instIds() const
+    {
+        return m_instIds;
+    }
+    const QVector<OplColumn> &columns() const
+    {
+        return m_columns;
+    }
+
+    void append(quint32 timeStamp, quint16 instId, const quint8 *data, const OplObjectInfo &info);
+    void append(const OplObjectColumns &other);
+
+    bool writeCSV(QIODevice *device) const;
+
+private:
+    quint32 m_objId;
+    QString m_name;
+    QVector<quint32> m_timeStamps;
+    QVector<quint16> m_instIds;
+    QVector<OplColumn> m_columns;
+};
+
+/**
+ * Decodes a whole .opl file at once. The file is memory mapped, the record
+ * boundaries are found in a single pass over the record headers and the
+ * UAVTalk frames are then decoded in parallel, one contiguous chunk of
+ * records per thread, and merged in log order.
+ */
+class OPLDECODER_EXPORT OplDecoder {
+public:
+    OplDecoder(const QList<OplObjectInfo> &objects);
+
+    bool decode(const QString &fileName, int threads = 0);
+
+    QList<quint32> objectIds() const
+    {
+        return m_columns.keys();
+    }
+    const OplObjectColumns *object(quint32 objId) const;
+
+    int frames() const
+    {
+        return m_frames;
+    }
+    // Frames that were corrupted, of an unknown object or not object updates
+    int skippedFrames() const
+    {
+        return m_skippedFrames;
+    }
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+private:
+    friend class OplChunkTask;
+    struct Chunk;
+
+    void decodeChunk(Chunk *chunk) const;
+
+    QHash<quint32, OplObjectInfo> m_objects;
+    QHash<quint32, OplObjectColumns> m_columns;
+    const quint8 *m_data;
+    QVector<qint64> m_records;
+    int m_frames;
+    int m_skippedFrames;
+    QString m_errorString;
+};
+
+#endif // OPLDECODER_H
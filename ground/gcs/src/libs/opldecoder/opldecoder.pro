@@ -0,0 +1,12 @@
+TEMPLATE = lib
+TARGET = OplDecoder
+
+include(../../library.pri)
+include(../utils/utils.pri)
+
+DEFINES += OPLDECODER_LIBRARY
+
+HEADERS = opldecoder_global.h \
+    opldecoder.h
+
+SOURCES = opldecoder.cpp
@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ *
+ * @file       opldecoder_global.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSLibraries GCS Libraries
+ * @{
+ * @addtogroup OplDecoder
+ * @{
+ * @brief Batch decoder of GCS .opl logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OPLDECODER_GLOBAL_H
+#define OPLDECODER_GLOBAL_H
+
+#include <QtCore/qglobal.h>
+
+#if defined(OPLDECODER_LIBRARY)
+#  define OPLDECODER_EXPORT Q_DECL_EXPORT
+#else
+#  define OPLDECODER_EXPORT Q_DECL_IMPORT
+#endif
+
+#endif // OPLDECODER_GLOBAL_H
@@ -29,7 +29,9 @@
 
 namespace core {
 MemoryCache::MemoryCache()
-{}
+{
+    decodedTiles.setMaxCost(64 * 1048576);
+}
 
 
 QByteArray MemoryCache::GetTileFromMemoryCache(const RawTile &tile)
@@ -54,4 +56,34 @@ void MemoryCache::AddTileToMemoryCache(const RawTile &tile, const QByteArray &pi
 
     kiberCacheLock.unlock();
 }
+
+QImage MemoryCache::GetDecodedTileFromMemoryCache(const RawTile &tile)
+{
+    // QCache::object() moves the tile to the front of the LRU list
+    QMutexLocker locker(&decodedTilesLock);
+    QImage *image = decodedTiles.object(tile);
+
+    return image ? *image : QImage();
+}
+void MemoryCache::AddDecodedTileToMemoryCache(const RawTile &tile, const QImage &image)
+{
+    QMutexLocker locker(&decodedTilesLock);
+
+    decodedTiles.insert(tile, new QImage(image), image.byteCount());
+#ifdef DEBUG_MEMORY_CACHE
+    qDebug() << "Decoded memory=" << decodedTiles.totalCost() << " in " << decodedTiles.count() << " tiles";
+#endif
+}
+void MemoryCache::setDecodedCacheCapacity(const int &megabytes)
+{
+    QMutexLocker locker(&decodedTilesLock);
+
+    decodedTiles.setMaxCost(megabytes * 1048576);
+}
+int MemoryCache::DecodedCacheCapacity()
+{
+    QMutexLocker locker(&decodedTilesLock);
+
+    return decodedTiles.maxCost() / 1048576;
+}
 }
@@ -31,6 +31,8 @@
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QQueue>
+#include <QCache>
+#include <QImage>
 #include "kibertilecache.h"
 #include <QDebug>
 #include "debugheader.h"
@@ -42,7 +44,15 @@ public:
     KiberTileCache TilesInMemory;
     QByteArray GetTileFromMemoryCache(const RawTile &tile);
     void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
+    QImage GetDecodedTileFromMemoryCache(const RawTile &tile);
+    void AddDecodedTileToMemoryCache(const RawTile &tile, const QImage &image);
+    void setDecodedCacheCapacity(const int &megabytes);
+    int DecodedCacheCapacity();
     QReadWriteLock kiberCacheLock;
+private:
+    // decoded tiles, the least recently used are dropped first, the cost is the image size in bytes
+    QCache<RawTile, QImage> decodedTiles;
+    QMutex decodedTilesLock;
 };
 }
 #endif // MEMORYCACHE_H
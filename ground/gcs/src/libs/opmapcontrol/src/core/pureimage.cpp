@@ -35,6 +35,19 @@ QPixmap PureImageProxy::FromStream(const QByteArray &array)
 {
     return QPixmap::fromImage(QImage::fromData(array));
 }
+/**
+ * Decode a tile into an image that can be drawn without conversion,
+ * unlike QPixmap this is safe to call from the tile loader threads.
+ */
+QImage PureImageProxy::Decode(const QByteArray &array)
+{
+    QImage image = QImage::fromData(array);
+
+    if (image.isNull() || image.format() == QImage::Format_ARGB32_Premultiplied) {
+        return image;
+    }
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
 bool PureImageProxy::Save(const QByteArray &array, QPixmap &pic)
 {
     pic = QPixmap::fromImage(QImage::fromData(array));
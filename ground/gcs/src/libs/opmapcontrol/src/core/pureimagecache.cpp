@@ -53,6 +53,7 @@ void PureImageCache::setGtileCache(const QString &value)
 #endif // DEBUG_PUREIMAGECACHE
             CreateEmptyDB(db);
         }
+        PrepareDB(db);
     }
     lock.unlock();
 }
@@ -150,6 +151,14 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     if (query.numRowsAffected() == -1) {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        db.close();
+        return false;
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+    if (query.numRowsAffected() == -1) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
 #endif // DEBUG_PUREIMAGECACHE
         db.close();
         return false;
@@ -158,87 +167,167 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
     return true;
 }
+
+/**
+ * Upgrade a cache database for concurrent use: the write ahead log lets the
+ * tile loaders read while the cache queue writes, the index avoids a
+ * full table scan for each tile lookup in databases created before it existed.
+ */
+void PureImageCache::PrepareDB(const QString &file)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", QLatin1String("PrepareConn"));
+        db.setDatabaseName(file);
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.exec("PRAGMA journal_mode=WAL");
+            query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug() << "PrepareDB: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(QLatin1String("PrepareConn"));
+}
+
+PureImageCache::CacheConnection::CacheConnection(const QString &name, const QString &file) : name(name), file(file)
+{}
+
+PureImageCache::CacheConnection::~CacheConnection()
+{
+    // release the queries before the connection can be removed
+    selectTile     = QSqlQuery();
+    insertTile     = QSqlQuery();
+    insertTileData = QSqlQuery();
+    {
+        QSqlDatabase cn = QSqlDatabase::database(name, false);
+        cn.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+bool PureImageCache::CacheConnection::open()
+{
+    QSqlDatabase cn = QSqlDatabase::addDatabase("QSQLITE", name);
+
+    cn.setDatabaseName(file);
+    if (!cn.open()) {
+        return false;
+    }
+    {
+        QSqlQuery query(cn);
+        query.exec("PRAGMA synchronous=NORMAL");
+    }
+    selectTile = QSqlQuery(cn);
+    selectTile.prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?)");
+    insertTile = QSqlQuery(cn);
+    insertTile.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
+    insertTileData = QSqlQuery(cn);
+    insertTileData.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+    return true;
+}
+
+/**
+ * Returns the connection of the calling thread to the current cache database,
+ * opening it on first use. The connection is closed when the thread exits.
+ * Must be called with the lock held.
+ */
+PureImageCache::CacheConnection *PureImageCache::Connection()
+{
+    QString db = gtilecache + "Data.qmdb";
+    CacheConnection *cn = connections.localData();
+
+    if (cn && (cn->file != db)) {
+        // the cache location changed, deletes the previous connection
+        connections.setLocalData(0);
+        cn = 0;
+    }
+    if (!cn) {
+        Mcounter.lock();
+        qlonglong id = ++ConnCounter;
+        Mcounter.unlock();
+        cn = new CacheConnection(QString::number(id), db);
+        if (!cn->open()) {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug() << "Connection: Unable to open database" << db;
+#endif // DEBUG_PUREIMAGECACHE
+            delete cn;
+            return 0;
+        }
+        connections.setLocalData(cn);
+    }
+    return cn;
+}
+bool PureImageCache::PutImage(CacheConnection *cn, const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    cn->insertTile.addBindValue(pos.X());
+    cn->insertTile.addBindValue(pos.Y());
+    cn->insertTile.addBindValue(zoom);
+    cn->insertTile.addBindValue((int)type);
+    cn->insertTile.addBindValue(QDateTime::currentDateTime().toString());
+    if (!cn->insertTile.exec()) {
+        return false;
+    }
+    cn->insertTileData.addBindValue(tile);
+    return cn->insertTileData.exec();
+}
 bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    QList<CacheItemQueue *> tiles;
+    CacheItemQueue item(type, pos, tile, zoom);
+
+    tiles.append(&item);
+    return PutImagesToCache(tiles);
+}
+/**
+ * Store several tiles in a single transaction, one commit is much cheaper
+ * than one per tile.
+ */
+bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue *> &tiles)
 {
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return false;
     }
     lock.lockForRead();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "PutImageToCache Start:"; // <<pos;
+    qDebug() << "PutImagesToCache Start:" << tiles.count();
 #endif // DEBUG_PUREIMAGECACHE
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
-    {
-        QSqlDatabase cn;
-        cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-        QString db = gtilecache + "Data.qmdb";
-        cn.setDatabaseName(db);
-        cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (cn.open()) {
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                query.addBindValue(pos.X());
-                query.addBindValue(pos.Y());
-                query.addBindValue(zoom);
-
-                query.addBindValue((int)type);
-                query.addBindValue(QDateTime::currentDateTime().toString());
-                query.exec();
-            }
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                query.addBindValue(tile);
-                query.exec();
-            }
-            cn.close();
+    CacheConnection *cn = Connection();
+    if (cn) {
+        QSqlDatabase db = QSqlDatabase::database(cn->name, false);
+        db.transaction();
+        foreach(CacheItemQueue * item, tiles) {
+            PutImage(cn, item->GetImg(), item->GetMapType(), item->GetPosition(), item->GetZoom());
         }
+        db.commit();
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
     lock.unlock();
     return true;
 }
 QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
 {
-    lock.lockForRead();
     QByteArray ar;
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return ar;
     }
-    QString dir  = gtilecache;
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
+    lock.lockForRead();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "Cache dir=" << dir << " Try to GET:" << pos.X() + "," + pos.Y();
+    qDebug() << "Cache dir=" << gtilecache << " Try to GET:" << pos.X() + "," + pos.Y();
 #endif // DEBUG_PUREIMAGECACHE
 
-    {
-        QString db = dir + "Data.qmdb";
-        {
-            QSqlDatabase cn;
-
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int)type));
-                    query.next();
-                    if (query.isValid()) {
-                        ar = query.value(0).toByteArray();
-                    }
-                }
-                cn.close();
-            }
+    CacheConnection *cn = Connection();
+    if (cn) {
+        cn->selectTile.addBindValue(pos.X());
+        cn->selectTile.addBindValue(pos.Y());
+        cn->selectTile.addBindValue(zoom);
+        cn->selectTile.addBindValue((int)type);
+        if (cn->selectTile.exec() && cn->selectTile.next()) {
+            ar = cn->selectTile.value(0).toByteArray();
         }
+        cn->selectTile.finish();
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
     lock.unlock();
     return ar;
 }
@@ -248,38 +337,28 @@ void PureImageCache::deleteOlderTiles(int const & days)
         return;
     }
     QList<long> add;
-    bool ret    = true;
-    QString dir = gtilecache;
-    {
-        QString db = dir + "Data.qmdb";
-        ret = QFileInfo(db).exists();
-        if (ret) {
-            QSqlDatabase cn;
-            Mcounter.lock();
-            qlonglong id = ++ConnCounter;
-            Mcounter.unlock();
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                    while (query.next()) {
-                        if (QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime()) > days) {
-                            add.append(query.value(0).toLongLong());
-                        }
-                    }
-                    foreach(long i, add) {
-                        query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                    }
+    lock.lockForRead();
+    CacheConnection *cn = Connection();
+    if (cn) {
+        QSqlDatabase db = QSqlDatabase::database(cn->name, false);
+        {
+            QSqlQuery query(db);
+            query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
+            while (query.next()) {
+                if (QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime()) > days) {
+                    add.append(query.value(0).toLongLong());
                 }
-
-                cn.close();
             }
-            QSqlDatabase::removeDatabase(QString::number(id));
+            db.transaction();
+            query.prepare("DELETE FROM Tiles WHERE id = ?");
+            foreach(long i, add) {
+                query.addBindValue((qlonglong)i);
+                query.exec();
+            }
+            db.commit();
         }
     }
+    lock.unlock();
 }
 // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
 bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
@@ -42,18 +42,37 @@
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
+#include "cacheitemqueue.h"
 namespace core {
 class PureImageCache {
 public:
     PureImageCache();
     static bool CreateEmptyDB(const QString &file);
     bool PutImageToCache(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+    bool PutImagesToCache(const QList<CacheItemQueue *> &tiles);
     QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
     QString GtileCache();
     void setGtileCache(const QString &value);
     static bool ExportMapDataToDB(QString sourceFile, QString destFile);
     void deleteOlderTiles(int const & days);
 private:
+    // Connection to the cache database kept open for the lifetime of a thread
+    struct CacheConnection {
+        CacheConnection(const QString &name, const QString &file);
+        ~CacheConnection();
+        bool open();
+        QString name;
+        QString file;
+        QSqlQuery selectTile;
+        QSqlQuery insertTile;
+        QSqlQuery insertTileData;
+    };
+    CacheConnection *Connection();
+    static void PrepareDB(const QString &file);
+    bool PutImage(CacheConnection *cn, const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+
+    QThreadStorage<CacheConnection *> connections;
     QString gtilecache;
     QMutex Mcounter;
     QReadWriteLock lock;
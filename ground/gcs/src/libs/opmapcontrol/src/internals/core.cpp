@@ -25,6 +25,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "core.h"
+#include <math.h>
 
 #ifdef DEBUG_CORE
 qlonglong internals::Core::debugcounter = 0;
@@ -33,8 +34,15 @@ qlonglong internals::Core::debugcounter = 0;
 using namespace projections;
 
 namespace internals {
+// Prefetch the tiles the map will reach within this time, in seconds
+#define PREFETCH_TIME       30.0
+// Maximum number of tiles prefetched ahead of the visible area
+#define PREFETCH_MAX_TILES  8
+// Below this speed, in m/s, nothing is prefetched
+#define PREFETCH_MIN_SPEED  1.0
+
 Core::Core() : MouseWheelZooming(false), currentPosition(0, 0), currentPositionPixel(0, 0), LastLocationInBounds(-1, -1), sizeOfMapArea(0, 0)
-    , minOfTiles(0, 0), maxOfTiles(0, 0), zoom(0), isDragging(false), TooltipTextPadding(10, 10), loaderLimit(5), maxzoom(21), runningThreads(0), started(false)
+    , minOfTiles(0, 0), maxOfTiles(0, 0), zoom(0), isDragging(false), TooltipTextPadding(10, 10), loaderLimit(5), maxzoom(21), runningThreads(0), prefetchNorth(0), prefetchEast(0), started(false)
 {
     mousewheelzoomtype = MouseWheelZoomType::MousePositionAndCenter;
     SetProjection(new MercatorProjection());
@@ -83,9 +91,11 @@ void Core::run()
 
     if (task.HasValue()) {
         if (loaderLimit.tryAcquire(1, OPMaps::Instance()->Timeout)) {
-            MtileToload.lock();
-            --tilesToload;
-            MtileToload.unlock();
+            if (!task.Prefetch) {
+                MtileToload.lock();
+                --tilesToload;
+                MtileToload.unlock();
+            }
 #ifdef DEBUG_CORE
             qDebug() << "loadLimit semaphore aquired " << loaderLimit.available() << " ID=" << debug << " TASK=" << task.Pos.ToString() << " " << task.Zoom;
 #endif // DEBUG_CORE
@@ -94,7 +104,13 @@ void Core::run()
 #ifdef DEBUG_CORE
                 qDebug() << "task as value, begining get" << " ID=" << debug;;
 #endif // DEBUG_CORE
-                {
+                if (task.Prefetch) {
+                    // decode into the memory cache, the tile is drawn once it is visible
+                    QVector<MapType::Types> layers = OPMaps::Instance()->GetAllLayersOfType(GetMapType());
+                    foreach(MapType::Types tl, layers) {
+                        GetDecodedImage(tl, task.Pos, task.Zoom);
+                    }
+                } else {
                     Tile *m = Matrix.TileAt(task.Pos);
 
                     if (m == 0 || m->Overlays.count() == 0) {
@@ -109,22 +125,22 @@ void Core::run()
                             int retry = 0;
 
                             do {
-                                QByteArray img;
+                                QImage img;
 
 #ifdef DEBUG_CORE
                                 qDebug() << "start getting image" << " ID=" << debug;
 #endif // DEBUG_CORE
-                                img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                                img = GetDecodedImage(tl, task.Pos, task.Zoom);
 #ifdef DEBUG_CORE
-                                qDebug() << "Core::run:gotimage size:" << img.count() << " ID=" << debug << " time=" << t.elapsed();
+                                qDebug() << "Core::run:gotimage size:" << img.byteCount() << " ID=" << debug << " time=" << t.elapsed();
 #endif // DEBUG_CORE
 
-                                if (img.length() != 0) {
+                                if (!img.isNull()) {
                                     Moverlays.lock();
                                     {
                                         t->Overlays.append(img);
 #ifdef DEBUG_CORE
-                                        qDebug() << "Core::run append img:" << img.length() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
+                                        qDebug() << "Core::run append img:" << img.byteCount() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
 #endif // DEBUG_CORE
                                     }
                                     Moverlays.unlock();
@@ -197,6 +213,31 @@ void Core::run()
     --runningThreads;
     MrunningThreads.unlock();
 }
+/**
+ * Returns a tile layer ready to be drawn, decoding it on the calling loader
+ * thread unless it is still in the decoded tiles memory cache.
+ */
+QImage Core::GetDecodedImage(MapType::Types const & type, core::Point const & pos, int const & zoom)
+{
+    OPMaps *maps = OPMaps::Instance();
+    RawTile tile(type, pos, zoom);
+    QImage image;
+
+    if (maps->UseMemoryCache()) {
+        image = maps->GetDecodedTileFromMemoryCache(tile);
+        if (!image.isNull()) {
+            return image;
+        }
+    }
+    QByteArray data = maps->GetImageFrom(type, pos, zoom);
+    if (!data.isEmpty()) {
+        image = PureImageProxy::Decode(data);
+        if (!image.isNull() && maps->UseMemoryCache()) {
+            maps->AddDecodedTileToMemoryCache(tile, image);
+        }
+    }
+    return image;
+}
 diagnostics Core::GetDiagnostics()
 {
     MrunningThreads.lock();
@@ -555,6 +596,19 @@ void Core::UpdateBounds()
                 MtileLoadQueue.unlock();
             }
         }
+
+        // queued after the visible tiles so that they are loaded first
+        QList<Point> tilesAhead;
+        FindTilesAhead(tilesAhead);
+        foreach(Point p, tilesAhead) {
+            LoadTask task = LoadTask(p, Zoom(), true);
+            MtileLoadQueue.lock();
+            if (!tileLoadQueue.contains(task)) {
+                tileLoadQueue.enqueue(task);
+                ProcessLoadTaskCallback.start(this);
+            }
+            MtileLoadQueue.unlock();
+        }
     }
     MtileDrawingList.unlock();
     UpdateGroundResolution();
@@ -586,6 +640,51 @@ void Core::FindTilesAround(QList<Point> &list)
         }
     }
 }
+/**
+ * Finds the tiles just outside of the visible area along the prefetch velocity,
+ * as far as the map moves within PREFETCH_TIME. The tiles on both sides of the
+ * path are included to cover the rounding to whole tiles.
+ */
+void Core::FindTilesAhead(QList<Point> &list)
+{
+    list.clear();
+    double speed = sqrt(prefetchNorth * prefetchNorth + prefetchEast * prefetchEast);
+    if (speed < PREFETCH_MIN_SPEED) {
+        return;
+    }
+    double tileMeters = Projection()->TileSize().Width() * Projection()->GetGroundResolution(Zoom(), CurrentPosition().Lat());
+    if (tileMeters <= 0) {
+        return;
+    }
+    int count = qMin(PREFETCH_MAX_TILES, (int)ceil(speed * PREFETCH_TIME / tileMeters));
+
+    // tile rows grow southwards
+    double dx = prefetchEast / speed;
+    double dy = -prefetchNorth / speed;
+
+    // distance from the center tile to the edge of the visible area along the path
+    double edge = 1e9;
+    if (fabs(dx) > 1e-3) {
+        edge = qMin(edge, sizeOfMapArea.Width() / fabs(dx));
+    }
+    if (fabs(dy) > 1e-3) {
+        edge = qMin(edge, sizeOfMapArea.Height() / fabs(dy));
+    }
+    Point side(qRound(-dy), qRound(dx));
+
+    for (int k = 1; k <= count; k++) {
+        Point ahead(centerTileXYLocation.X() + qRound((edge + k) * dx), centerTileXYLocation.Y() + qRound((edge + k) * dy));
+        Point candidates[] = { ahead, Point(ahead.X() + side.X(), ahead.Y() + side.Y()), Point(ahead.X() - side.X(), ahead.Y() - side.Y()) };
+        for (int i = 0; i < 3; i++) {
+            Point p = candidates[i];
+            if (p.X() >= minOfTiles.Width() && p.Y() >= minOfTiles.Height() && p.X() <= maxOfTiles.Width() && p.Y() <= maxOfTiles.Height()) {
+                if (!tileDrawingList.contains(p) && !list.contains(p)) {
+                    list.append(p);
+                }
+            }
+        }
+    }
+}
 void Core::UpdateGroundResolution()
 {
     double rez = Projection()->GetGroundResolution(Zoom(), CurrentPosition().Lat());
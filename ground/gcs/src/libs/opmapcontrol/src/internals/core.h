@@ -47,6 +47,7 @@
 #include "../internals/projections/platecarreeprojection.h"
 #include "../core/geodecoderstatus.h"
 #include "../core/opmaps.h"
+#include "../core/pureimage.h"
 #include "../core/diagnostics.h"
 
 #include <QSemaphore>
@@ -292,6 +293,20 @@ public:
 
     void FindTilesAround(QList<core::Point> &list);
 
+    void FindTilesAhead(QList<core::Point> &list);
+
+    /**
+     * @brief Sets the velocity used to prefetch the tiles the map is moving to
+     *
+     * @param north velocity towards north in m/s
+     * @param east velocity towards east in m/s
+     */
+    void SetPrefetchVelocity(double const & north, double const & east)
+    {
+        prefetchNorth = north;
+        prefetchEast  = east;
+    }
+
     void UpdateGroundResolution();
 
     TileMatrix Matrix;
@@ -371,6 +386,11 @@ private:
     int maxzoom;
     QMutex MrunningThreads;
     int runningThreads;
+
+    double prefetchNorth;
+    double prefetchEast;
+
+    QImage GetDecodedImage(MapType::Types const & type, core::Point const & pos, int const & zoom);
     diagnostics diag;
 
 protected:
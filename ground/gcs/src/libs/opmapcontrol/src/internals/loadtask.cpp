@@ -30,6 +30,6 @@
 namespace internals {
 bool operator==(LoadTask const & lhs, LoadTask const & rhs)
 {
-    return (lhs.Pos == rhs.Pos) && (lhs.Zoom == rhs.Zoom);
+    return (lhs.Pos == rhs.Pos) && (lhs.Zoom == rhs.Zoom) && (lhs.Prefetch == rhs.Prefetch);
 }
 }
@@ -37,17 +37,21 @@ struct LoadTask {
 public:
     core::Point Pos;
     int Zoom;
+    // only fill the memory cache, the tile is not visible yet
+    bool Prefetch;
 
 
-    LoadTask(Point pos, int zoom)
+    LoadTask(Point pos, int zoom, bool prefetch = false)
     {
         Pos  = pos;
         Zoom = zoom;
+        Prefetch = prefetch;
     }
     LoadTask()
     {
         Pos  = core::Point(-1, -1);
         Zoom = -1;
+        Prefetch = false;
     }
     bool HasValue()
     {
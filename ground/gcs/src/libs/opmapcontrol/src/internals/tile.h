@@ -66,7 +66,8 @@ public:
     {
         return !(zoom == 0);
     }
-    QList<QByteArray> Overlays;
+    // decoded layers, ready to be drawn
+    QList<QImage> Overlays;
 protected:
 
     QMutex mutex;
@@ -105,6 +105,16 @@ public:
     double ZoomDigi();
     double ZoomTotal();
     void setOverlayOpacity(qreal value);
+    /**
+     * @brief Velocity of the tracked UAV, used to prefetch tiles ahead of it
+     *
+     * @param north velocity north in m/s
+     * @param east velocity east in m/s
+     */
+    void SetPrefetchVelocity(double const & north, double const & east)
+    {
+        core->SetPrefetchVelocity(north, east);
+    }
 protected:
     void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
     void mousePressEvent(QGraphicsSceneMouseEvent *event);
@@ -238,6 +238,12 @@ void UAVItem::SetGroundspeed(double vNED[3], int m_maxUpdateRate_ms)
     precalcRings     = groundspeed_mps_filt * ringTime * meters2pixels;
     boundingRectSize = groundspeed_mps_filt * ringTime * 4 * meters2pixels + 20;
     prepareGeometryChange();
+    // when the map follows the UAV, load the tiles it is flying towards in advance
+    if (mapfollowtype == UAVMapFollowType::CenterAndRotateMap || mapfollowtype == UAVMapFollowType::CenterMap) {
+        map->SetPrefetchVelocity(vNED[0], vNED[1]);
+    } else {
+        map->SetPrefetchVelocity(0, 0);
+    }
 }
 
 
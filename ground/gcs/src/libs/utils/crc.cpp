@@ -65,8 +65,40 @@ quint8 Crc::updateCRC(quint8 crc, const quint8 data)
     return crc_table[crc ^ data];
 }
 
+/*
+ * Slicing-by-8 tables: crc_slice_table[k][x] is the crc of byte x followed by
+ * k zero bytes. As the crc is linear, 8 bytes can then be processed with 8
+ * independent lookups instead of a chain of 8 dependent ones.
+ */
+static quint8 crc_slice_table[8][256];
+
+static bool init_slice_table()
+{
+    for (int x = 0; x < 256; x++) {
+        crc_slice_table[0][x] = crc_table[x];
+    }
+    for (int k = 1; k < 8; k++) {
+        for (int x = 0; x < 256; x++) {
+            crc_slice_table[k][x] = crc_table[crc_slice_table[k - 1][x]];
+        }
+    }
+    return true;
+}
+
+static const bool crc_slice_table_ready = init_slice_table();
+
 quint8 Crc::updateCRC(quint8 crc, const quint8 *data, qint32 length)
 {
+    Q_UNUSED(crc_slice_table_ready);
+
+    while (length >= 8) {
+        crc = crc_slice_table[7][crc ^ data[0]] ^ crc_slice_table[6][data[1]] ^
+              crc_slice_table[5][data[2]] ^ crc_slice_table[4][data[3]] ^
+              crc_slice_table[3][data[4]] ^ crc_slice_table[2][data[5]] ^
+              crc_slice_table[1][data[6]] ^ crc_slice_table[0][data[7]];
+        data   += 8;
+        length -= 8;
+    }
     while (length--) {
         crc = crc_table[crc ^ *data++];
     }
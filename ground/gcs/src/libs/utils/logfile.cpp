@@ -1,6 +1,47 @@
 #include "logfile.h"
 #include <QDebug>
 #include <QtGlobal>
+#include <QThread>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QDateTime>
+
+#include <algorithm>
+
+// Offset of the data from the start of a record: timestamp and data size
+#define RECORD_HEADER_SIZE (sizeof(quint32) + sizeof(qint64))
+#define MAX_RECORD_SIZE    (1024 * 1024)
+#define INDEX_FILE_MAGIC   0x4F504C49 // "OPLI"
+#define INDEX_FILE_VERSION 1
+
+/**
+ * Builds the replay index of a log file away from the GUI thread.
+ * The duration is only read back once finished() has been emitted.
+ */
+class LogFileIndexer : public QThread {
+public:
+    LogFileIndexer(LogFile *logFile) : QThread(logFile), m_logFile(logFile), m_complete(false), m_duration(0) {}
+
+    bool complete() const
+    {
+        return m_complete;
+    }
+    quint32 duration() const
+    {
+        return m_duration;
+    }
+
+protected:
+    void run()
+    {
+        m_complete = m_logFile->buildIndex(m_duration);
+    }
+
+private:
+    LogFile *m_logFile;
+    bool m_complete;
+    quint32 m_duration;
+};
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
@@ -9,11 +50,19 @@ LogFile::LogFile(QObject *parent) :
     m_timeOffset(0),
     m_playbackSpeed(1.0),
     m_nextTimeStamp(0),
-    m_useProvidedTimeStamp(false)
+    m_useProvidedTimeStamp(false),
+    m_indexer(0),
+    m_indexCaching(false),
+    m_replayDuration(0)
 {
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(timerFired()));
 }
 
+LogFile::~LogFile()
+{
+    stopIndexing();
+}
+
 /**
  * Opens the logfile QIODevice and the underlying logfile. In case
  * we want to save the logfile, we open in WriteOnly. In case we
@@ -54,6 +103,7 @@ void LogFile::close()
     if (m_timer.isActive()) {
         m_timer.stop();
     }
+    stopIndexing();
     m_file.close();
     QIODevice::close();
 }
@@ -97,6 +147,8 @@ qint64 LogFile::bytesAvailable() const
 void LogFile::timerFired()
 {
     qint64 dataSize;
+    bool played   = false;
+    bool finished = false;
 
     if (m_file.bytesAvailable() > 4) {
         int time;
@@ -106,32 +158,31 @@ void LogFile::timerFired()
         while ((m_lastPlayed + ((time - m_timeOffset) * m_playbackSpeed) > m_lastTimeStamp)) {
             m_lastPlayed += ((time - m_timeOffset) * m_playbackSpeed);
             if (m_file.bytesAvailable() < (qint64)sizeof(dataSize)) {
-                stopReplay();
-                return;
+                finished = true;
+                break;
             }
 
             m_file.read((char *)&dataSize, sizeof(dataSize));
 
-            if (dataSize < 1 || dataSize > (1024 * 1024)) {
+            if (dataSize < 1 || dataSize > MAX_RECORD_SIZE) {
                 qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
+                finished = true;
+                break;
             }
 
             if (m_file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
+                finished = true;
+                break;
             }
 
             m_mutex.lock();
             m_dataBuffer.append(m_file.read(dataSize));
             m_mutex.unlock();
-
-            emit readyRead();
+            played = true;
 
             if (m_file.bytesAvailable() < (qint64)sizeof(m_lastTimeStamp)) {
-                stopReplay();
-                return;
+                finished = true;
+                break;
             }
 
             int save = m_lastTimeStamp;
@@ -140,14 +191,24 @@ void LogFile::timerFired()
             if (m_lastTimeStamp < save // logfile goes back in time
                 || (m_lastTimeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
                 qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << m_lastTimeStamp << " after " << save << "\n";
-                stopReplay();
-                return;
+                finished = true;
+                break;
             }
 
             m_timeOffset = time;
             time = m_myTime.elapsed();
         }
     } else {
+        finished = true;
+    }
+
+    // Hand everything due in this tick over at once, at high replay
+    // speeds this can be thousands of objects
+    if (played) {
+        emit readyRead();
+        emit replayPositionChanged(m_lastPlayed);
+    }
+    if (finished) {
         stopReplay();
     }
 }
@@ -161,6 +222,7 @@ bool LogFile::startReplay()
     m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
     m_timer.setInterval(10);
     m_timer.start();
+    startIndexing();
     emit replayStarted();
     return true;
 }
@@ -182,3 +244,215 @@ void LogFile::resumeReplay()
     m_timeOffset = m_myTime.elapsed();
     m_timer.start();
 }
+
+/**
+ * Continue the replay from the first object logged at or after timeStamp.
+ * Before the index covers timeStamp the file is skipped forward from the
+ * last indexed position.
+ */
+bool LogFile::seekReplay(quint32 timeStamp)
+{
+    qint64 offset = 0;
+
+    {
+        QMutexLocker locker(&m_indexMutex);
+        QVector<IndexEntry>::const_iterator it = std::upper_bound(m_index.constBegin(), m_index.constEnd(), timeStamp, indexEntryBefore);
+        if (it != m_index.constBegin()) {
+            offset = (it - 1)->offset;
+        }
+    }
+
+    if (!m_file.isOpen() || !m_file.seek(offset)) {
+        return false;
+    }
+
+    quint32 recordTime;
+    qint64 dataSize;
+    forever {
+        if (m_file.read((char *)&recordTime, sizeof(recordTime)) != sizeof(recordTime)) {
+            return false;
+        }
+        if (recordTime >= timeStamp) {
+            break;
+        }
+        if (m_file.read((char *)&dataSize, sizeof(dataSize)) != sizeof(dataSize) ||
+            dataSize < 1 || dataSize > MAX_RECORD_SIZE || !m_file.seek(m_file.pos() + dataSize)) {
+            return false;
+        }
+    }
+
+    m_mutex.lock();
+    m_dataBuffer.clear();
+    m_mutex.unlock();
+
+    m_lastTimeStamp = recordTime;
+    m_lastPlayed    = timeStamp;
+    m_timeOffset    = m_myTime.elapsed();
+    emit replayPositionChanged(m_lastPlayed);
+    return true;
+}
+
+bool LogFile::indexEntryBefore(quint32 timeStamp, const IndexEntry &entry)
+{
+    return timeStamp < entry.timeStamp;
+}
+
+void LogFile::startIndexing()
+{
+    stopIndexing();
+
+    m_indexMutex.lock();
+    m_index.clear();
+    m_indexMutex.unlock();
+    m_replayDuration = 0;
+
+    if (m_indexCaching && loadIndex()) {
+        emit indexReady(m_replayDuration);
+        return;
+    }
+
+    m_indexAbort.store(0);
+    m_indexer    = new LogFileIndexer(this);
+    connect(m_indexer, SIGNAL(finished()), this, SLOT(indexingFinished()));
+    m_indexer->start(QThread::LowPriority);
+}
+
+void LogFile::stopIndexing()
+{
+    if (m_indexer) {
+        m_indexAbort.store(1);
+        m_indexer->wait();
+        delete m_indexer;
+        m_indexer = 0;
+    }
+}
+
+/**
+ * Called on the thread of the log file once the indexer thread is done
+ */
+void LogFile::indexingFinished()
+{
+    // A queued notification can outlive its indexer, only take the current one
+    if (m_indexer && m_indexer->isFinished() && m_indexer->complete()) {
+        m_replayDuration = m_indexer->duration();
+        emit indexReady(m_replayDuration);
+    }
+}
+
+/**
+ * Runs in the indexer thread. Reads only the record headers, using a file
+ * handle of its own so the replay is not disturbed.
+ * Returns true and the log duration if the whole log was indexed.
+ */
+bool LogFile::buildIndex(quint32 &duration)
+{
+    QFile file(m_file.fileName());
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QVector<IndexEntry> pending;
+    qint64 offset = 0;
+    qint64 nextIndexTime = 0;
+    quint32 timeStamp    = 0;
+    quint32 lastTimeStamp = 0;
+    qint64 dataSize;
+    bool complete = false;
+
+    while (!m_indexAbort.load()) {
+        if (file.read((char *)&timeStamp, sizeof(timeStamp)) != sizeof(timeStamp)) {
+            complete = true;
+            break;
+        }
+        if (file.read((char *)&dataSize, sizeof(dataSize)) != sizeof(dataSize) ||
+            dataSize < 1 || dataSize > MAX_RECORD_SIZE ||
+            offset + (qint64)RECORD_HEADER_SIZE + dataSize > file.size()) {
+            // Truncated or corrupted, the replay stops there as well
+            complete = true;
+            break;
+        }
+        if (timeStamp >= nextIndexTime) {
+            IndexEntry entry = { timeStamp, offset };
+            pending << entry;
+            nextIndexTime = (qint64)timeStamp + INDEX_INTERVAL;
+        }
+        lastTimeStamp = timeStamp;
+        offset += RECORD_HEADER_SIZE + dataSize;
+        file.seek(offset);
+
+        // Publish in batches so seeks can use the index while it grows
+        if (pending.size() >= 256) {
+            QMutexLocker locker(&m_indexMutex);
+            m_index += pending;
+            pending.clear();
+        }
+    }
+
+    m_indexMutex.lock();
+    m_index += pending;
+    m_indexMutex.unlock();
+
+    if (complete) {
+        duration = lastTimeStamp;
+        if (m_indexCaching) {
+            saveIndex(duration);
+        }
+    }
+    return complete;
+}
+
+bool LogFile::loadIndex()
+{
+    QFile indexFile(indexFileName());
+
+    if (!indexFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QFileInfo logInfo(m_file);
+    QDataStream stream(&indexFile);
+    quint32 magic, version, duration, count;
+    qint64 logSize, logModified;
+
+    stream >> magic >> version >> logSize >> logModified >> duration >> count;
+    if (stream.status() != QDataStream::Ok || magic != INDEX_FILE_MAGIC || version != INDEX_FILE_VERSION ||
+        logSize != logInfo.size() || logModified != logInfo.lastModified().toMSecsSinceEpoch()) {
+        // Stale index, the log was changed since
+        return false;
+    }
+
+    QVector<IndexEntry> index(count);
+    for (quint32 i = 0; i < count; i++) {
+        stream >> index[i].timeStamp >> index[i].offset;
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_indexMutex);
+    m_index = index;
+    m_replayDuration = duration;
+    return true;
+}
+
+void LogFile::saveIndex(quint32 duration)
+{
+    QFile indexFile(indexFileName());
+
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Unable to write log index" << indexFile.fileName();
+        return;
+    }
+
+    QFileInfo logInfo(m_file);
+    QDataStream stream(&indexFile);
+    QMutexLocker locker(&m_indexMutex);
+
+    stream << (quint32)INDEX_FILE_MAGIC << (quint32)INDEX_FILE_VERSION
+           << (qint64)logInfo.size() << (qint64)logInfo.lastModified().toMSecsSinceEpoch()
+           << duration << (quint32)m_index.size();
+    foreach(const IndexEntry &entry, m_index) {
+        stream << entry.timeStamp << entry.offset;
+    }
+}
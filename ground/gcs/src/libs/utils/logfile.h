@@ -8,12 +8,17 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QFile>
+#include <QVector>
+#include <QAtomicInt>
 #include "utils_global.h"
 
+class LogFileIndexer;
+
 class QTCREATOR_UTILS_EXPORT LogFile : public QIODevice {
     Q_OBJECT
 public:
     explicit LogFile(QObject *parent = 0);
+    ~LogFile();
     qint64 bytesAvailable() const;
     qint64 bytesToWrite() const
     {
@@ -40,6 +45,23 @@ public:
         m_nextTimeStamp = nextTimestamp;
     }
 
+    // Keep the replay index in a file next to the log so it is only built once
+    void setIndexCaching(bool indexCaching)
+    {
+        m_indexCaching = indexCaching;
+    }
+
+    quint32 replayPosition() const
+    {
+        return m_lastPlayed;
+    }
+
+    // Zero until the index has been built
+    quint32 replayDuration() const
+    {
+        return m_replayDuration;
+    }
+
 public slots:
     void setReplaySpeed(double val)
     {
@@ -48,14 +70,20 @@ public slots:
     };
     void pauseReplay();
     void resumeReplay();
+    bool seekReplay(quint32 timeStamp);
 
 protected slots:
     void timerFired();
 
+private slots:
+    void indexingFinished();
+
 signals:
     void readReady();
     void replayStarted();
     void replayFinished();
+    void replayPositionChanged(quint32 timeStamp);
+    void indexReady(quint32 duration);
 
 protected:
     QByteArray m_dataBuffer;
@@ -71,8 +99,36 @@ protected:
     double m_playbackSpeed;
 
 private:
+    friend class LogFileIndexer;
+
+    struct IndexEntry {
+        quint32 timeStamp;
+        qint64  offset;
+    };
+
+    // One index entry per interval of log time, seeks skip forward from there
+    static const quint32 INDEX_INTERVAL = 100;
+
+    static bool indexEntryBefore(quint32 timeStamp, const IndexEntry &entry);
+    void startIndexing();
+    void stopIndexing();
+    bool buildIndex(quint32 &duration);
+    bool loadIndex();
+    void saveIndex(quint32 duration);
+    QString indexFileName() const
+    {
+        return m_file.fileName() + ".idx";
+    }
+
     quint32 m_nextTimeStamp;
     bool m_useProvidedTimeStamp;
+
+    LogFileIndexer *m_indexer;
+    QVector<IndexEntry> m_index;
+    QMutex m_indexMutex;
+    QAtomicInt m_indexAbort;
+    bool m_indexCaching;
+    quint32 m_replayDuration;
 };
 
 #endif // LOGFILE_H
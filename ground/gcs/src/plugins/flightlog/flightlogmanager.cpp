@@ -32,6 +32,8 @@
 #include <QFileDialog>
 #include <QXmlStreamReader>
 #include <QMessageBox>
+#include <QEventLoop>
+#include <QTimer>
 #include <QDebug>
 
 #include "debuglogcontrol.h"
@@ -42,7 +44,7 @@
 #include <uavobjectutil/uavobjectutilmanager.h>
 
 FlightLogManager::FlightLogManager(QObject *parent) :
-    QObject(parent), m_disableControls(false),
+    QObject(parent), m_streamFlight(-1), m_disableControls(false),
     m_disableExport(true), m_cancelDownload(false),
     m_adjustExportedTimestamps(true)
 {
@@ -186,83 +188,279 @@ void FlightLogManager::clearLogList()
     }
 }
 
+void FlightLogManager::addLogEntry(const DebugLogEntry::DataFields &data)
+{
+    if (data.Type == DebugLogEntry::TYPE_COMPRESSEDUAVOBJECTS) {
+        addCompressedLogEntries(data);
+        return;
+    }
+
+    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+
+    logEntry->setData(data, m_objectManager);
+    m_logEntries << logEntry;
+    if (data.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
+        const quint32 header_len = total_len - data_len;
+
+        DebugLogEntry::DataFields fields;
+        quint32 start = data.Size;
+
+        // cycle until there is space for another object
+        while (start + header_len + 1 < data_len) {
+            memset(&fields, 0xFF, total_len);
+            memcpy(&fields, &data.Data[start], header_len);
+            // check wether a packed object is found
+            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
+            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
+            quint32 toread = header_len + fields.Size;
+            if (!(toread + start > data_len)) {
+                memcpy(&fields, &data.Data[start], toread);
+                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
+                subEntry->setData(fields, m_objectManager);
+                m_logEntries << subEntry;
+            }
+            start += toread;
+        }
+    }
+}
+
+/**
+ * Unpack the records of a compressed entry. Each record selects a slot of the
+ * entry's object table, defining it on first use, followed by the time since
+ * the previous record and the object data XORed with the slot's previous
+ * update, coded as runs of unchanged bytes and literals.
+ */
+void FlightLogManager::addCompressedLogEntries(const DebugLogEntry::DataFields &data)
+{
+    struct Slot {
+        quint32    objId;
+        quint16    instId;
+        quint16    size;
+        bool       delta;
+        QByteArray reference;
+    };
+
+    QList<Slot> slots;
+    const quint32 end = qMin<quint32>(data.Size, sizeof(data.Data));
+    quint32 pos  = 0;
+    quint32 time = data.FlightTime;
+
+    while (pos < end) {
+        quint32 index = data.Data[pos++];
+        if (index == (quint32)slots.count()) {
+            if (pos + 6 > end) {
+                break;
+            }
+            Slot slot;
+            slot.objId  = data.Data[pos] | (data.Data[pos + 1] << 8) | (data.Data[pos + 2] << 16) | ((quint32)data.Data[pos + 3] << 24);
+            slot.instId = data.Data[pos + 4] | (data.Data[pos + 5] << 8);
+            pos += 6;
+            quint32 size;
+            if (!readVarint(data, end, pos, size) || (size >> 1) > sizeof(data.Data)) {
+                break;
+            }
+            slot.size  = size >> 1;
+            slot.delta = size & 1;
+            slot.reference.fill(0, slot.size);
+            slots << slot;
+        } else if (index > (quint32)slots.count()) {
+            qWarning() << "FlightLogManager - corrupt compressed entry" << data.Flight << data.Entry;
+            break;
+        }
+        Slot &slot = slots[index];
+
+        quint32 elapsed;
+        if (!readVarint(data, end, pos, elapsed)) {
+            break;
+        }
+        time += elapsed;
+
+        QByteArray object(slot.size, 0);
+        int i = 0;
+        while (i < slot.size && pos < end) {
+            quint8 token = data.Data[pos++];
+            int len = (token & 0x7F) + 1;
+            for (int j = 0; j < len && i < slot.size; j++, i++) {
+                quint8 value = 0;
+                if (!(token & 0x80) && pos < end) {
+                    value = data.Data[pos++];
+                }
+                object[i] = value ^ (slot.delta ? (quint8)slot.reference.at(i) : 0);
+            }
+        }
+        if (i < slot.size) {
+            break;
+        }
+        if (slot.delta) {
+            slot.reference = object;
+        }
+
+        if (!m_objectManager->getObject(slot.objId, slot.instId)) {
+            continue;
+        }
+        DebugLogEntry::DataFields fields;
+        memset(&fields, 0xFF, sizeof(fields));
+        fields.Flight     = data.Flight;
+        fields.FlightTime = time;
+        fields.Entry      = data.Entry;
+        fields.Type       = DebugLogEntry::TYPE_UAVOBJECT;
+        fields.ObjectID   = slot.objId;
+        fields.InstanceID = slot.instId;
+        fields.Size       = slot.size;
+        memcpy(fields.Data, object.constData(), slot.size);
+
+        ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+        logEntry->setData(fields, m_objectManager);
+        m_logEntries << logEntry;
+    }
+}
+
+bool FlightLogManager::readVarint(const DebugLogEntry::DataFields &data, quint32 end, quint32 &pos, quint32 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 32 && pos < end; shift += 7) {
+        quint8 byte = data.Data[pos++];
+        value |= (quint32)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FlightLogManager::sendStreamAck(int flight, int entry)
+{
+    UAVObjectUpdaterHelper updateHelper;
+
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_STREAM);
+    m_flightLogControl->setFlight(flight);
+    m_flightLogControl->setEntry(entry);
+    return updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS;
+}
+
+void FlightLogManager::streamEntryUpdated(UAVObject *obj)
+{
+    DebugLogEntry *logEntry = qobject_cast<DebugLogEntry *>(obj);
+
+    if (logEntry) {
+        DebugLogEntry::DataFields data = logEntry->getData();
+        if (data.Flight == m_streamFlight) {
+            m_streamEntries.insert(data.Entry, data);
+            emit streamEntryReceived();
+        }
+    }
+}
+
+void FlightLogManager::streamNewInstance(UAVObject *obj)
+{
+    if (obj->getObjID() == DebugLogEntry::OBJID) {
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(streamEntryUpdated(UAVObject *)), Qt::UniqueConnection);
+    }
+}
+
+/**
+ * Stream all entries of a flight. The flight side pushes a window of entries
+ * ahead of our cumulative ack; entries are collected by number, so out of
+ * order or duplicate ones are harmless. When nothing new arrives within the
+ * timeout the last ack is sent again, which makes the flight side resend the
+ * window starting at that ack, covering the first missing entry.
+ */
+bool FlightLogManager::streamFlightEntries(int flight)
+{
+    QEventLoop loop;
+    QTimer timer;
+
+    timer.setSingleShot(true);
+    connect(this, SIGNAL(streamEntryReceived()), &loop, SLOT(quit()));
+    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+    m_streamEntries.clear();
+    m_streamFlight = flight;
+
+    int acked    = 0;
+    int next     = 0;
+    int retries  = 0;
+    bool gotLast = false;
+    bool success = sendStreamAck(flight, acked);
+
+    while (success && !gotLast && !m_cancelDownload) {
+        // Advance over everything received without gaps
+        while (m_streamEntries.contains(next)) {
+            if (m_streamEntries[next].Type == DebugLogEntry::TYPE_EMPTY) {
+                gotLast = true;
+                break;
+            }
+            next++;
+        }
+        if (gotLast) {
+            break;
+        }
+        if (next - acked >= STREAM_WINDOW / 2) {
+            acked   = next;
+            retries = 0;
+            success = sendStreamAck(flight, acked);
+            continue;
+        }
+
+        timer.start(UAVTALK_TIMEOUT);
+        loop.exec();
+        if (!timer.isActive()) {
+            // Nothing arrived, ask for the gap to be resent. Only a repeated
+            // ack makes the flight side go back, a larger one is taken as progress
+            if (++retries > STREAM_RETRIES) {
+                success = false;
+            } else {
+                success = sendStreamAck(flight, acked);
+            }
+        }
+        timer.stop();
+    }
+
+    if (success && gotLast) {
+        foreach(const DebugLogEntry::DataFields &data, m_streamEntries) {
+            if (data.Type != DebugLogEntry::TYPE_EMPTY) {
+                addLogEntry(data);
+            }
+        }
+    }
+    m_streamEntries.clear();
+    m_streamFlight = -1;
+
+    return success && gotLast;
+}
+
 void FlightLogManager::retrieveLogs(int flightToRetrieve)
 {
     setDisableControls(true);
     QApplication::setOverrideCursor(Qt::WaitCursor);
     m_cancelDownload = false;
-    UAVObjectUpdaterHelper updateHelper;
-    UAVObjectRequestHelper requestHelper;
 
     clearLogList();
 
+    // Listen to every DebugLogEntry instance, the flight side creates them as the stream window
+    foreach(UAVObject * obj, m_objectManager->getObjectInstances(DebugLogEntry::OBJID)) {
+        streamNewInstance(obj);
+    }
+    connect(m_objectManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(streamNewInstance(UAVObject *)));
+
     // Set up what to retrieve
     int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
     int endFlight   = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
 
-    // Prepare to send request for event retrieval
-    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
     for (int flight = startFlight; flight <= endFlight; flight++) {
-        m_flightLogControl->setFlight(flight);
-        bool gotLast = false;
-        int slot     = 0;
-        while (!gotLast) {
-            // Send request for loading flight entry on flight side and wait for ack/nack
-            m_flightLogControl->setEntry(slot);
-
-            if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
-                requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
-                if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-                    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-                        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
-                        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
-                        const quint32 header_len = total_len - data_len;
-
-                        DebugLogEntry::DataFields fields;
-                        quint32 start = logEntry->getData().Size;
-
-                        // cycle until there is space for another object
-                        while (start + header_len + 1 < data_len) {
-                            memset(&fields, 0xFF, total_len);
-                            memcpy(&fields, &logEntry->getData().Data[start], header_len);
-                            // check wether a packed object is found
-                            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
-                            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
-                            quint32 toread = header_len + fields.Size;
-                            if (!(toread + start > data_len)) {
-                                memcpy(&fields, &logEntry->getData().Data[start], toread);
-                                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
-                                subEntry->setData(fields, m_objectManager);
-                                m_logEntries << subEntry;
-                            }
-                            start += toread;
-                        }
-                    }
-
-                    // Increment to get next entry from flight side
-                    slot++;
-                } else {
-                    // We are done, not more entries on this flight
-                    gotLast = true;
-                }
-            } else {
-                // We failed for some reason
-                break;
-            }
-            if (m_cancelDownload) {
-                break;
-            }
-        }
-        if (m_cancelDownload) {
+        if (!streamFlightEntries(flight) || m_cancelDownload) {
+            // We failed for some reason
             break;
         }
     }
 
+    disconnect(m_objectManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(streamNewInstance(UAVObject *)));
+    foreach(UAVObject * obj, m_objectManager->getObjectInstances(DebugLogEntry::OBJID)) {
+        disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(streamEntryUpdated(UAVObject *)));
+    }
+
     if (m_cancelDownload) {
         clearLogList();
         m_cancelDownload = false;
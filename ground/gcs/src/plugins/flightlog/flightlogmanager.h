@@ -31,6 +31,7 @@
 #include <QObject>
 #include <QList>
 #include <QHash>
+#include <QMap>
 #include <QQmlListProperty>
 #include <QSemaphore>
 #include <QXmlStreamWriter>
@@ -260,6 +261,7 @@ signals:
 
     void logStatusesChanged(QStringList arg);
     void loggingEnabledChanged(int arg);
+    void streamEntryReceived();
 
 public slots:
     void clearAllLogs();
@@ -319,6 +321,8 @@ private slots:
     void setupLogStatuses();
     void connectionStatusChanged();
     bool updateLogWrapper(QString name, int level, int period);
+    void streamEntryUpdated(UAVObject *obj);
+    void streamNewInstance(UAVObject *obj);
 
 private:
     UAVObjectManager *m_objectManager;
@@ -335,14 +339,25 @@ private:
     QStringList m_logSettings;
     QStringList m_logStatuses;
 
+    QMap<quint16, DebugLogEntry::DataFields> m_streamEntries;
+    int m_streamFlight;
+
     QList<UAVOLogSettingsWrapper *> m_uavoEntries;
     QHash<QString, UAVOLogSettingsWrapper *> m_uavoEntriesHash;
 
     void exportToOPL(QString fileName);
     void exportToCSV(QString fileName);
     void exportToXML(QString fileName);
+    void addLogEntry(const DebugLogEntry::DataFields &data);
+    void addCompressedLogEntries(const DebugLogEntry::DataFields &data);
+    bool readVarint(const DebugLogEntry::DataFields &data, quint32 end, quint32 &pos, quint32 &value);
+    bool streamFlightEntries(int flight);
+    bool sendStreamAck(int flight, int entry);
 
     static const int UAVTALK_TIMEOUT = 4000;
+    // Must match DEBUGLOG_STREAM_WINDOW on flight side
+    static const int STREAM_WINDOW   = 8;
+    static const int STREAM_RETRIES  = 3;
     static const int LOG_SETTINGS_FILE_VERSION = 1;
     bool m_disableControls;
     bool m_disableExport;
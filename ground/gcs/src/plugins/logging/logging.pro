@@ -12,15 +12,20 @@ HEADERS += \
     loggingplugin.h \
     logginggadgetwidget.h \
     logginggadget.h \
-    logginggadgetfactory.h
+    logginggadgetfactory.h \
+    logginggadgetconfiguration.h \
+    logginggadgetoptionspage.h
 
 SOURCES += \
     loggingplugin.cpp \
     logginggadgetwidget.cpp \
     logginggadget.cpp \
-    logginggadgetfactory.cpp
+    logginggadgetfactory.cpp \
+    logginggadgetconfiguration.cpp \
+    logginggadgetoptionspage.cpp
 
 OTHER_FILES += LoggingGadget.pluginspec
 
-FORMS += logging.ui
+FORMS += logging.ui \
+    logginggadgetoptionspage.ui
 
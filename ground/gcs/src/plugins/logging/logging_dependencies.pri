@@ -2,3 +2,4 @@ include(../../plugins/coreplugin/coreplugin.pri)
 include(../../plugins/uavobjects/uavobjects.pri)
 include(../../plugins/uavtalk/uavtalk.pri)
 include(../../plugins/scope/scope.pri)
+include(../../libs/opldecoder/opldecoder.pri)
@@ -26,6 +26,7 @@
  */
 #include "logginggadget.h"
 #include "logginggadgetwidget.h"
+#include "logginggadgetconfiguration.h"
 
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
@@ -43,5 +44,9 @@ LoggingGadget::~LoggingGadget()
 
 void LoggingGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 {
-    Q_UNUSED(config);
+    LoggingGadgetConfiguration *m = qobject_cast<LoggingGadgetConfiguration *>(config);
+
+    if (m) {
+        static_cast<LoggingGadgetWidget *>(m_widget)->setIndexCaching(m->indexCaching());
+    }
 }
@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logginggadgetconfiguration.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ * @brief      The logging gadget settings
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logginggadgetconfiguration.h"
+
+/**
+ * Loads a saved configuration or defaults if non exist.
+ *
+ */
+LoggingGadgetConfiguration::LoggingGadgetConfiguration(QString classId, QSettings *qSettings, QObject *parent) :
+    IUAVGadgetConfiguration(classId, parent),
+    m_indexCaching(true)
+{
+    // if a saved configuration exists load it
+    if (qSettings != 0) {
+        m_indexCaching = qSettings->value("indexCaching", true).toBool();
+    }
+}
+
+/**
+ * Clones a configuration.
+ *
+ */
+IUAVGadgetConfiguration *LoggingGadgetConfiguration::clone()
+{
+    LoggingGadgetConfiguration *m = new LoggingGadgetConfiguration(this->classId());
+
+    m->m_indexCaching = m_indexCaching;
+    return m;
+}
+
+/**
+ * Saves a configuration.
+ *
+ */
+void LoggingGadgetConfiguration::saveConfig(QSettings *qSettings) const
+{
+    qSettings->setValue("indexCaching", m_indexCaching);
+}
@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logginggadgetconfiguration.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ * @brief      The logging gadget settings
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGGINGGADGETCONFIGURATION_H
+#define LOGGINGGADGETCONFIGURATION_H
+
+#include <coreplugin/iuavgadgetconfiguration.h>
+
+using namespace Core;
+
+class LoggingGadgetConfiguration : public IUAVGadgetConfiguration {
+    Q_OBJECT
+public:
+    explicit LoggingGadgetConfiguration(QString classId, QSettings *qSettings = 0, QObject *parent = 0);
+
+    // Keep the replay index of a log in a file next to it so it is only built once
+    void setIndexCaching(bool indexCaching)
+    {
+        m_indexCaching = indexCaching;
+    }
+
+    bool indexCaching() const
+    {
+        return m_indexCaching;
+    }
+
+    void saveConfig(QSettings *settings) const;
+    IUAVGadgetConfiguration *clone();
+
+private:
+    bool m_indexCaching;
+};
+
+#endif // LOGGINGGADGETCONFIGURATION_H
@@ -27,6 +27,8 @@
 #include "logginggadgetfactory.h"
 #include "logginggadgetwidget.h"
 #include "logginggadget.h"
+#include "logginggadgetconfiguration.h"
+#include "logginggadgetoptionspage.h"
 #include <coreplugin/iuavgadget.h>
 
 LoggingGadgetFactory::LoggingGadgetFactory(QObject *parent) :
@@ -47,3 +49,13 @@ IUAVGadget *LoggingGadgetFactory::createGadget(QWidget *parent)
     gadgetWidget->setPlugin(loggingPlugin);
     return new LoggingGadget(QString("LoggingGadget"), gadgetWidget, parent);
 }
+
+IUAVGadgetConfiguration *LoggingGadgetFactory::createConfiguration(QSettings *qSettings)
+{
+    return new LoggingGadgetConfiguration(QString("LoggingGadget"), qSettings);
+}
+
+IOptionsPage *LoggingGadgetFactory::createOptionsPage(IUAVGadgetConfiguration *config)
+{
+    return new LoggingGadgetOptionsPage(qobject_cast<LoggingGadgetConfiguration *>(config));
+}
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logginggadgetoptionspage.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ * @brief      The logging gadget settings
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logginggadgetoptionspage.h"
+#include "logginggadgetconfiguration.h"
+#include "ui_logginggadgetoptionspage.h"
+
+LoggingGadgetOptionsPage::LoggingGadgetOptionsPage(LoggingGadgetConfiguration *config, QObject *parent) :
+    IOptionsPage(parent),
+    m_config(config)
+{}
+
+// creates options page widget (uses the UI file)
+QWidget *LoggingGadgetOptionsPage::createPage(QWidget *parent)
+{
+    Q_UNUSED(parent);
+    options_page = new Ui::LoggingGadgetOptionsPage();
+    // main widget
+    QWidget *optionsPageWidget = new QWidget;
+    // main layout
+    options_page->setupUi(optionsPageWidget);
+
+    // Restore the contents from the settings:
+    options_page->indexCaching->setChecked(m_config->indexCaching());
+
+    return optionsPageWidget;
+}
+
+/**
+ * Called when the user presses apply or OK.
+ *
+ * Saves the current values
+ *
+ */
+void LoggingGadgetOptionsPage::apply()
+{
+    m_config->setIndexCaching(options_page->indexCaching->isChecked());
+}
+
+void LoggingGadgetOptionsPage::finish()
+{
+    delete options_page;
+}
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logginggadgetoptionspage.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ * @brief      The logging gadget settings
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGGINGGADGETOPTIONSPAGE_H
+#define LOGGINGGADGETOPTIONSPAGE_H
+
+#include "coreplugin/dialogs/ioptionspage.h"
+
+namespace Core {
+class IUAVGadgetConfiguration;
+}
+
+class LoggingGadgetConfiguration;
+
+namespace Ui {
+class LoggingGadgetOptionsPage;
+}
+
+using namespace Core;
+
+class LoggingGadgetOptionsPage : public IOptionsPage {
+    Q_OBJECT
+public:
+    explicit LoggingGadgetOptionsPage(LoggingGadgetConfiguration *config, QObject *parent = 0);
+
+    QWidget *createPage(QWidget *parent);
+    void apply();
+    void finish();
+
+private:
+    Ui::LoggingGadgetOptionsPage *options_page;
+    LoggingGadgetConfiguration *m_config;
+};
+
+#endif // LOGGINGGADGETOPTIONSPAGE_H
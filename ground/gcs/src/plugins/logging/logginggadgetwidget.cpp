@@ -33,6 +33,7 @@
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QPushButton>
+#include <QTime>
 #include <loggingplugin.h>
 
 LoggingGadgetWidget::LoggingGadgetWidget(QWidget *parent) : QLabel(parent)
@@ -58,16 +59,55 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin *p)
     connect(m_logging->pauseButton, SIGNAL(clicked()), p->getLogfile(), SLOT(pauseReplay()));
     connect(m_logging->pauseButton, SIGNAL(clicked()), scpPlugin, SLOT(stopPlotting()));
     connect(m_logging->playbackSpeed, SIGNAL(valueChanged(double)), p->getLogfile(), SLOT(setReplaySpeed(double)));
+    connect(p->getLogfile(), SIGNAL(indexReady(quint32)), this, SLOT(indexReady(quint32)));
+    connect(p->getLogfile(), SIGNAL(replayPositionChanged(quint32)), this, SLOT(replayPositionChanged(quint32)));
+    connect(m_logging->positionSlider, SIGNAL(sliderReleased()), this, SLOT(positionSliderReleased()));
+    connect(m_logging->positionSlider, SIGNAL(sliderMoved(int)), this, SLOT(positionSliderMoved(int)));
     void pauseReplay();
     void resumeReplay();
 }
 
 
+void LoggingGadgetWidget::setIndexCaching(bool indexCaching)
+{
+    loggingPlugin->getLogConnection()->setIndexCaching(indexCaching);
+}
+
 void LoggingGadgetWidget::stateChanged(QString status)
 {
     m_logging->statusLabel->setText(status);
 }
 
+void LoggingGadgetWidget::indexReady(quint32 duration)
+{
+    m_logging->positionSlider->setRange(0, duration);
+    m_logging->positionSlider->setEnabled(true);
+}
+
+void LoggingGadgetWidget::replayPositionChanged(quint32 timeStamp)
+{
+    // Do not fight the user while scrubbing
+    if (!m_logging->positionSlider->isSliderDown()) {
+        m_logging->positionSlider->setValue(timeStamp);
+        setPositionLabel(timeStamp);
+    }
+}
+
+void LoggingGadgetWidget::positionSliderReleased()
+{
+    loggingPlugin->getLogfile()->seekReplay(m_logging->positionSlider->value());
+}
+
+void LoggingGadgetWidget::positionSliderMoved(int position)
+{
+    setPositionLabel(position);
+}
+
+void LoggingGadgetWidget::setPositionLabel(quint32 timeStamp)
+{
+    m_logging->positionLabel->setText(QTime(0, 0).addMSecs(timeStamp).toString("hh:mm:ss"));
+}
+
 /**
  * @}
  * @}
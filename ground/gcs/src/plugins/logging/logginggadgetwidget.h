@@ -44,15 +44,22 @@ public:
     LoggingGadgetWidget(QWidget *parent = 0);
     ~LoggingGadgetWidget();
     void setPlugin(LoggingPlugin *p);
+    void setIndexCaching(bool indexCaching);
 
 protected slots:
     void stateChanged(QString status);
+    void indexReady(quint32 duration);
+    void replayPositionChanged(quint32 timeStamp);
+    void positionSliderReleased();
+    void positionSliderMoved(int position);
 
 signals:
     void pause();
     void play();
 
 private:
+    void setPositionLabel(quint32 timeStamp);
+
     Ui_Logging *m_logging;
     LoggingPlugin *loggingPlugin;
     ScopeGadgetFactory *scpPlugin;
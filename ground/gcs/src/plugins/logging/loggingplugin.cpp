@@ -41,11 +41,17 @@
 
 #include <extensionsystem/pluginmanager.h>
 #include <QKeySequence>
+#include <QApplication>
+#include <QMessageBox>
+#include <QFileInfo>
 #include "uavobjectmanager.h"
+#include "uavdataobject.h"
+#include <opldecoder/opldecoder.h>
 
 
 LoggingConnection::LoggingConnection(LoggingPlugin *loggingPlugin) :
     loggingPlugin(loggingPlugin),
+    m_indexCaching(true),
     m_deviceOpened(false)
 {}
 
@@ -85,6 +91,7 @@ QIODevice *LoggingConnection::openDevice(const QString &deviceName)
 void LoggingConnection::startReplay(QString file)
 {
     logFile.setFileName(file);
+    logFile.setIndexCaching(m_indexCaching);
     if (logFile.open(QIODevice::ReadOnly)) {
         qDebug() << "Replaying " << file;
         // state = REPLAY;
@@ -294,7 +301,8 @@ LoggingPlugin::LoggingPlugin() :
     loggingThread(NULL),
     logConnection(new LoggingConnection(this)),
     mf(NULL),
-    cmd(NULL)
+    cmd(NULL),
+    exportCmd(NULL)
 {}
 
 LoggingPlugin::~LoggingPlugin()
@@ -333,6 +341,16 @@ bool LoggingPlugin::initialize(const QStringList & args, QString *errMsg)
 
     connect(cmd->action(), SIGNAL(triggered(bool)), this, SLOT(toggleLogging()));
 
+    // Command to convert a log to one CSV file per object
+    exportCmd = am->registerAction(new QAction(this),
+                                   "LoggingPlugin.ExportCSV",
+                                   QList<int>() <<
+                                   Core::Constants::C_GLOBAL_ID);
+    exportCmd->action()->setText(tr("Export log to CSV..."));
+    ac->addAction(exportCmd, "Logging");
+
+    connect(exportCmd->action(), SIGNAL(triggered(bool)), this, SLOT(exportToCSV()));
+
 
     mf = new LoggingGadgetFactory(this);
     addAutoReleasedObject(mf);
@@ -401,6 +419,66 @@ void LoggingPlugin::stopLogging()
 }
 
 
+/**
+ * Decode a log file in one go and write a CSV file per object found in it
+ */
+void LoggingPlugin::exportToCSV()
+{
+    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Export Log"), QString(), tr("OpenPilot Log (*.opl)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QString dirName = QFileDialog::getExistingDirectory(NULL, tr("Export CSV files to"), QFileInfo(fileName).absolutePath());
+    if (dirName.isEmpty()) {
+        return;
+    }
+
+    // Describe the objects known to this GCS to the decoder
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    QList<OplObjectInfo> objects;
+    foreach(QList<UAVObject *> instances, objManager->getObjects()) {
+        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(instances.first());
+        if (!obj) {
+            continue;
+        }
+        OplObjectInfo info;
+        info.objId    = obj->getObjID();
+        info.name     = obj->getName();
+        info.numBytes = obj->getNumBytes();
+        foreach(UAVObjectField * field, obj->getFields()) {
+            OplFieldInfo fieldInfo;
+            fieldInfo.name     = field->getName();
+            fieldInfo.type     = (OplFieldInfo::FieldType)field->getType();
+            fieldInfo.elements = field->getNumElements();
+            fieldInfo.offset   = field->getDataOffset();
+            info.fields << fieldInfo;
+        }
+        objects << info;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    OplDecoder decoder(objects);
+    bool success = decoder.decode(fileName);
+    if (success) {
+        QDir dir(dirName);
+        foreach(quint32 objId, decoder.objectIds()) {
+            const OplObjectColumns *columns = decoder.object(objId);
+            QFile csvFile(dir.filePath(columns->name() + ".csv"));
+            if (!csvFile.open(QFile::WriteOnly | QFile::Truncate) || !columns->writeCSV(&csvFile)) {
+                success = false;
+                break;
+            }
+        }
+    }
+    QApplication::restoreOverrideCursor();
+
+    if (!success) {
+        QMessageBox::critical(NULL, tr("Export Log"), tr("Unable to export %1").arg(fileName));
+    }
+}
+
 /**
  * Receive the logging stopped signal from the LoggingThread
  * and change status to not logging
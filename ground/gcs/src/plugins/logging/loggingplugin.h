@@ -71,11 +71,17 @@ public:
     {
         return &logFile;
     }
+    // Set from the logging gadget configuration, applies to the next replay
+    void setIndexCaching(bool indexCaching)
+    {
+        m_indexCaching = indexCaching;
+    }
 
 
 private:
     LogFile logFile;
     LoggingPlugin *loggingPlugin;
+    bool m_indexCaching;
 
 
 protected slots:
@@ -159,10 +165,12 @@ private slots:
     void loggingStopped();
     void replayStarted();
     void replayStopped();
+    void exportToCSV();
 
 private:
     LoggingGadgetFactory *mf;
     Core::Command *cmd;
+    Core::Command *exportCmd;
 };
 #endif /* LoggingPLUGIN_H_ */
 /**
@@ -34,10 +34,10 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
                    int scaleOrderFactor, int meanSamples, QString mathFunction,
                    double plotDataSize, QPen pen, bool antialiased) :
     m_scalePower(scaleOrderFactor), m_meanSamples(meanSamples),
-    m_meanSum(0.0f), m_mathFunction(mathFunction), m_correctionSum(0.0f),
-    m_correctionCount(0), m_plotDataSize(plotDataSize),
+    m_mean(0.0), m_meanSquares(0.0), m_mathFunction(mathFunction),
+    m_correctionCount(0), m_plotDataSize(plotDataSize), m_seriesData(NULL),
     m_object(object), m_field(field), m_element(element),
-    m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false)
+    m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false), m_enumIndex(-1)
 {
     if (m_field->getNumElements() > 1) {
         m_elementName = m_field->getElementNames().at(m_element);
@@ -62,7 +62,9 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
     }
 
     m_plotCurve->setPen(m_pen);
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    // The curve takes ownership of the series
+    m_seriesData = new PlotSeriesData(&m_xDataEntries, &m_yDataEntries);
+    m_plotCurve->setData(m_seriesData);
     m_isEnumPlot = m_field->getType() == UAVObjectField::ENUM;
 }
 
@@ -88,18 +90,20 @@ void PlotData::setVisible(bool visible)
     visibilityChanged(m_plotCurve);
 }
 
-void PlotData::updatePlotData()
+void PlotData::updatePlotData(const QwtInterval &xRange, int pixels)
 {
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    m_seriesData->update(xRange, pixels);
 }
 
 void PlotData::clear()
 {
-    m_meanSum = 0.0f;
-    m_correctionSum   = 0.0f;
+    m_mean = 0.0;
+    m_meanSquares     = 0.0;
     m_correctionCount = 0;
     m_xDataEntries.clear();
     m_yDataEntries.clear();
+    m_yDataHistory.clear();
+    m_seriesData->clear();
     while (!m_enumMarkerList.isEmpty()) {
         QwtPlotMarker *marker = m_enumMarkerList.takeFirst();
         marker->detach();
@@ -113,7 +117,7 @@ void PlotData::clear()
 bool PlotData::hasData() const
 {
     if (!m_isEnumPlot) {
-        return !m_xDataEntries.isEmpty();
+        return !m_yDataEntries.isEmpty();
     } else {
         return !m_enumMarkerList.isEmpty();
     }
@@ -144,34 +148,42 @@ void PlotData::visibilityChanged(QwtPlotItem *item)
 
 void PlotData::calcMathFunction(double currentValue)
 {
-    // Put the new value at the back
+    // Put the new value at the back and update the running mean and
+    // sum of squared deviations (Welford)
     m_yDataHistory.append(currentValue);
-
-    // calculate average value
-    m_meanSum += currentValue;
-    if (m_yDataHistory.size() > m_meanSamples) {
-        m_meanSum -= m_yDataHistory.first();
-        m_yDataHistory.pop_front();
+    double delta = currentValue - m_mean;
+    m_mean += delta / m_yDataHistory.size();
+    m_meanSquares += delta * (currentValue - m_mean);
+
+    // Take the oldest value out of the window the same way
+    if (m_yDataHistory.size() > qMax(m_meanSamples, 1)) {
+        double oldest = m_yDataHistory.first();
+        m_yDataHistory.removeFirst();
+        delta   = oldest - m_mean;
+        m_mean -= delta / m_yDataHistory.size();
+        m_meanSquares -= delta * (oldest - m_mean);
     }
-    // make sure to correct the sum every meanSamples steps to prevent it
-    // from running away due to floating point rounding errors
-    m_correctionSum += currentValue;
+
+    // make sure to recalculate from the window every meanSamples steps to
+    // prevent the sums from running away due to floating point rounding errors
     if (++m_correctionCount >= m_meanSamples) {
-        m_meanSum = m_correctionSum;
-        m_correctionSum = 0.0f;
+        double sum = 0.0;
+        for (int i = 0; i < m_yDataHistory.size(); i++) {
+            sum += m_yDataHistory.at(i);
+        }
+        m_mean = sum / m_yDataHistory.size();
+        m_meanSquares = 0.0;
+        for (int i = 0; i < m_yDataHistory.size(); i++) {
+            m_meanSquares += pow(m_yDataHistory.at(i) - m_mean, 2);
+        }
         m_correctionCount = 0;
     }
 
-    double boxcarAvg = m_meanSum / m_yDataHistory.size();
     if (m_mathFunction == "Standard deviation") {
-        // Calculate square of sample standard deviation, with Bessel's correction
-        double stdSum = 0;
-        for (int i = 0; i < m_yDataHistory.size(); i++) {
-            stdSum += pow(m_yDataHistory.at(i) - boxcarAvg, 2) / (m_meanSamples - 1);
-        }
-        m_yDataEntries.append(sqrt(stdSum));
+        // Sample standard deviation, with Bessel's correction
+        m_yDataEntries.append((m_meanSamples > 1) ? sqrt(qMax(m_meanSquares, 0.0) / (m_meanSamples - 1)) : 0.0);
     } else {
-        m_yDataEntries.append(boxcarAvg);
+        m_yDataEntries.append(m_mean);
     }
 }
 
@@ -207,7 +219,7 @@ bool SequentialPlotData::append(UAVObject *obj)
 
     if (m_object == obj && m_field) {
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
+            double currentValue = m_field->getDouble(m_element) * pow(10, m_scalePower);
 
             // Perform scope math, if necessary
             if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
@@ -215,22 +227,23 @@ bool SequentialPlotData::append(UAVObject *obj)
             } else {
                 m_yDataEntries.append(currentValue);
             }
+            m_seriesData->sampleAppended();
 
             if (m_yDataEntries.size() > m_plotDataSize) {
-                // If new data overflows the window, remove old data...
-                m_yDataEntries.pop_front();
-            } else {
-                // ...otherwise, add a new y point at position xData
-                m_xDataEntries.insert(m_xDataEntries.size(), m_xDataEntries.size());
+                // If new data overflows the window, remove old data,
+                // the x values are the sample indexes
+                m_yDataEntries.removeFirst();
+                m_seriesData->firstSampleRemoved();
             }
             return true;
         } else {
             // Enum markers
-            QString value = m_field->getValue(m_element).toString();
+            int index = m_field->getEnumIndex(m_element);
 
             QwtPlotMarker *marker = m_enumMarkerList.isEmpty() ? NULL : m_enumMarkerList.last();
-            if (!marker || marker->title() != value) {
-                marker = createMarker(value);
+            if (!marker || m_enumIndex != index) {
+                m_enumIndex = index;
+                marker = createMarker(m_field->getOptions().at(index));
                 marker->setXValue(m_enumMarkerList.size());
 
                 if (m_plotCurve->isVisible()) {
@@ -256,7 +269,7 @@ bool ChronoPlotData::append(UAVObject *obj)
 
         double xValue = NOW.toTime_t() + NOW.time().msec() / 1000.0;
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
+            double currentValue = m_field->getDouble(m_element) * pow(10, m_scalePower);
 
             // Perform scope math, if necessary
             if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
@@ -266,13 +279,15 @@ bool ChronoPlotData::append(UAVObject *obj)
             }
 
             m_xDataEntries.append(xValue);
+            m_seriesData->sampleAppended();
         } else {
             // Enum markers
-            QString value = m_field->getValue(m_element).toString();
+            int index = m_field->getEnumIndex(m_element);
 
             QwtPlotMarker *marker = m_enumMarkerList.isEmpty() ? NULL : m_enumMarkerList.last();
-            if (!marker || marker->title() != value) {
-                marker = createMarker(value);
+            if (!marker || m_enumIndex != index) {
+                m_enumIndex = index;
+                marker = createMarker(m_field->getOptions().at(index));
                 marker->setXValue(xValue);
 
                 if (m_plotCurve->isVisible()) {
@@ -291,8 +306,9 @@ void ChronoPlotData::removeStaleData()
 {
     while (!m_xDataEntries.isEmpty() &&
            (m_xDataEntries.last() - m_xDataEntries.first()) > m_plotDataSize) {
-        m_yDataEntries.pop_front();
-        m_xDataEntries.pop_front();
+        m_yDataEntries.removeFirst();
+        m_xDataEntries.removeFirst();
+        m_seriesData->firstSampleRemoved();
     }
     while (!m_enumMarkerList.isEmpty() &&
            (m_enumMarkerList.last()->xValue() - m_enumMarkerList.first()->xValue()) > m_plotDataSize) {
@@ -29,6 +29,8 @@
 #define PLOTDATA_H
 
 #include "uavobject.h"
+#include "plotringbuffer.h"
+#include "plotseriesdata.h"
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_plot.h"
@@ -92,7 +94,7 @@ public:
     virtual PlotType plotType() const   = 0;
     virtual void removeStaleData() = 0;
 
-    void updatePlotData();
+    void updatePlotData(const QwtInterval &xRange, int pixels);
     void clear();
 
     bool hasData() const;
@@ -107,15 +109,17 @@ protected:
     // This is the power to which each value must be raised
     int m_scalePower;
     int m_meanSamples;
-    double m_meanSum;
+    // Running mean and sum of squared deviations of m_yDataHistory
+    double m_mean;
+    double m_meanSquares;
     QString m_mathFunction;
-    double m_correctionSum;
     int m_correctionCount;
     double m_plotDataSize;
 
-    QVector<double> m_xDataEntries;
-    QVector<double> m_yDataEntries;
-    QVector<double> m_yDataHistory;
+    PlotRingBuffer<double> m_xDataEntries;
+    PlotRingBuffer<double> m_yDataEntries;
+    PlotRingBuffer<double> m_yDataHistory;
+    PlotSeriesData *m_seriesData;
 
     UAVObject *m_object;
     UAVObjectField *m_field;
@@ -127,6 +131,7 @@ protected:
     bool m_isVisible;
     QPen m_pen;
     bool m_isEnumPlot;
+    int m_enumIndex;
     virtual void calcMathFunction(double currentValue);
     QwtPlotMarker *createMarker(QString value);
 };
@@ -142,7 +147,10 @@ public:
                        int scaleFactor, int meanSamples, QString mathFunction,
                        double plotDataSize, QPen pen, bool antialiased)
         : PlotData(object, field, element, scaleFactor, meanSamples,
-                   mathFunction, plotDataSize, pen, antialiased) {}
+                   mathFunction, plotDataSize, pen, antialiased)
+    {
+        m_seriesData->setSequential();
+    }
     ~SequentialPlotData() {}
 
     bool append(UAVObject *obj);
@@ -0,0 +1,105 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotringbuffer.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#ifndef PLOTRINGBUFFER_H
+#define PLOTRINGBUFFER_H
+
+#include <QVector>
+
+/*!
+   \brief Growable ring buffer of samples. Removing the oldest sample is O(1),
+   the capacity is kept at a power of two and only grows until it fits the
+   plot window.
+ */
+template<typename T>
+class PlotRingBuffer {
+public:
+    PlotRingBuffer() : m_first(0), m_size(0) {}
+
+    int size() const
+    {
+        return m_size;
+    }
+    bool isEmpty() const
+    {
+        return m_size == 0;
+    }
+    const T &at(int i) const
+    {
+        return m_data.at((m_first + i) & (m_data.size() - 1));
+    }
+    const T &first() const
+    {
+        return at(0);
+    }
+    const T &last() const
+    {
+        return at(m_size - 1);
+    }
+    T &last()
+    {
+        return m_data[(m_first + m_size - 1) & (m_data.size() - 1)];
+    }
+
+    void append(const T &value)
+    {
+        if (m_size == m_data.size()) {
+            grow();
+        }
+        m_data[(m_first + m_size) & (m_data.size() - 1)] = value;
+        m_size++;
+    }
+    void removeFirst()
+    {
+        m_first = (m_first + 1) & (m_data.size() - 1);
+        m_size--;
+    }
+    void clear()
+    {
+        m_first = 0;
+        m_size  = 0;
+    }
+
+private:
+    void grow()
+    {
+        QVector<T> data(qMax(16, m_data.size() * 2));
+
+        for (int i = 0; i < m_size; i++) {
+            data[i] = at(i);
+        }
+        m_data  = data;
+        m_first = 0;
+    }
+
+    QVector<T> m_data;
+    int m_first;
+    int m_size;
+};
+
+#endif // PLOTRINGBUFFER_H
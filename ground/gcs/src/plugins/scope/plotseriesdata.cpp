@@ -0,0 +1,221 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotseriesdata.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "plotseriesdata.h"
+
+PlotSeriesData::PlotSeriesData(const PlotRingBuffer<double> *xData, const PlotRingBuffer<double> *yData)
+    : m_xData(xData), m_yData(yData), m_firstIndex(0), m_decimated(false)
+{
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        m_levels[i].firstBucket = 0;
+    }
+}
+
+size_t PlotSeriesData::size() const
+{
+    return m_decimated ? m_points.size() : m_yData->size();
+}
+
+QPointF PlotSeriesData::sample(size_t i) const
+{
+    if (m_decimated) {
+        return m_points.at(i);
+    }
+    return QPointF(m_xData ? m_xData->at(i) : i, m_yData->at(i));
+}
+
+QRectF PlotSeriesData::boundingRect() const
+{
+    if (d_boundingRect.width() < 0.0) {
+        d_boundingRect = qwtBoundingRect(*this);
+    }
+    return d_boundingRect;
+}
+
+void PlotSeriesData::setSequential()
+{
+    m_xData = NULL;
+}
+
+void PlotSeriesData::sampleAppended()
+{
+    qint64 index = m_firstIndex + m_yData->size() - 1;
+    double value = m_yData->last();
+
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        Level &level  = m_levels[i];
+        qint64 bucket = index >> (LEVEL_SHIFT * (i + 1));
+
+        if (level.buckets.isEmpty() || level.firstBucket + level.buckets.size() <= bucket) {
+            if (level.buckets.isEmpty()) {
+                level.firstBucket = bucket;
+            }
+            Bucket newBucket = { index, index };
+            level.buckets.append(newBucket);
+        } else {
+            Bucket &last = level.buckets.last();
+            if (value < yAt(last.minIndex)) {
+                last.minIndex = index;
+            }
+            if (value > yAt(last.maxIndex)) {
+                last.maxIndex = index;
+            }
+        }
+    }
+}
+
+void PlotSeriesData::firstSampleRemoved()
+{
+    m_firstIndex++;
+
+    // Buckets are dropped once all their samples are gone. The first bucket
+    // may still refer to removed samples, update() never uses it then.
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        Level &level = m_levels[i];
+        while (!level.buckets.isEmpty() &&
+               ((level.firstBucket + 1) << (LEVEL_SHIFT * (i + 1))) <= m_firstIndex) {
+            level.buckets.removeFirst();
+            level.firstBucket++;
+        }
+    }
+}
+
+void PlotSeriesData::clear()
+{
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        m_levels[i].buckets.clear();
+        m_levels[i].firstBucket = 0;
+    }
+    m_firstIndex = 0;
+    m_decimated  = false;
+    m_points.clear();
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+}
+
+void PlotSeriesData::update(const QwtInterval &xRange, int pixels)
+{
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+    m_decimated    = false;
+    m_points.clear();
+
+    if (m_yData->isEmpty() || !xRange.isValid() || pixels <= 0) {
+        return;
+    }
+
+    // Visible samples, plus one on each side so the curve reaches the edges
+    qint64 endIndex = m_firstIndex + m_yData->size();
+    qint64 from = qMax(m_firstIndex, lowerBound(xRange.minValue()) - 1);
+    qint64 to   = qMin(endIndex, lowerBound(xRange.maxValue()) + 1);
+
+    // Coarsest level that still has at least one bucket per pixel
+    qint64 samplesPerPixel = (to - from) / pixels;
+    int level = -1;
+    while (level + 1 < LEVEL_COUNT && (Q_INT64_C(1) << (LEVEL_SHIFT * (level + 2))) <= samplesPerPixel) {
+        level++;
+    }
+    if (level < 0) {
+        // Few enough samples to draw all of them
+        return;
+    }
+
+    int shift = LEVEL_SHIFT * (level + 1);
+    const Level &buckets = m_levels[level];
+    qint64 firstBucket   = ((from - 1) >> shift) + 1;
+    qint64 endBucket     = to >> shift;
+
+    m_decimated = true;
+    m_points.reserve(2 * (endBucket - firstBucket + 2));
+    if (firstBucket >= endBucket) {
+        appendSamples(from, to);
+        return;
+    }
+    // The partially visible buckets on both ends are taken from the samples
+    appendSamples(from, firstBucket << shift);
+    for (qint64 i = firstBucket; i < endBucket; i++) {
+        const Bucket &bucket = buckets.buckets.at(i - buckets.firstBucket);
+        appendEnvelope(bucket.minIndex, bucket.maxIndex);
+    }
+    appendSamples(endBucket << shift, to);
+}
+
+double PlotSeriesData::xAt(qint64 index) const
+{
+    return m_xData ? m_xData->at(index - m_firstIndex) : index - m_firstIndex;
+}
+
+double PlotSeriesData::yAt(qint64 index) const
+{
+    return m_yData->at(index - m_firstIndex);
+}
+
+qint64 PlotSeriesData::lowerBound(double x) const
+{
+    qint64 first = m_firstIndex;
+    qint64 count = m_yData->size();
+
+    while (count > 0) {
+        qint64 step = count / 2;
+        if (xAt(first + step) < x) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+void PlotSeriesData::appendSamples(qint64 from, qint64 to)
+{
+    if (from >= to) {
+        return;
+    }
+    qint64 minIndex = from;
+    qint64 maxIndex = from;
+    for (qint64 i = from + 1; i < to; i++) {
+        double value = yAt(i);
+        if (value < yAt(minIndex)) {
+            minIndex = i;
+        }
+        if (value > yAt(maxIndex)) {
+            maxIndex = i;
+        }
+    }
+    appendEnvelope(minIndex, maxIndex);
+}
+
+void PlotSeriesData::appendEnvelope(qint64 minIndex, qint64 maxIndex)
+{
+    // Keep the points in sample order so the curve does not turn back
+    qint64 firstIndex = qMin(minIndex, maxIndex);
+    qint64 lastIndex  = qMax(minIndex, maxIndex);
+
+    m_points.append(QPointF(xAt(firstIndex), yAt(firstIndex)));
+    if (lastIndex != firstIndex) {
+        m_points.append(QPointF(xAt(lastIndex), yAt(lastIndex)));
+    }
+}
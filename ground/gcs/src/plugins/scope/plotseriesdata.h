@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotseriesdata.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTSERIESDATA_H
+#define PLOTSERIESDATA_H
+
+#include "plotringbuffer.h"
+
+#include <qwt/src/qwt_series_data.h>
+#include <qwt/src/qwt_interval.h>
+#include <QVector>
+#include <QPointF>
+
+/*!
+   \brief Hands the samples of a curve to Qwt without copying them. Without
+   x data the sample index is used as x value.
+
+   A min/max pyramid over the samples is kept up to date as samples come and
+   go. When the visible range holds more samples than there are pixels, only
+   the min/max envelope of each pixel wide group of samples is served, so the
+   cost of a replot does not depend on the length of the plot window.
+ */
+class PlotSeriesData : public QwtSeriesData<QPointF> {
+public:
+    PlotSeriesData(const PlotRingBuffer<double> *xData, const PlotRingBuffer<double> *yData);
+
+    size_t size() const;
+    QPointF sample(size_t i) const;
+    QRectF boundingRect() const;
+
+    void setSequential();
+
+    // Must be called after a sample was appended to or removed from the buffers
+    void sampleAppended();
+    void firstSampleRemoved();
+    void clear();
+
+    // Select the samples to serve for the visible x range and canvas width
+    void update(const QwtInterval &xRange, int pixels);
+
+private:
+    // Bucket of level L holds 4^(L + 1) samples
+    enum { LEVEL_COUNT = 8, LEVEL_SHIFT = 2 };
+
+    struct Bucket {
+        qint64 minIndex;
+        qint64 maxIndex;
+    };
+    struct Level {
+        PlotRingBuffer<Bucket> buckets;
+        qint64 firstBucket;
+    };
+
+    double xAt(qint64 index) const;
+    double yAt(qint64 index) const;
+    qint64 lowerBound(double x) const;
+    void appendSamples(qint64 from, qint64 to);
+    void appendEnvelope(qint64 minIndex, qint64 maxIndex);
+
+    const PlotRingBuffer<double> *m_xData;
+    const PlotRingBuffer<double> *m_yData;
+
+    Level m_levels[LEVEL_COUNT];
+    // Sample indexes are counted from the first sample ever appended
+    qint64 m_firstIndex;
+
+    bool m_decimated;
+    QVector<QPointF> m_points;
+};
+
+#endif // PLOTSERIESDATA_H
@@ -11,6 +11,8 @@ include (scope_dependencies.pri)
 HEADERS += \
     scopeplugin.h \
     plotdata.h \
+    plotringbuffer.h \
+    plotseriesdata.h \
     scope_global.h \
     scopegadgetoptionspage.h \
     scopegadgetconfiguration.h \
@@ -21,6 +23,7 @@ HEADERS += \
 SOURCES += \
     scopeplugin.cpp \
     plotdata.cpp \
+    plotseriesdata.cpp \
     scopegadgetoptionspage.cpp \
     scopegadgetconfiguration.cpp \
     scopegadget.cpp \
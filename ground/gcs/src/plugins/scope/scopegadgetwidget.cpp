@@ -430,10 +430,6 @@ void ScopeGadgetWidget::replotNewData()
     }
 
     QMutexLocker locker(&m_mutex);
-    foreach(PlotData * plotData, m_curvesData.values()) {
-        plotData->removeStaleData();
-        plotData->updatePlotData();
-    }
 
     QDateTime NOW = QDateTime::currentDateTime();
     double toTime = NOW.toTime_t();
@@ -442,6 +438,13 @@ void ScopeGadgetWidget::replotNewData()
         setAxisScale(QwtPlot::xBottom, toTime - m_plotDataSize, toTime);
     }
 
+    // Curves only hand over as many points as the canvas can show
+    QwtInterval xRange = axisInterval(QwtPlot::xBottom);
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        plotData->removeStaleData();
+        plotData->updatePlotData(xRange, canvas()->width());
+    }
+
     csvLoggingInsertData();
 
     replot();
@@ -136,10 +136,14 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
     QMatrix backgroundMatrix = (m_renderer->matrixForElement(background->elementId())).inverted();
 
     QString alarm = systemAlarm->getName();
+    // Read all alarms from one copy instead of locking the object per element
+    QByteArray snapshot = systemAlarm->getDataSnapshot();
     foreach(UAVObjectField * field, systemAlarm->getFields()) {
+        QStringList options = field->getOptions();
         for (uint i = 0; i < field->getNumElements(); ++i) {
             QString element = field->getElementNames()[i];
-            QString value   = field->getValue(i).toString();
+            QString value   = (field->getType() == UAVObjectField::ENUM) ?
+                              options.at(field->getEnumIndex(snapshot, i)) : QString::number(field->getDouble(snapshot, i));
             if (!missingElements->contains(element)) {
                 if (m_renderer->elementExists(element)) {
                     QString element2 = element + "-" + value;
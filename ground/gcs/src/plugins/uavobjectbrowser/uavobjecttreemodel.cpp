@@ -51,6 +51,7 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool sh
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
     Q_ASSERT(objManager);
+    m_objManager = objManager;
 
     // Create highlight manager, let it run every 300 ms.
     m_highlightManager = new HighLightManager(300);
@@ -63,6 +64,7 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool sh
 
 UAVObjectTreeModel::~UAVObjectTreeModel()
 {
+    m_objManager->unsubscribe(this);
     delete m_highlightManager;
     delete m_rootItem;
 }
@@ -156,7 +158,8 @@ TreeItem *UAVObjectTreeModel::createCategoryItems(QStringList categoryPath, Tree
 
 MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    // highlighting does not need more than the display rate
+    m_objManager->subscribe(obj, this, SLOT(highlightUpdatedObject(UAVObject *)), HIGHLIGHT_RATE);
     MetaObjectTreeItem *meta = new MetaObjectTreeItem(obj, tr("Meta Data"));
 
     meta->setHighlightManager(m_highlightManager);
@@ -174,7 +177,8 @@ MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeIt
 
 void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    // highlighting does not need more than the display rate
+    m_objManager->subscribe(obj, this, SLOT(highlightUpdatedObject(UAVObject *)), HIGHLIGHT_RATE);
     connect(obj, SIGNAL(isKnownChanged(UAVObject *, bool)), this, SLOT(isKnownChanged(UAVObject *, bool)));
     TreeItem *item;
     if (obj->isSingleInstance()) {
@@ -128,6 +128,9 @@ private:
 
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
+
+    UAVObjectManager *m_objManager;
+    static const int HIGHLIGHT_RATE = 30; // Hz
 };
 
 #endif // UAVOBJECTTREEMODEL_H
@@ -312,6 +312,33 @@ qint32 UAVObject::pack(quint8 *dataOut)
     return numBytes;
 }
 
+/**
+ * Copy the object data under a single lock, fields can then read any number
+ * of values from the copy without locking the object again
+ */
+QByteArray UAVObject::getDataSnapshot()
+{
+    QMutexLocker locker(mutex);
+
+    return QByteArray((const char *)data, numBytes);
+}
+
+/**
+ * Replace the object data with a copy made by getDataSnapshot(), no update
+ * event is emitted.
+ * @returns False if the size does not match or the GCS can not write the object
+ */
+bool UAVObject::setDataSnapshot(const QByteArray & snapshot)
+{
+    QMutexLocker locker(mutex);
+
+    if ((quint32)snapshot.size() != numBytes || GetGcsAccess(getMetadata()) != ACCESS_READWRITE) {
+        return false;
+    }
+    memcpy(data, snapshot.constData(), numBytes);
+    return true;
+}
+
 /**
  * Unpack the object data from a byte array
  * @returns The number of bytes copied
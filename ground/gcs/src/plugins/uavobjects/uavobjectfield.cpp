@@ -1182,12 +1182,141 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
     }
 }
 
+/**
+ * Numeric value of an element without going through a QVariant. Enums
+ * return their option converted to a number as getValue().toDouble()
+ * does, use getEnumIndex() for the index of the option. Strings return zero.
+ */
 double UAVObjectField::getDouble(quint32 index)
 {
-    return getValue(index).toDouble();
+    QMutexLocker locker(obj->getMutex());
+
+    return toDouble(data, index);
 }
 
 void UAVObjectField::setDouble(double value, quint32 index)
 {
     setValue(QVariant(value), index);
 }
+
+/**
+ * Read all elements at once, values must hold getNumElements() entries
+ */
+void UAVObjectField::getDoubles(double *values)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    for (quint32 index = 0; index < numElements; ++index) {
+        values[index] = toDouble(data, index);
+    }
+}
+
+/**
+ * Index of the option of an enum element, zero for other types
+ */
+quint8 UAVObjectField::getEnumIndex(quint32 index)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    return toEnumIndex(data, index);
+}
+
+/**
+ * Set an enum element by the index of its option, out of range indexes are ignored
+ */
+void UAVObjectField::setEnumIndex(int value, quint32 index)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    if (type != ENUM || index >= numElements || value < 0 || value >= options.length()) {
+        return;
+    }
+    if (UAVObject::GetGcsAccess(obj->getMetadata()) == UAVObject::ACCESS_READWRITE) {
+        data[offset + numBytesPerElement * index] = value;
+    }
+}
+
+/**
+ * Same as getDouble() but reads from a copy made by UAVObject::getDataSnapshot()
+ */
+double UAVObjectField::getDouble(const QByteArray & snapshot, quint32 index)
+{
+    if ((quint32)snapshot.size() < offset + getNumBytes()) {
+        return 0;
+    }
+    return toDouble((const quint8 *)snapshot.constData(), index);
+}
+
+quint8 UAVObjectField::getEnumIndex(const QByteArray & snapshot, quint32 index)
+{
+    if ((quint32)snapshot.size() < offset + getNumBytes()) {
+        return 0;
+    }
+    return toEnumIndex((const quint8 *)snapshot.constData(), index);
+}
+
+quint8 UAVObjectField::toEnumIndex(const quint8 *objData, quint32 index)
+{
+    if (type != ENUM || index >= numElements) {
+        return 0;
+    }
+
+    quint8 option = objData[offset + numBytesPerElement * index];
+    return (option < options.length()) ? option : 0;
+}
+
+double UAVObjectField::toDouble(const quint8 *objData, quint32 index)
+{
+    if (index >= numElements) {
+        return 0;
+    }
+
+    const quint8 *element = &objData[offset + numBytesPerElement * index];
+    switch (type) {
+    case INT8:
+        return *(const qint8 *)element;
+
+    case INT16:
+    {
+        qint16 tmpint16;
+        memcpy(&tmpint16, element, sizeof(tmpint16));
+        return tmpint16;
+    }
+    case INT32:
+    {
+        qint32 tmpint32;
+        memcpy(&tmpint32, element, sizeof(tmpint32));
+        return tmpint32;
+    }
+    case UINT8:
+        return *element;
+
+    case UINT16:
+    {
+        quint16 tmpuint16;
+        memcpy(&tmpuint16, element, sizeof(tmpuint16));
+        return tmpuint16;
+    }
+    case UINT32:
+    {
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, element, sizeof(tmpuint32));
+        return tmpuint32;
+    }
+    case FLOAT32:
+    {
+        float tmpfloat;
+        memcpy(&tmpfloat, element, sizeof(tmpfloat));
+        return tmpfloat;
+    }
+    case ENUM:
+        return options.at((*element < options.length()) ? *element : 0).toDouble();
+
+    case BITFIELD:
+        return (objData[offset + numBytesPerElement * (index / 8)] >> (index % 8)) & 1;
+
+    case STRING:
+        break;
+    }
+    return 0;
+}
@@ -73,6 +73,11 @@ public:
     void setValue(const QVariant & data, quint32 index = 0);
     double getDouble(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
+    void getDoubles(double *values);
+    quint8 getEnumIndex(quint32 index = 0);
+    void setEnumIndex(int value, quint32 index = 0);
+    double getDouble(const QByteArray & snapshot, quint32 index = 0);
+    quint8 getEnumIndex(const QByteArray & snapshot, quint32 index = 0);
     quint32 getDataOffset();
     quint32 getNumBytes();
     bool isNumeric();
@@ -107,6 +112,8 @@ protected:
     UAVObject *obj;
     QMap<quint32, QList<LimitStruct> > elementLimits;
     void clear();
+    double toDouble(const quint8 *objData, quint32 index);
+    quint8 toEnumIndex(const quint8 *objData, quint32 index);
     void constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
     void limitsInitialize(const QString &limits);
 };
@@ -34,13 +34,79 @@
  * Constructor
  */
 UAVObjectManager::UAVObjectManager()
+{}
+
+UAVObjectManager::~UAVObjectManager()
+{}
+
+/**
+ * Connect a receiver to the updates of an object, at a limited rate.
+ * Updates arriving faster than \a maxRateHz are coalesced, the receiver is then
+ * called once per interval and is expected to read the latest value of the
+ * object. All receivers asking for the same rate share the same notifications.
+ * Receivers are unsubscribed when they are destroyed.
+ */
+void UAVObjectManager::subscribe(UAVObject *obj, const QObject *receiver, const char *method, int maxRateHz)
 {
-    mutex = new QMutex(QMutex::Recursive);
+    QMutexLocker locker(&subscriptionMutex);
+
+    int interval = 1000 / qBound(1, maxRateHz, 1000);
+    QPair<UAVObject *, int> key(obj, interval);
+    UAVObjectSubscription *subscription = subscriptions.value(key);
+
+    if (!subscription) {
+        subscription = new UAVObjectSubscription(obj, interval);
+        subscription->moveToThread(thread());
+        subscriptions.insert(key, subscription);
+    }
+    connect(subscription, SIGNAL(objectUpdated(UAVObject *)), receiver, method, Qt::UniqueConnection);
+    // destroyed is emitted on the receiver's thread, clean up right away
+    connect(receiver, SIGNAL(destroyed(QObject *)), this, SLOT(receiverDestroyed(QObject *)),
+            (Qt::ConnectionType)(Qt::DirectConnection | Qt::UniqueConnection));
 }
 
-UAVObjectManager::~UAVObjectManager()
+/**
+ * Disconnect a receiver from all the subscriptions it has on an object.
+ */
+void UAVObjectManager::unsubscribe(UAVObject *obj, const QObject *receiver)
+{
+    QMutexLocker locker(&subscriptionMutex);
+
+    removeReceiver(obj, receiver);
+}
+
+/**
+ * Disconnect a receiver from all its subscriptions.
+ */
+void UAVObjectManager::unsubscribe(const QObject *receiver)
+{
+    QMutexLocker locker(&subscriptionMutex);
+
+    removeReceiver(NULL, receiver);
+}
+
+void UAVObjectManager::receiverDestroyed(QObject *receiver)
+{
+    unsubscribe(receiver);
+}
+
+/**
+ * Disconnect a receiver from the subscriptions on an object, or on all objects if obj is NULL.
+ * Subscriptions left without receivers are deleted. Called with subscriptionMutex held.
+ */
+void UAVObjectManager::removeReceiver(UAVObject *obj, const QObject *receiver)
 {
-    delete mutex;
+    QMutableHashIterator<QPair<UAVObject *, int>, UAVObjectSubscription *> it(subscriptions);
+    while (it.hasNext()) {
+        it.next();
+        if (!obj || it.key().first == obj) {
+            it.value()->disconnect(receiver);
+            if (!it.value()->hasReceivers()) {
+                it.value()->deleteLater();
+                it.remove();
+            }
+        }
+    }
 }
 
 /**
@@ -51,57 +117,78 @@ UAVObjectManager::~UAVObjectManager()
  */
 bool UAVObjectManager::registerObject(UAVDataObject *obj)
 {
-    QMutexLocker locker(mutex);
+    QList<UAVObject *> newObjects;
+    QList<UAVObject *> newInstances;
+    bool registered;
+
+    {
+        QWriteLocker locker(&lock);
+        registered = addInstance(obj, newObjects, newInstances);
+    }
+
+    // Signals are emitted once the registry is unlocked, receivers can look up objects
+    foreach(UAVObject * newObj, newObjects) {
+        emit newObject(newObj);
+    }
+    foreach(UAVObject * instObj, newInstances) {
+        getObject(instObj->getObjID())->emitNewInstance(instObj);
+        emit newInstance(instObj);
+    }
+    return registered;
+}
 
+/**
+ * Helper function for registerObject(), must be called with the registry locked for writing.
+ * The objects and instances to announce are appended to \a newObjects and \a newInstances.
+ */
+bool UAVObjectManager::addInstance(UAVDataObject *obj, QList<UAVObject *> &newObjects, QList<UAVObject *> &newInstances)
+{
     // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0 && objects[objidx][0]->getObjID() == obj->getObjID()) {
-            // Check if this is a single instance object, if yes we can not add a new instance
-            if (obj->isSingleInstance()) {
-                return false;
-            }
-            // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
-            // There is a single metaobject for all object instances of this type, so no need to create a new one
-            // Get object type metaobject from existing instance
-            UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
-            if (refObj == NULL) {
-                return false;
-            }
-            UAVMetaObject *mobj = refObj->getMetaObject();
-            // If the instance ID is specified and not at the default value (0) then we need to make sure
-            // that there are no gaps in the instance list. If gaps are found then then additional instances
-            // will be created.
-            if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
-                        // Instance conflict, do not add
-                        return false;
-                    }
-                }
-                // Check if there are any gaps between the requested instance ID and the ones in the list,
-                // if any then create the missing instances.
-                for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
-                    UAVDataObject *cobj = obj->clone(instidx);
-                    cobj->initialize(mobj);
-                    objects[objidx].append(cobj);
-                    getObject(cobj->getObjID())->emitNewInstance(cobj);
-                    emit newInstance(cobj);
+    int objidx = typeIndex(NULL, obj->getObjID());
+
+    if (objidx >= 0) {
+        // Check if this is a single instance object, if yes we can not add a new instance
+        if (obj->isSingleInstance()) {
+            return false;
+        }
+        // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
+        // There is a single metaobject for all object instances of this type, so no need to create a new one
+        // Get object type metaobject from existing instance
+        UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+        if (refObj == NULL) {
+            return false;
+        }
+        UAVMetaObject *mobj = refObj->getMetaObject();
+        // If the instance ID is specified and not at the default value (0) then we need to make sure
+        // that there are no gaps in the instance list. If gaps are found then then additional instances
+        // will be created.
+        if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
+            for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
+                if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
+                    // Instance conflict, do not add
+                    return false;
                 }
-                // Finally, initialize the actual object instance
-                obj->initialize(mobj);
-            } else if (obj->getInstID() == 0) {
-                // Assign the next available ID and initialize the object instance
-                obj->initialize(objects[objidx].length(), mobj);
-            } else {
-                return false;
             }
-            // Add the actual object instance in the list
-            objects[objidx].append(obj);
-            getObject(obj->getObjID())->emitNewInstance(obj);
-            emit newInstance(obj);
-            return true;
+            // Check if there are any gaps between the requested instance ID and the ones in the list,
+            // if any then create the missing instances.
+            for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
+                UAVDataObject *cobj = obj->clone(instidx);
+                cobj->initialize(mobj);
+                appendInstance(objidx, cobj);
+                newInstances.append(cobj);
+            }
+            // Finally, initialize the actual object instance
+            obj->initialize(mobj);
+        } else if (obj->getInstID() == 0) {
+            // Assign the next available ID and initialize the object instance
+            obj->initialize(objects[objidx].length(), mobj);
+        } else {
+            return false;
         }
+        // Add the actual object instance in the list
+        appendInstance(objidx, obj);
+        newInstances.append(obj);
+        return true;
     }
     // If this point is reached then this is the first time this object type (ID) is added in the list
     // create a new list of the instances, add in the object collection and create the object's metaobject
@@ -114,16 +201,59 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
     // Add to list
     addObject(obj);
     addObject(mobj);
+    newObjects.append(obj);
+    newObjects.append(mobj);
     return true;
 }
 
+/**
+ * Add a new object type, must be called with the registry locked for writing.
+ */
 void UAVObjectManager::addObject(UAVObject *obj)
 {
     // Add to list
     QList<UAVObject *> list;
     list.append(obj);
+    objectIdIndex.insert(obj->getObjID(), objects.length());
+    objectNameIndex.insert(obj->getName(), objects.length());
     objects.append(list);
-    emit newObject(obj);
+
+    // and to the typed views
+    UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
+    if (dobj != NULL) {
+        QList<UAVDataObject *> dlist;
+        dlist.append(dobj);
+        dataObjectIndex.insert(obj->getObjID(), dataObjects.length());
+        dataObjects.append(dlist);
+    }
+    UAVMetaObject *mobj = dynamic_cast<UAVMetaObject *>(obj);
+    if (mobj != NULL) {
+        QList<UAVMetaObject *> mlist;
+        mlist.append(mobj);
+        metaObjects.append(mlist);
+    }
+}
+
+/**
+ * Add an instance of a known data object type, must be called with the registry locked for writing.
+ */
+void UAVObjectManager::appendInstance(int objidx, UAVDataObject *obj)
+{
+    objects[objidx].append(obj);
+    dataObjects[dataObjectIndex.value(obj->getObjID())].append(obj);
+}
+
+/**
+ * Position of an object type in the registry, by name or by ID if name is NULL.
+ * Must be called with the registry locked.
+ * @returns The index in objects or -1 if the object type is unknown
+ */
+int UAVObjectManager::typeIndex(const QString *name, quint32 objId) const
+{
+    if (name != NULL) {
+        return objectNameIndex.value(*name, -1);
+    }
+    return objectIdIndex.value(objId, -1);
 }
 
 /**
@@ -132,7 +262,7 @@ void UAVObjectManager::addObject(UAVObject *obj)
  */
 QList< QList<UAVObject *> > UAVObjectManager::getObjects()
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(&lock);
 
     return objects;
 }
@@ -142,32 +272,9 @@ QList< QList<UAVObject *> > UAVObjectManager::getObjects()
  */
 QList< QList<UAVDataObject *> > UAVObjectManager::getDataObjects()
 {
-    QMutexLocker locker(mutex);
-
-    QList< QList<UAVDataObject *> > dObjects;
-
-    // Go through objects and copy to new list when types match
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        if (objects[objidx].length() > 0) {
-            // Check type
-            UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
-            if (obj != NULL) {
-                // Create instance list
-                QList<UAVDataObject *> list;
-                // Go through instances and cast them to UAVDataObject, then add to list
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    obj = dynamic_cast<UAVDataObject *>(objects[objidx][instidx]);
-                    if (obj != NULL) {
-                        list.append(obj);
-                    }
-                }
-                // Append to object list
-                dObjects.append(list);
-            }
-        }
-    }
-    // Done
-    return dObjects;
+    QReadLocker locker(&lock);
+
+    return dataObjects;
 }
 
 /**
@@ -175,32 +282,9 @@ QList< QList<UAVDataObject *> > UAVObjectManager::getDataObjects()
  */
 QList <QList<UAVMetaObject *> > UAVObjectManager::getMetaObjects()
 {
-    QMutexLocker locker(mutex);
-
-    QList< QList<UAVMetaObject *> > mObjects;
-
-    // Go through objects and copy to new list when types match
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        if (objects[objidx].length() > 0) {
-            // Check type
-            UAVMetaObject *obj = dynamic_cast<UAVMetaObject *>(objects[objidx][0]);
-            if (obj != NULL) {
-                // Create instance list
-                QList<UAVMetaObject *> list;
-                // Go through instances and cast them to UAVMetaObject, then add to list
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    obj = dynamic_cast<UAVMetaObject *>(objects[objidx][instidx]);
-                    if (obj != NULL) {
-                        list.append(obj);
-                    }
-                }
-                // Append to object list
-                mObjects.append(list);
-            }
-        }
-    }
-    // Done
-    return mObjects;
+    QReadLocker locker(&lock);
+
+    return metaObjects;
 }
 
 /**
@@ -226,23 +310,25 @@ UAVObject *UAVObjectManager::getObject(quint32 objId, quint32 instId)
  */
 UAVObject *UAVObjectManager::getObject(const QString *name, quint32 objId, quint32 instId)
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(&lock);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == instId) {
-                        return objects[objidx][instidx];
-                    }
-                }
-            }
+    int objidx = typeIndex(name, objId);
+
+    if (objidx < 0) {
+        // qWarning("UAVObjectManager::getObject: Object not found.  Probably a bug or mismatched GCS/flight versions.");
+        return NULL;
+    }
+    const QList<UAVObject *> &instances = objects.at(objidx);
+    // Instances are registered without gaps, so the instance ID is normally its position
+    if (instId < (quint32)instances.length() && instances.at(instId)->getInstID() == instId) {
+        return instances.at(instId);
+    }
+    // Look for the requested instance ID
+    for (int instidx = 0; instidx < instances.length(); ++instidx) {
+        if (instances.at(instidx)->getInstID() == instId) {
+            return instances.at(instidx);
         }
     }
-    // qWarning("UAVObjectManager::getObject: Object not found.  Probably a bug or mismatched GCS/flight versions.");
     // If this point is reached then the requested object could not be found
     return NULL;
 }
@@ -268,19 +354,15 @@ QList<UAVObject *> UAVObjectManager::getObjectInstances(quint32 objId)
  */
 QList<UAVObject *> UAVObjectManager::getObjectInstances(const QString *name, quint32 objId)
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(&lock);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx];
-            }
-        }
+    int objidx = typeIndex(name, objId);
+
+    if (objidx < 0) {
+        // If this point is reached then the requested object could not be found
+        return QList<UAVObject *>();
     }
-    // If this point is reached then the requested object could not be found
-    return QList<UAVObject *>();
+    return objects.at(objidx);
 }
 
 /**
@@ -362,17 +444,13 @@ void UAVObjectManager::fromJson(const QJsonObject &jsonObject, QList<UAVObject *
  */
 qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 {
-    QMutexLocker locker(mutex);
+    QReadLocker locker(&lock);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx].length();
-            }
-        }
+    int objidx = typeIndex(name, objId);
+
+    if (objidx < 0) {
+        // If this point is reached then the requested object could not be found
+        return -1;
     }
-    // If this point is reached then the requested object could not be found
-    return -1;
+    return objects.at(objidx).length();
 }
@@ -32,9 +32,13 @@
 #include "uavobject.h"
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
+#include "uavobjectsubscription.h"
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QPair>
 #include <QJsonObject>
 
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
@@ -61,17 +65,42 @@ public:
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
     void fromJson(const QJsonObject &jsonObject, QList<UAVObject *> *updatedObjects = NULL);
 
+    // Coalesced updates: method is invoked at most maxRateHz times per second and reads the latest value
+    void subscribe(UAVObject *obj, const QObject *receiver, const char *method, int maxRateHz);
+    void unsubscribe(UAVObject *obj, const QObject *receiver);
+    void unsubscribe(const QObject *receiver);
+
 signals:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
 
+private slots:
+    void receiverDestroyed(QObject *receiver);
+
 private:
     static const quint32 MAX_INSTANCES = 1000;
 
+    // Instances grouped by object type, in registration order
     QList< QList<UAVObject *> > objects;
-    QMutex *mutex;
+    // Typed views of the above, kept up to date on registration
+    QList< QList<UAVDataObject *> > dataObjects;
+    QList< QList<UAVMetaObject *> > metaObjects;
+    // Position of each object type in objects and dataObjects
+    QHash<quint32, int> objectIdIndex;
+    QHash<QString, int> objectNameIndex;
+    QHash<quint32, int> dataObjectIndex;
+    // Lookups only need read access, registration is rare
+    QReadWriteLock lock;
+
+    // Subscriptions are shared by all receivers asking for the same object and rate
+    QHash<QPair<UAVObject *, int>, UAVObjectSubscription *> subscriptions;
+    QMutex subscriptionMutex;
 
+    void removeReceiver(UAVObject *obj, const QObject *receiver);
+    bool addInstance(UAVDataObject *obj, QList<UAVObject *> &newObjects, QList<UAVObject *> &newInstances);
     void addObject(UAVObject *obj);
+    void appendInstance(int objidx, UAVDataObject *obj);
+    int typeIndex(const QString *name, quint32 objId) const;
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
     QList<UAVObject *> getObjectInstances(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
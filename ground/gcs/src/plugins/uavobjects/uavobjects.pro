@@ -13,6 +13,7 @@ HEADERS += \
     uavobject.h \
     uavmetaobject.h \
     uavobjectmanager.h \
+    uavobjectsubscription.h \
     uavdataobject.h \
     uavobjectfield.h \
     uavobjectsinit.h \
@@ -22,6 +23,7 @@ SOURCES += \
     uavobject.cpp \
     uavmetaobject.cpp \
     uavobjectmanager.cpp \
+    uavobjectsubscription.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
     uavobjectsplugin.cpp
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsubscription.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectsubscription.h"
+
+UAVObjectSubscription::UAVObjectSubscription(UAVObject *obj, int intervalMs) :
+    m_object(obj), m_pending(false)
+{
+    // the timer is a child so it follows the subscription to its thread
+    m_timer = new QTimer(this);
+    m_timer->setInterval(intervalMs);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updated()));
+}
+
+bool UAVObjectSubscription::hasReceivers() const
+{
+    return receivers(SIGNAL(objectUpdated(UAVObject *))) > 0;
+}
+
+void UAVObjectSubscription::updated()
+{
+    if (m_timer->isActive()) {
+        // within the interval, only remember there is something new
+        m_pending = true;
+    } else {
+        emit objectUpdated(m_object);
+        m_timer->start();
+    }
+}
+
+void UAVObjectSubscription::timeout()
+{
+    if (m_pending) {
+        m_pending = false;
+        emit objectUpdated(m_object);
+    } else {
+        // no update during the last interval, forward the next one right away
+        m_timer->stop();
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsubscription.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTSUBSCRIPTION_H
+#define UAVOBJECTSUBSCRIPTION_H
+
+#include "uavobjects_global.h"
+#include "uavobject.h"
+
+#include <QObject>
+#include <QTimer>
+
+/**
+ * Rate limited view of the updates of one object.
+ * The first update is forwarded right away, further updates within the
+ * interval are coalesced into a single objectUpdated signal at its end.
+ * Subscriptions are created by UAVObjectManager::subscribe().
+ */
+class UAVOBJECTS_EXPORT UAVObjectSubscription : public QObject {
+    Q_OBJECT
+
+public:
+    UAVObjectSubscription(UAVObject *obj, int intervalMs);
+
+    UAVObject *object() const
+    {
+        return m_object;
+    }
+    int interval() const
+    {
+        return m_timer->interval();
+    }
+    bool hasReceivers() const;
+
+signals:
+    void objectUpdated(UAVObject *obj);
+
+private slots:
+    void updated();
+    void timeout();
+
+private:
+    UAVObject *m_object;
+    QTimer *m_timer;
+    bool m_pending;
+};
+
+#endif // UAVOBJECTSUBSCRIPTION_H
@@ -1,7 +1,7 @@
 TEMPLATE = lib
 TARGET = UAVSettingsImportExport
 
-QT += widgets xml
+QT += widgets xml concurrent
 
 DEFINES += UAVSETTINGSIMPORTEXPORT_LIBRARY
 
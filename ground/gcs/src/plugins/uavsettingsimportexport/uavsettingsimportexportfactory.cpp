@@ -51,6 +51,9 @@
 #include <QFileDialog>
 #include <QMessageBox>
 
+// parsing and formatting run on a worker thread
+#include <QtConcurrent/QtConcurrentRun>
+
 UAVSettingsImportExportFactory::~UAVSettingsImportExportFactory()
 {
     // Do nothing
@@ -88,11 +91,18 @@ UAVSettingsImportExportFactory::UAVSettingsImportExportFactory(QObject *parent)
     cmd->action()->setText(tr("Export UAV Data..."));
     ac->addAction(cmd, Core::Constants::G_HELP_HELP);
     connect(cmd->action(), SIGNAL(triggered(bool)), this, SLOT(exportUAVData()));
+
+    connect(&m_importWatcher, SIGNAL(finished()), this, SLOT(importFinished()));
+    connect(&m_exportWatcher, SIGNAL(finished()), this, SLOT(exportFinished()));
 }
 
 // Slot called by the menu manager on user action
 void UAVSettingsImportExportFactory::importUAVSettings()
 {
+    if (m_importWatcher.isRunning()) {
+        return;
+    }
+
     // ask for file name
     QString fileName;
     QString filters = tr("UAVObjects XML files (*.uav);; XML files (*.xml)");
@@ -104,72 +114,77 @@ void UAVSettingsImportExportFactory::importUAVSettings()
 
     // Now open the file
     QFile file(fileName);
-    QDomDocument doc("UAVObjects");
     file.open(QFile::ReadOnly | QFile::Text);
-    if (!doc.setContent(file.readAll())) {
-        QMessageBox msgBox;
-        msgBox.setText(tr("File Parsing Failed."));
-        msgBox.setInformativeText(tr("This file is not a correct XML file"));
-        msgBox.setStandardButtons(QMessageBox::Ok);
-        msgBox.exec();
-        return;
-    }
+    QByteArray content = file.readAll();
     file.close();
 
-    // find the root of settings subtree
     emit importAboutToBegin();
     qDebug() << "Import about to begin";
 
+    // Parse the file and compare it with the current objects in the background,
+    // importFinished() applies the result
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    m_importWatcher.setFuture(QtConcurrent::run(&UAVSettingsImportExportFactory::parseSettings, content, objManager));
+}
+
+// Runs on a worker thread: reads the settings file and applies it to copies of the objects
+UAVSettingsImportExportFactory::ImportResult UAVSettingsImportExportFactory::parseSettings(const QByteArray &content, UAVObjectManager *objManager)
+{
+    ImportResult result;
+    QDomDocument doc("UAVObjects");
+
+    if (!doc.setContent(content)) {
+        result.status = ImportResult::PARSE_ERROR;
+        return result;
+    }
+
+    // find the root of settings subtree
     QDomElement root = doc.documentElement();
     if (root.tagName() == "uavobjects") {
         root = root.firstChildElement("settings");
     }
     if (root.isNull() || (root.tagName() != "settings")) {
-        QMessageBox msgBox;
-        msgBox.setText(tr("Wrong file contents"));
-        msgBox.setInformativeText(tr("This file does not contain correct UAVSettings"));
-        msgBox.setStandardButtons(QMessageBox::Ok);
-        msgBox.exec();
-        return;
+        result.status = ImportResult::WRONG_CONTENTS;
+        return result;
     }
-
-    // We are now ok: setup the import summary dialog & update it as we
-    // go along.
-    ImportSummaryDialog swui((QWidget *)Core::ICore::instance()->mainWindow());
-
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    swui.show();
+    result.status = ImportResult::OK;
 
     QDomNode node = root.firstChild();
     while (!node.isNull()) {
         QDomElement e = node.toElement();
         if (e.tagName() == "object") {
             // - Read each object
-            QString uavObjectName = e.attribute("name");
+            ImportedObject imported;
+            imported.name    = e.attribute("name");
+            imported.changed = false;
             uint uavObjectID = e.attribute("id").toUInt(NULL, 16);
 
             // Sanity Check:
-            UAVObject *obj   = objManager->getObject(uavObjectName);
+            UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(imported.name));
             if (obj == NULL) {
                 // This object is unknown!
-                qDebug() << "Object unknown:" << uavObjectName << uavObjectID;
-                swui.addLine(uavObjectName, "Error (Object unknown)", false);
+                qDebug() << "Object unknown:" << imported.name << uavObjectID;
+                imported.status = ImportedObject::UNKNOWN_OBJECT;
             } else {
-                // - Update each field
-                // - Issue and "updated" command
+                // - Update each field of a copy of the current object
+                // - Compare the result with the current object
+                QByteArray current = obj->getDataSnapshot();
+                UAVDataObject *copy = obj->clone(obj->getInstID());
+                copy->unpack((const quint8 *)current.constData());
+
                 bool error     = false;
                 bool setError  = false;
                 QDomNode field = node.firstChild();
                 while (!field.isNull()) {
                     QDomElement f = field.toElement();
                     if (f.tagName() == "field") {
-                        UAVObjectField *uavfield = obj->getField(f.attribute("name"));
+                        UAVObjectField *uavfield = copy->getField(f.attribute("name"));
                         if (uavfield) {
                             QStringList list = f.attribute("values").split(",");
                             if (list.length() == 1) {
                                 if (false == uavfield->checkValue(f.attribute("values"))) {
-                                    qDebug() << "checkValue returned false on: " << uavObjectName << f.attribute("values");
+                                    qDebug() << "checkValue returned false on: " << imported.name << f.attribute("values");
                                     setError = true;
                                 } else {
                                     uavfield->setValue(f.attribute("values"));
@@ -177,10 +192,9 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                             } else {
                                 // This is an enum:
                                 int i = 0;
-                                QStringList list = f.attribute("values").split(",");
                                 foreach(QString element, list) {
                                     if (false == uavfield->checkValue(element, i)) {
-                                        qDebug() << "checkValue(list) returned false on: " << uavObjectName << list;
+                                        qDebug() << "checkValue(list) returned false on: " << imported.name << list;
                                         setError = true;
                                     } else {
                                         uavfield->setValue(element, i);
@@ -194,33 +208,165 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                     }
                     field = field.nextSibling();
                 }
-                obj->updated();
+                imported.data    = copy->getDataSnapshot();
+                imported.changed = (imported.data != current);
+                delete copy;
 
                 if (error) {
-                    swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
+                    imported.status = ImportedObject::UNKNOWN_FIELD;
                 } else if (uavObjectID != obj->getObjID()) {
-                    qDebug() << "Mismatch for Object " << uavObjectName << uavObjectID << " - " << obj->getObjID();
-                    swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
+                    qDebug() << "Mismatch for Object " << imported.name << uavObjectID << " - " << obj->getObjID();
+                    imported.status = ImportedObject::ID_MISMATCH;
                 } else if (setError) {
-                    swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
+                    imported.status = ImportedObject::INVALID_VALUE;
                 } else {
-                    swui.addLine(uavObjectName, "OK", true);
+                    imported.status = ImportedObject::OK;
                 }
             }
+            result.objects.append(imported);
         }
         node = node.nextSibling();
     }
+    return result;
+}
+
+// Called once the settings file has been parsed, only changed objects are updated and uploaded
+void UAVSettingsImportExportFactory::importFinished()
+{
+    ImportResult result = m_importWatcher.result();
+
+    if (result.status == ImportResult::PARSE_ERROR) {
+        QMessageBox msgBox;
+        msgBox.setText(tr("File Parsing Failed."));
+        msgBox.setInformativeText(tr("This file is not a correct XML file"));
+        msgBox.setStandardButtons(QMessageBox::Ok);
+        msgBox.exec();
+        return;
+    }
+    if (result.status == ImportResult::WRONG_CONTENTS) {
+        QMessageBox msgBox;
+        msgBox.setText(tr("Wrong file contents"));
+        msgBox.setInformativeText(tr("This file does not contain correct UAVSettings"));
+        msgBox.setStandardButtons(QMessageBox::Ok);
+        msgBox.exec();
+        return;
+    }
+
+    // We are now ok: setup the import summary dialog & update it as we
+    // go along.
+    ImportSummaryDialog swui((QWidget *)Core::ICore::instance()->mainWindow());
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    swui.show();
+
+    foreach(const ImportedObject &imported, result.objects) {
+        if (imported.status == ImportedObject::UNKNOWN_OBJECT) {
+            swui.addLine(imported.name, "Error (Object unknown)", false);
+            continue;
+        }
+
+        QString text;
+        bool status = true;
+        switch (imported.status) {
+        case ImportedObject::UNKNOWN_FIELD:
+            text = "Warning (Object field unknown)";
+            break;
+        case ImportedObject::ID_MISMATCH:
+            text = "Warning (ObjectID mismatch)";
+            break;
+        case ImportedObject::INVALID_VALUE:
+            text   = "Warning (Objects field value(s) invalid)";
+            status = false;
+            break;
+        default:
+            text = "OK";
+            break;
+        }
+
+        UAVObject *obj = objManager->getObject(imported.name);
+        if (imported.changed && obj && obj->setDataSnapshot(imported.data)) {
+            // - Issue and "updated" command
+            obj->updated();
+            swui.addLine(imported.name, text, status);
+        } else {
+            // Nothing to upload or to save
+            swui.addLine(imported.name, (imported.status == ImportedObject::OK) ? QString("Unchanged") : text + ", unchanged", false);
+        }
+    }
     qDebug() << "End import";
+    emit importEnded();
     swui.exec();
 }
 
-// Create an XML document from UAVObject database
-QString UAVSettingsImportExportFactory::createXMLDocument(const enum storedData what, const bool fullExport)
+// Read the version info and a copy of the objects to export
+UAVSettingsImportExportFactory::ExportData UAVSettingsImportExportFactory::collectExportData(const enum storedData what)
 {
-    // generate an XML first (used for all export formats as a formatted data source)
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    ExportData exportData;
+
+    // hardware, firmware and GCS version info
+    UAVObjectUtilManager *utilMngr = pm->getObject<UAVObjectUtilManager>();
+    deviceDescriptorStruct board   = utilMngr->getBoardDescriptionStruct();
+
+    exportData.hardware["type"]     = QString().setNum(board.boardType, 16);
+    exportData.hardware["revision"] = QString().setNum(board.boardRevision, 16);
+    exportData.hardware["serial"]   = QString(utilMngr->getBoardCPUSerial().toHex());
+
+    QString uavo = board.uavoHash.toHex();
+    exportData.firmware["tag"]  = board.gitTag;
+    exportData.firmware["date"] = board.gitDate;
+    exportData.firmware["hash"] = board.gitHash;
+    exportData.firmware["uavo"] = uavo.left(8);
+
+    exportData.gcs["tag"]  = VersionInfo::tagOrBranch() + VersionInfo::dirty();
+    exportData.gcs["date"] = VersionInfo::dateTime();
+    exportData.gcs["hash"] = VersionInfo::hash().left(8);
+    exportData.gcs["uavo"] = VersionInfo::uavoHash().left(8);
+
+    // copy the data of the objects, the XML is created from the copies
+    QList< QList<UAVDataObject *> > objList = objManager->getDataObjects();
+    foreach(QList<UAVDataObject *> list, objList) {
+        foreach(UAVDataObject * obj, list) {
+            if (((what == Settings) && obj->isSettingsObject()) ||
+                ((what == Data) && !obj->isSettingsObject()) ||
+                (what == Both)) {
+                exportData.objects.append(obj);
+                exportData.snapshots.append(obj->getDataSnapshot());
+            }
+        }
+    }
+    return exportData;
+}
 
+static void setAttributes(QDomElement &element, const QMap<QString, QString> &attributes)
+{
+    for (QMap<QString, QString>::const_iterator it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
+        element.setAttribute(it.key(), it.value());
+    }
+}
+
+// Same text as field->getValue(index).toString(), but read from an object data copy
+static QString fieldValueToString(UAVObjectField *field, const QByteArray &snapshot, quint32 index)
+{
+    switch (field->getType()) {
+    case UAVObjectField::ENUM:
+    {
+        int option = field->getEnumIndex(snapshot, index);
+        return (option < field->getOptions().length()) ? field->getOptions().at(option) : QString::number(option);
+    }
+    case UAVObjectField::FLOAT32:
+        return QVariant((float)field->getDouble(snapshot, index)).toString();
+
+    default:
+        return QString::number((qint64)field->getDouble(snapshot, index));
+    }
+}
+
+// Create an XML document from UAVObject database, can run on a worker thread
+QString UAVSettingsImportExportFactory::createXMLDocument(const enum storedData what, const ExportData &exportData, const bool fullExport)
+{
     // create an XML root
     QDomDocument doc("UAVObjects");
     QDomElement root = doc.createElement("uavobjects");
@@ -231,28 +377,16 @@ QString UAVSettingsImportExportFactory::createXMLDocument(const enum storedData
     QDomElement versionInfo = doc.createElement("version");
     root.appendChild(versionInfo);
 
-    UAVObjectUtilManager *utilMngr = pm->getObject<UAVObjectUtilManager>();
-    deviceDescriptorStruct board   = utilMngr->getBoardDescriptionStruct();
-
     QDomElement hw = doc.createElement("hardware");
-    hw.setAttribute("type", QString().setNum(board.boardType, 16));
-    hw.setAttribute("revision", QString().setNum(board.boardRevision, 16));
-    hw.setAttribute("serial", QString(utilMngr->getBoardCPUSerial().toHex()));
+    setAttributes(hw, exportData.hardware);
     versionInfo.appendChild(hw);
 
     QDomElement fw = doc.createElement("firmware");
-    QString uavo   = board.uavoHash.toHex();
-    fw.setAttribute("tag", board.gitTag);
-    fw.setAttribute("date", board.gitDate);
-    fw.setAttribute("hash", board.gitHash);
-    fw.setAttribute("uavo", uavo.left(8));
+    setAttributes(fw, exportData.firmware);
     versionInfo.appendChild(fw);
 
     QDomElement gcs = doc.createElement("gcs");
-    gcs.setAttribute("tag", VersionInfo::tagOrBranch() + VersionInfo::dirty());
-    gcs.setAttribute("date", VersionInfo::dateTime());
-    gcs.setAttribute("hash", VersionInfo::hash().left(8));
-    gcs.setAttribute("uavo", VersionInfo::uavoHash().left(8));
+    setAttributes(gcs, exportData.gcs);
     versionInfo.appendChild(gcs);
 
     // create settings and/or data elements
@@ -272,73 +406,89 @@ QString UAVSettingsImportExportFactory::createXMLDocument(const enum storedData
         break;
     }
 
-    // iterate over settings objects
-    QList< QList<UAVDataObject *> > objList = objManager->getDataObjects();
-    foreach(QList<UAVDataObject *> list, objList) {
-        foreach(UAVDataObject * obj, list) {
-            if (((what == Settings) && obj->isSettingsObject()) ||
-                ((what == Data) && !obj->isSettingsObject()) ||
-                (what == Both)) {
-                // add each object to the XML
-                QDomElement o = doc.createElement("object");
-                o.setAttribute("name", obj->getName());
-                o.setAttribute("id", QString("0x") + QString().setNum(obj->getObjID(), 16).toUpper());
-                if (fullExport) {
-                    QDomElement d = doc.createElement("description");
-                    QDomText t    = doc.createTextNode(obj->getDescription().remove("@Ref ", Qt::CaseInsensitive));
-                    d.appendChild(t);
-                    o.appendChild(d);
-                }
+    // iterate over the collected objects
+    for (int i = 0; i < exportData.objects.length(); ++i) {
+        UAVDataObject *obj = exportData.objects.at(i);
+        const QByteArray &snapshot = exportData.snapshots.at(i);
+
+        // add each object to the XML
+        QDomElement o = doc.createElement("object");
+        o.setAttribute("name", obj->getName());
+        o.setAttribute("id", QString("0x") + QString().setNum(obj->getObjID(), 16).toUpper());
+        if (fullExport) {
+            QDomElement d = doc.createElement("description");
+            QDomText t    = doc.createTextNode(obj->getDescription().remove("@Ref ", Qt::CaseInsensitive));
+            d.appendChild(t);
+            o.appendChild(d);
+        }
 
-                // iterate over fields
-                QList<UAVObjectField *> fieldList = obj->getFields();
+        // iterate over fields
+        QList<UAVObjectField *> fieldList = obj->getFields();
 
-                foreach(UAVObjectField * field, fieldList) {
-                    QDomElement f = doc.createElement("field");
+        foreach(UAVObjectField * field, fieldList) {
+            QDomElement f = doc.createElement("field");
 
-                    // iterate over values
-                    QString vals;
-                    quint32 nelem = field->getNumElements();
+            // iterate over values
+            QString vals;
+            quint32 nelem = field->getNumElements();
 
-                    for (unsigned int n = 0; n < nelem; ++n) {
-                        vals.append(QString("%1,").arg(field->getValue(n).toString()));
-                    }
-                    vals.chop(1);
-
-                    f.setAttribute("name", field->getName());
-                    f.setAttribute("values", vals);
-                    if (fullExport) {
-                        f.setAttribute("type", field->getTypeAsString());
-                        f.setAttribute("units", field->getUnits());
-                        f.setAttribute("elements", nelem);
-                        if (field->getType() == UAVObjectField::ENUM) {
-                            f.setAttribute("options", field->getOptions().join(","));
-                        }
-                    }
-                    o.appendChild(f);
-                }
-
-                // append to the settings or data element
-                if (obj->isSettingsObject()) {
-                    settings.appendChild(o);
-                } else {
-                    data.appendChild(o);
+            for (unsigned int n = 0; n < nelem; ++n) {
+                vals.append(QString("%1,").arg(fieldValueToString(field, snapshot, n)));
+            }
+            vals.chop(1);
+
+            f.setAttribute("name", field->getName());
+            f.setAttribute("values", vals);
+            if (fullExport) {
+                f.setAttribute("type", field->getTypeAsString());
+                f.setAttribute("units", field->getUnits());
+                f.setAttribute("elements", nelem);
+                if (field->getType() == UAVObjectField::ENUM) {
+                    f.setAttribute("options", field->getOptions().join(","));
                 }
             }
+            o.appendChild(f);
+        }
+
+        // append to the settings or data element
+        if (obj->isSettingsObject()) {
+            settings.appendChild(o);
+        } else {
+            data.appendChild(o);
         }
     }
 
     return doc.toString(4);
 }
 
-// Slot called by the menu manager on user action
-void UAVSettingsImportExportFactory::exportUAVSettings()
+// Runs on a worker thread: formats and saves the collected objects
+bool UAVSettingsImportExportFactory::writeXMLDocument(const QString &fileName, const enum storedData what, const ExportData &exportData, const bool fullExport)
+{
+    QString xml = createXMLDocument(what, exportData, fullExport);
+
+    // save file
+    QFile file(fileName);
+
+    if (file.open(QIODevice::WriteOnly) &&
+        (file.write(xml.toLatin1()) != -1)) {
+        file.close();
+        return true;
+    }
+    return false;
+}
+
+// Ask for a file name and save the objects in the background, exportFinished() reports the result
+void UAVSettingsImportExportFactory::exportToFile(const enum storedData what, const QString &title, const QString &doneText, const QString &errorText)
 {
+    if (m_exportWatcher.isRunning()) {
+        return;
+    }
+
     // ask for file name
     QString fileName;
     QString filters = tr("UAVObjects XML files (*.uav)");
 
-    fileName = QFileDialog::getSaveFileName(0, tr("Save UAVSettings File As"), "", filters);
+    fileName = QFileDialog::getSaveFileName(0, title, "", filters);
     if (fileName.isEmpty()) {
         return;
     }
@@ -351,28 +501,36 @@ void UAVSettingsImportExportFactory::exportUAVSettings()
         fileName.append(".uav");
     }
 
-    // generate an XML first (used for all export formats as a formatted data source)
-    QString xml = createXMLDocument(Settings, fullExport);
+    m_exportFileName  = fileName;
+    m_exportTitle     = (what == Settings) ? tr("UAV Settings Export") : tr("UAV Data Export");
+    m_exportDoneText  = doneText;
+    m_exportErrorText = errorText;
+    m_exportWatcher.setFuture(QtConcurrent::run(&UAVSettingsImportExportFactory::writeXMLDocument,
+                                                fileName, what, collectExportData(what), fullExport));
+}
 
-    // save file
-    QFile file(fileName);
-    if (file.open(QIODevice::WriteOnly) &&
-        (file.write(xml.toLatin1()) != -1)) {
-        file.close();
-    } else {
+void UAVSettingsImportExportFactory::exportFinished()
+{
+    if (!m_exportWatcher.result()) {
         QMessageBox::critical(0,
-                              tr("UAV Settings Export"),
-                              tr("Unable to save settings: ") + fileName,
+                              m_exportTitle,
+                              m_exportErrorText + m_exportFileName,
                               QMessageBox::Ok);
         return;
     }
 
     QMessageBox msgBox;
-    msgBox.setText(tr("Settings saved."));
+    msgBox.setText(m_exportDoneText);
     msgBox.setStandardButtons(QMessageBox::Ok);
     msgBox.exec();
 }
 
+// Slot called by the menu manager on user action
+void UAVSettingsImportExportFactory::exportUAVSettings()
+{
+    exportToFile(Settings, tr("Save UAVSettings File As"), tr("Settings saved."), tr("Unable to save settings: "));
+}
+
 // Slot called by the menu manager on user action
 void UAVSettingsImportExportFactory::exportUAVData()
 {
@@ -385,41 +543,5 @@ void UAVSettingsImportExportFactory::exportUAVData()
         return;
     }
 
-    // ask for file name
-    QString fileName;
-    QString filters = tr("UAVObjects XML files (*.uav)");
-
-    fileName = QFileDialog::getSaveFileName(0, tr("Save UAVData File As"), "", filters);
-    if (fileName.isEmpty()) {
-        return;
-    }
-
-    // If the filename ends with .xml, we will do a full export, otherwise, a simple export
-    bool fullExport = false;
-    if (fileName.endsWith(".xml")) {
-        fullExport = true;
-    } else if (!fileName.endsWith(".uav")) {
-        fileName.append(".uav");
-    }
-
-    // generate an XML first (used for all export formats as a formatted data source)
-    QString xml = createXMLDocument(Both, fullExport);
-
-    // save file
-    QFile file(fileName);
-    if (file.open(QIODevice::WriteOnly) &&
-        (file.write(xml.toLatin1()) != -1)) {
-        file.close();
-    } else {
-        QMessageBox::critical(0,
-                              tr("UAV Data Export"),
-                              tr("Unable to save data: ") + fileName,
-                              QMessageBox::Ok);
-        return;
-    }
-
-    QMessageBox msgBox;
-    msgBox.setText(tr("Data saved."));
-    msgBox.setStandardButtons(QMessageBox::Ok);
-    msgBox.exec();
+    exportToFile(Both, tr("Save UAVData File As"), tr("Data saved."), tr("Unable to save data: "));
 }
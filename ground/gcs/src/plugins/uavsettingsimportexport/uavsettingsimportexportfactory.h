@@ -29,6 +29,11 @@
 #include "uavsettingsimportexport_global.h"
 #include "uavobjectutil/uavobjectutilmanager.h"
 
+#include <QFutureWatcher>
+
+class UAVObjectManager;
+class UAVDataObject;
+
 class UAVSETTINGSIMPORTEXPORT_EXPORT UAVSettingsImportExportFactory : public QObject {
     Q_OBJECT
 
@@ -38,12 +43,49 @@ public:
 
 private:
     enum storedData { Settings, Data, Both };
-    QString createXMLDocument(const enum storedData, const bool fullExport);
+
+    // Object as read from a settings file, applied to a copy of the current object data
+    struct ImportedObject {
+        enum Status { OK, UNKNOWN_OBJECT, UNKNOWN_FIELD, ID_MISMATCH, INVALID_VALUE };
+        QString name;
+        Status  status;
+        QByteArray data;
+        bool    changed;
+    };
+    struct ImportResult {
+        enum Status { OK, PARSE_ERROR, WRONG_CONTENTS };
+        Status  status;
+        QList<ImportedObject> objects;
+    };
+
+    // Everything an export needs, collected on the GUI thread
+    struct ExportData {
+        QMap<QString, QString> hardware;
+        QMap<QString, QString> firmware;
+        QMap<QString, QString> gcs;
+        QList<UAVDataObject *> objects;
+        QList<QByteArray> snapshots;
+    };
+
+    ExportData collectExportData(const enum storedData what);
+    static QString createXMLDocument(const enum storedData what, const ExportData &exportData, const bool fullExport);
+    static bool writeXMLDocument(const QString &fileName, const enum storedData what, const ExportData &exportData, const bool fullExport);
+    static ImportResult parseSettings(const QByteArray &content, UAVObjectManager *objManager);
+    void exportToFile(const enum storedData what, const QString &title, const QString &doneText, const QString &errorText);
+
+    QFutureWatcher<ImportResult> m_importWatcher;
+    QFutureWatcher<bool> m_exportWatcher;
+    QString m_exportFileName;
+    QString m_exportTitle;
+    QString m_exportDoneText;
+    QString m_exportErrorText;
 
 private slots:
     void importUAVSettings();
+    void importFinished();
     void exportUAVSettings();
     void exportUAVData();
+    void exportFinished();
 signals:
     void importAboutToBegin();
     void importEnded();
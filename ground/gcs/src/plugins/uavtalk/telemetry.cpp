@@ -72,6 +72,24 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
     // Setup and start the stats timer
     txErrors  = 0;
     txRetries = 0;
+
+    // Start with a small window and the default timeout until round trips are measured
+    openTransactions = 0;
+    maxWindow    = DEFAULT_TRANSACTION_WINDOW;
+    window       = 2.0;
+    rtt          = REQ_TIMEOUT_MS / 2;
+    rttVariation = REQ_TIMEOUT_MS / 8;
+}
+
+/**
+ * Set the maximum number of acked transactions in flight at the same time
+ */
+void Telemetry::setTransactionWindow(int maxWindow)
+{
+    QMutexLocker locker(mutex);
+
+    this->maxWindow = qMax(maxWindow, 1);
+    window = qMin(window, (double)this->maxWindow);
 }
 
 Telemetry::~Telemetry()
@@ -247,6 +265,13 @@ void Telemetry::transactionCompleted(UAVObject *obj, bool success)
             // We now know tat the flight side knows of this object.
             obj->setIsKnown(true);
 
+            // Only transactions that were not retried give an unambiguous round trip
+            if (!transInfo->retried) {
+                updateRtt(transInfo->sentTime.elapsed());
+            }
+            // Additive increase, one more transaction per window of successes
+            window = qMin(window + 1.0 / window, (double)maxWindow);
+
 #ifdef VERBOSE_TELEMETRY
             qDebug() << "Telemetry - transaction successful for object" << obj->toStringBrief();
 #endif
@@ -281,6 +306,12 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
         ++txRetries;
         --transInfo->retriesRemaining;
 
+        // The link is congested or lossy, halve the window
+        if (!transInfo->retried) {
+            window = qMax(window / 2.0, 1.0);
+        }
+        transInfo->retried = true;
+
         // Retry the transaction
         processObjectTransaction(transInfo);
     } else {
@@ -326,11 +357,13 @@ void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
     if (transInfo->objRequest || transInfo->acked) {
         if (sent) {
             // Start timer if a response is expected
-            transInfo->timer->start(REQ_TIMEOUT_MS);
+            transInfo->sentTime.start();
+            transInfo->timer->start(transactionTimeoutMs());
         } else {
-            // message was not sent, the transaction will not complete and will timeout
-            // there is no need to wait to close the transaction and notify of completion failure
-            // transactionCompleted(transInfo->obj, false);
+            // message was not sent, no response will come and no timer runs
+            // close the transaction now so it does not hold its window slot
+            ++txErrors;
+            transactionCompleted(transInfo->obj, false);
         }
     } else {
         // not transacted, so just close the transaction with no notification of completion
@@ -349,6 +382,16 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
     objInfo.obj   = obj;
     objInfo.event = event;
     objInfo.allInstances = allInstances;
+
+    // An identical event still waiting in the queue will send the latest data as well
+    QQueue<ObjectQueueInfo> &queue = priority ? objPriorityQueue : objQueue;
+    foreach(const ObjectQueueInfo &queued, queue) {
+        if (queued.obj == obj && queued.event == event && queued.allInstances == allInstances) {
+            processObjectQueue();
+            return;
+        }
+    }
+
     if (priority) {
         if (objPriorityQueue.length() < MAX_QUEUE_SIZE) {
             objPriorityQueue.enqueue(objInfo);
@@ -372,21 +415,70 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
 }
 
 /**
- * Process events from the object queue
+ * Process events from the object queue (first the priority and then the regular queue)
+ * Transactions are started as long as the window of outstanding transactions is not full.
  */
 void Telemetry::processObjectQueue()
 {
-    // Get object information from queue (first the priority and then the regular queue)
     ObjectQueueInfo objInfo;
 
-    if (!objPriorityQueue.isEmpty()) {
-        objInfo = objPriorityQueue.dequeue();
-    } else if (!objQueue.isEmpty()) {
-        objInfo = objQueue.dequeue();
-    } else {
-        return;
+    while (dequeueObject(objPriorityQueue, objInfo) || dequeueObject(objQueue, objInfo)) {
+        processQueuedObject(objInfo);
+    }
+}
+
+/**
+ * Take the first event of the queue that can be processed now.
+ * Events needing a transaction wait while the window is full or while a
+ * transaction for the same object is in progress, later events for other
+ * objects can overtake them.
+ */
+bool Telemetry::dequeueObject(QQueue<ObjectQueueInfo> &queue, ObjectQueueInfo &objInfo)
+{
+    for (int i = 0; i < queue.length(); ++i) {
+        const ObjectQueueInfo &queued = queue.at(i);
+        if (!needsTransaction(queued) ||
+            (openTransactions < (int)window && !findTransaction(queued.obj))) {
+            objInfo = queue.takeAt(i);
+            return true;
+        }
     }
+    return false;
+}
+
+/**
+ * Check if an event is sent through a transaction (skip if unpack event)
+ */
+bool Telemetry::needsTransaction(const ObjectQueueInfo &objInfo)
+{
+    UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
+    UAVObject::UpdateMode updateMode = UAVObject::GetGcsTelemetryUpdateMode(metadata);
 
+    return (objInfo.event != EV_UNPACKED) && ((objInfo.event != EV_UPDATED_PERIODIC) || (updateMode != UAVObject::UPDATEMODE_THROTTLED));
+}
+
+/**
+ * Retransmission timeout derived from the measured round trip time
+ */
+int Telemetry::transactionTimeoutMs() const
+{
+    return qBound(MIN_REQ_TIMEOUT_MS, (int)(rtt + 4.0 * rttVariation), MAX_REQ_TIMEOUT_MS);
+}
+
+/**
+ * Update the smoothed round trip time with a new sample (RFC 6298)
+ */
+void Telemetry::updateRtt(qint64 rttMs)
+{
+    rttVariation = 0.75 * rttVariation + 0.25 * qAbs(rtt - rttMs);
+    rtt = 0.875 * rtt + 0.125 * rttMs;
+}
+
+/**
+ * Process one event from the object queue
+ */
+void Telemetry::processQueuedObject(const ObjectQueueInfo &objInfo)
+{
     // Check if a connection has been established, only process GCSTelemetryStats updates
     // (used to establish the connection)
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
@@ -409,11 +501,7 @@ void Telemetry::processObjectQueue()
         // If an "all instances" transaction is running, then it is not allowed to start another transaction with same object ID
         // If a single instance transaction is running, then starting an "all instance" transaction is not allowed
         // TODO make the above logic a reality...
-        if (findTransaction(objInfo.obj)) {
-            qWarning().nospace() << "Telemetry - !!! Making request for an object " << objInfo.obj->toStringBrief() << " for which a request is already in progress";
-            // objInfo.obj->emitTransactionCompleted(false);
-            return;
-        }
+        // dequeueObject() does not hand out objects with a transaction in progress
         UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
         ObjectTransactionInfo *transInfo = new ObjectTransactionInfo(this);
         transInfo->obj   = objInfo.obj;
@@ -438,14 +526,6 @@ void Telemetry::processObjectQueue()
     } else if (updateMode != UAVObject::UPDATEMODE_THROTTLED) {
         updateObject(objInfo.obj, objInfo.event);
     }
-
-    // The fact we received an unpacked event does not mean that
-    // we do not have additional objects still in the queue,
-    // so we have to reschedule queue processing to make sure they are not
-    // stuck:
-    if (objInfo.event == EV_UNPACKED) {
-        processObjectQueue();
-    }
 }
 
 /**
@@ -531,6 +611,16 @@ Telemetry::TelemetryStats Telemetry::getStats()
     return stats;
 }
 
+/**
+ * Let the autopilot know it can group object updates into batch packets
+ * and send large objects as deltas
+ */
+void Telemetry::announceProtocolExtensions()
+{
+    utalk->sendBatchAnnounce();
+    utalk->sendDeltaAnnounce();
+}
+
 void Telemetry::resetStats()
 {
     QMutexLocker locker(mutex);
@@ -630,6 +720,7 @@ void Telemetry::openTransaction(ObjectTransactionInfo *trans)
         transMap.insert(objId, objTransactions);
     }
     objTransactions->insert(instId, trans);
+    ++openTransactions;
 }
 
 void Telemetry::closeTransaction(ObjectTransactionInfo *trans)
@@ -643,6 +734,7 @@ void Telemetry::closeTransaction(ObjectTransactionInfo *trans)
         // Keep the map even if it is empty
         // There are at most 100 different object IDs...
     }
+    --openTransactions;
     delete trans;
 }
 
@@ -660,6 +752,7 @@ void Telemetry::closeAllTransactions()
         transMap.remove(objId);
         delete objTransactions;
     }
+    openTransactions = 0;
 }
 
 ObjectTransactionInfo::ObjectTransactionInfo(QObject *parent) : QObject(parent)
@@ -669,6 +762,7 @@ ObjectTransactionInfo::ObjectTransactionInfo(QObject *parent) : QObject(parent)
     objRequest       = false;
     retriesRemaining = 0;
     acked = false;
+    retried = false;
     telem = 0;
     // Setup transaction timer
     timer = new QTimer(this);
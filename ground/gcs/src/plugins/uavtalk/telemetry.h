@@ -34,6 +34,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QQueue>
 #include <QMap>
 
@@ -50,6 +51,9 @@ public:
     bool acked;
     QPointer<class Telemetry>telem;
     QTimer *timer;
+    // Round trip measurement, only valid if the transaction was not retried
+    QElapsedTimer sentTime;
+    bool retried;
 private slots:
     void timeout();
 };
@@ -77,15 +81,20 @@ public:
     ~Telemetry();
     TelemetryStats getStats();
     void resetStats();
+    void announceProtocolExtensions();
     void transactionTimeout(ObjectTransactionInfo *info);
+    void setTransactionWindow(int maxWindow);
 
 private:
     // Constants
     static const int REQ_TIMEOUT_MS = 250;
+    static const int MIN_REQ_TIMEOUT_MS = 100;
+    static const int MAX_REQ_TIMEOUT_MS = 2000;
     static const int MAX_RETRIES    = 2;
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
-    static const int MAX_QUEUE_SIZE = 20;
+    static const int MAX_QUEUE_SIZE = 250;
+    static const int DEFAULT_TRANSACTION_WINDOW = 4;
 
     // Types
     /**
@@ -127,6 +136,15 @@ private:
     quint32 txErrors;
     quint32 txRetries;
 
+    // Sliding window of outstanding transactions, the window shrinks on
+    // timeouts and grows back on successful transactions, up to maxWindow
+    int openTransactions;
+    int maxWindow;
+    double window;
+    // Smoothed round trip time and its variation, in ms
+    double rtt;
+    double rttVariation;
+
     // Methods
     void registerObject(UAVObject *obj);
     void addObject(UAVObject *obj);
@@ -137,6 +155,11 @@ private:
     void processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances, bool priority);
     void processObjectTransaction(ObjectTransactionInfo *transInfo);
     void processObjectQueue();
+    void processQueuedObject(const ObjectQueueInfo &objInfo);
+    bool dequeueObject(QQueue<ObjectQueueInfo> &queue, ObjectQueueInfo &objInfo);
+    bool needsTransaction(const ObjectQueueInfo &objInfo);
+    int transactionTimeoutMs() const;
+    void updateRtt(qint64 rttMs);
 
     ObjectTransactionInfo *findTransaction(UAVObject *obj);
     void openTransaction(ObjectTransactionInfo *trans);
@@ -229,6 +229,8 @@ void TelemetryMonitor::processStatsUpdates()
     } else if (gcsStats.Status == GCSTelemetryStats::STATUS_HANDSHAKEREQ) {
         // Check for connection acknowledge
         if (flightStats.Status == FlightTelemetryStats::STATUS_HANDSHAKEACK) {
+            // Announce batch and delta support before the autopilot sees us connected
+            tel->announceProtocolExtensions();
             gcsStats.Status = GCSTelemetryStats::STATUS_CONNECTED;
         }
     } else if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
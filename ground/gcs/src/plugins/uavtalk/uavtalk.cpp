@@ -33,6 +33,8 @@
 #include <QDebug>
 #include <QEventLoop>
 
+#include <string.h>
+
 #ifdef VERBOSE_UAVTALK
 // uncomment and adapt the following lines to filter verbose logging to include specific object(s) only
 // #include "flighttelemetrystats.h"
@@ -51,9 +53,6 @@ using namespace Utils;
  */
 UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive)
 {
-    rxState = STATE_SYNC;
-    rxPacketLength = 0;
-
     memset(&stats, 0, sizeof(ComStats));
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -158,6 +157,33 @@ bool UAVTalk::sendObjectRequest(UAVObject *obj, bool allInstances)
     return objectTransaction(TYPE_OBJ_REQ, obj->getObjID(), instId, obj);
 }
 
+/**
+ * Tell the autopilot that batch packets can be decoded, by sending an empty one.
+ * Autopilots that do not know about batches drop it as an unknown message type.
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::sendBatchAnnounce()
+{
+    QMutexLocker locker(&mutex);
+
+    return transmitSingleObject(TYPE_OBJ_BATCH, 0, 0, NULL);
+}
+
+/**
+ * Tell the autopilot that delta updates can be decoded, by sending an empty one.
+ * Autopilots that do not know about deltas drop it as an unknown message type.
+ * Sent on each connection, the keyframes of the previous one are dropped.
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::sendDeltaAnnounce()
+{
+    QMutexLocker locker(&mutex);
+
+    // The autopilot starts over with new keyframes
+    keyframes.clear();
+    return transmitSingleObject(TYPE_OBJ_DELTA, 0, 0, NULL);
+}
+
 /**
  * Cancel a pending transaction
  */
@@ -208,252 +234,152 @@ bool UAVTalk::objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVO
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
-    if (io && io->isReadable()) {
-        while (io->bytesAvailable() > 0) {
-            int ret = io->read((char *)&tmp, 1);
-            if (ret != -1) {
-                processInputByte(tmp);
-            } else {
-                // TODOD
-            }
-            if (rxState == STATE_COMPLETE) {
-                mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
-                    stats.rxObjectBytes += rxLength;
-                    stats.rxObjects++;
-                } else {
-                    // TODO...
-                }
-                mutex.unlock();
-
-                if (useUDPMirror) {
-                    // it is safe to do this outside of the above critical section as the rxDataArray is
-                    // accessed from this thread only
-                    udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
-                }
-            }
-        }
-    }
-}
-
-/**
- * Process an byte from the telemetry stream.
- * \param[in] rxbyte Received byte
- * \return Success (true), Failure (false)
- */
-bool UAVTalk::processInputByte(quint8 rxbyte)
-{
-    if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
-        rxState = STATE_SYNC;
-
-        if (useUDPMirror) {
-            rxDataArray.clear();
-        }
-    }
-
-    // Update stats
-    stats.rxBytes++;
-
-    // update packet byte count
-    rxPacketLength++;
-
-    if (useUDPMirror) {
-        rxDataArray.append(rxbyte);
+    if (!io || !io->isReadable()) {
+        return;
     }
 
-    // Receive state machine
-    switch (rxState) {
-    case STATE_SYNC:
-
-        if (rxbyte != SYNC_VAL) {
-            // continue until sync byte is matched
-            stats.rxSyncErrors++;
-            break;
-        }
-
-        // Initialize and update CRC
-        rxCS = Crc::updateCRC(0, rxbyte);
-
-        rxPacketLength = 1;
-
-        // case local byte counter, don't forget to zero it after use.
-        rxCount = 0;
-
-        rxState = STATE_TYPE;
-        break;
-
-    case STATE_TYPE:
-
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
-
-        if ((rxbyte & TYPE_MASK) != TYPE_VER) {
-            qWarning() << "UAVTalk - error : bad type";
-            stats.rxErrors++;
-            rxState = STATE_ERROR;
-            break;
-        }
-
-        rxType     = rxbyte;
-
-        packetSize = 0;
-
-        rxState    = STATE_SIZE;
-        break;
-
-    case STATE_SIZE:
-
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
-
-        if (rxCount == 0) {
-            packetSize += rxbyte;
-            rxCount++;
-            break;
-        }
-        packetSize += (quint32)rxbyte << 8;
-        rxCount     = 0;
-
-
-        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
-            // incorrect packet size
-            qWarning() << "UAVTalk - error : incorrect packet size";
-            stats.rxErrors++;
-            rxState = STATE_ERROR;
-            break;
-        }
-
-        rxState = STATE_OBJID;
-        break;
-
-    case STATE_OBJID:
-
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
-
-        rxTmpBuffer[rxCount++] = rxbyte;
-        if (rxCount < 4) {
-            break;
-        }
-        rxCount  = 0;
-
-        rxObjId  = (qint32)qFromLittleEndian<quint32>(rxTmpBuffer);
-
-        // Message always contain an instance ID
-        rxInstId = 0;
-        rxState  = STATE_INSTID;
-        break;
-
-    case STATE_INSTID:
-
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
-
-        rxTmpBuffer[rxCount++] = rxbyte;
-        if (rxCount < 2) {
+    while (io->bytesAvailable() > 0) {
+        // Append the available bytes to what is left of the previous read
+        qint64 available = io->bytesAvailable();
+        int offset = rxStream.size();
+        rxStream.resize(offset + available);
+        qint64 ret = io->read(rxStream.data() + offset, available);
+        rxStream.resize(offset + qMax(ret, (qint64)0));
+        if (ret <= 0) {
             break;
         }
-        rxCount  = 0;
-
-        rxInstId = (qint16)qFromLittleEndian<quint16>(rxTmpBuffer);
-
-        // Search for object, if not found reset state machine
-        {
-            UAVObject *rxObj = objMngr->getObject(rxObjId);
-            if (rxObj == NULL && rxType != TYPE_OBJ_REQ) {
-                qWarning() << "UAVTalk - error : unknown object" << rxObjId;
-                stats.rxErrors++;
-                rxState = STATE_ERROR;
+        stats.rxBytes += ret;
+
+        quint8 *buffer = (quint8 *)rxStream.data();
+        qint32 size    = rxStream.size();
+        qint32 pos     = 0;
+        while (pos < size) {
+            // Skip to the next sync byte
+            const quint8 *sync = (const quint8 *)memchr(buffer + pos, SYNC_VAL, size - pos);
+            qint32 syncPos     = sync ? (qint32)(sync - buffer) : size;
+            stats.rxSyncErrors += syncPos - pos;
+            pos = syncPos;
+            if (pos == size) {
                 break;
             }
 
-            // Determine data length
-            if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK) {
-                rxLength = 0;
-            } else {
-                if (rxObj) {
-                    rxLength = rxObj->getNumBytes();
-                } else {
-                    rxLength = packetSize - rxPacketLength;
-                }
-            }
-
-            // Check length and determine next state
-            if (rxLength >= MAX_PAYLOAD_LENGTH) {
-                // packet error - exceeded payload max length
-                qWarning() << "UAVTalk - error : exceeded payload max length" << rxObjId;
-                stats.rxErrors++;
-                rxState = STATE_ERROR;
+            qint32 frameLength = decodeFrame(buffer + pos, size - pos);
+            if (frameLength == 0) {
+                // wait for the rest of the frame
                 break;
             }
+            if (frameLength < 0) {
+                // not a valid frame, resync after this sync byte
+                pos++;
+                continue;
+            }
 
-            // Check the lengths match
-            if ((rxPacketLength + rxLength) != packetSize) {
-                // packet error - mismatched packet size
-                qWarning() << "UAVTalk - error : mismatched packet size" << rxObjId;
-                stats.rxErrors++;
-                rxState = STATE_ERROR;
-                break;
+            // The payload is handed over straight from the receive buffer
+            mutex.lock();
+            if (receiveObject(rxType, rxObjId, rxInstId, buffer + pos + HEADER_LENGTH, rxLength)) {
+                stats.rxObjectBytes += rxLength;
+                stats.rxObjects++;
+            } else {
+                // TODO...
             }
-        }
+            mutex.unlock();
 
-        // If there is a payload get it, otherwise receive checksum
-        if (rxLength > 0) {
-            rxState = STATE_DATA;
-        } else {
-            rxState = STATE_CS;
+            if (useUDPMirror) {
+                // it is safe to do this outside of the above critical section as the receive buffer is
+                // accessed from this thread only
+                udpSocketTx->writeDatagram((const char *)buffer + pos, frameLength, QHostAddress::LocalHost, udpSocketRx->localPort());
+            }
+            pos += frameLength;
         }
-        break;
-
-    case STATE_DATA:
+        rxStream.remove(0, pos);
+    }
+}
 
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
+/**
+ * Validate the frame starting with a sync byte at the beginning of the buffer.
+ * The header is checked as a whole and the checksum is computed over the
+ * complete frame once it has been received.
+ * \param[in] frame Frame start
+ * \param[in] length Number of bytes available from the frame start
+ * \return The frame length including the checksum, 0 if more bytes are needed
+ * or -1 if this is not a valid frame
+ */
+qint32 UAVTalk::decodeFrame(const quint8 *frame, qint32 length)
+{
+    if (length < HEADER_LENGTH) {
+        return 0;
+    }
 
-        rxBuffer[rxCount++] = rxbyte;
-        if (rxCount < rxLength) {
-            break;
-        }
-        rxCount = 0;
+    quint8 type = frame[1];
+    if ((type & TYPE_MASK) != TYPE_VER) {
+        qWarning() << "UAVTalk - error : bad type";
+        stats.rxErrors++;
+        return -1;
+    }
 
-        rxState = STATE_CS;
-        break;
+    qint32 packetSize = qFromLittleEndian<quint16>(frame + 2);
+    if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+        // incorrect packet size
+        qWarning() << "UAVTalk - error : incorrect packet size";
+        stats.rxErrors++;
+        return -1;
+    }
 
-    case STATE_CS:
+    if (length < packetSize + CHECKSUM_LENGTH) {
+        return 0;
+    }
 
-        // The CRC byte
-        rxCSPacket = rxbyte;
+    quint32 objId  = qFromLittleEndian<quint32>(frame + 4);
+    quint16 instId = qFromLittleEndian<quint16>(frame + 8);
 
-        if (rxCS != rxCSPacket) {
-            // packet error - faulty CRC
-            qWarning() << "UAVTalk - error : failed CRC check" << rxObjId;
-            stats.rxCrcErrors++;
-            rxState = STATE_ERROR;
-            break;
-        }
+    // Search for object, if not found drop the frame
+    // Batches have no object ID of their own
+    UAVObject *rxObj = (type == TYPE_OBJ_BATCH) ? NULL : objMngr->getObject(objId);
+    if (rxObj == NULL && type != TYPE_OBJ_REQ && type != TYPE_OBJ_BATCH) {
+        qWarning() << "UAVTalk - error : unknown object" << objId;
+        stats.rxErrors++;
+        return -1;
+    }
 
-        if (rxPacketLength != packetSize + CHECKSUM_LENGTH) {
-            // packet error - mismatched packet size
-            qWarning() << "UAVTalk - error : mismatched packet size" << rxObjId;
-            stats.rxErrors++;
-            rxState = STATE_ERROR;
-            break;
-        }
+    // Determine data length
+    qint32 dataLength;
+    if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+        dataLength = 0;
+    } else if (rxObj && type != TYPE_OBJ_DELTA) {
+        dataLength = rxObj->getNumBytes();
+    } else {
+        dataLength = packetSize - HEADER_LENGTH;
+    }
 
-        rxState = STATE_COMPLETE;
-        break;
+    // Check length
+    if (dataLength >= MAX_PAYLOAD_LENGTH) {
+        // packet error - exceeded payload max length
+        qWarning() << "UAVTalk - error : exceeded payload max length" << objId;
+        stats.rxErrors++;
+        return -1;
+    }
 
-    default:
+    // Check the lengths match
+    if (HEADER_LENGTH + dataLength != packetSize) {
+        // packet error - mismatched packet size
+        qWarning() << "UAVTalk - error : mismatched packet size" << objId;
+        stats.rxErrors++;
+        return -1;
+    }
 
-        qWarning() << "UAVTalk - error : bad state";
-        rxState = STATE_ERROR;
-        break;
+    if (Crc::updateCRC(0, frame, packetSize) != frame[packetSize]) {
+        // packet error - faulty CRC
+        qWarning() << "UAVTalk - error : failed CRC check" << objId;
+        stats.rxCrcErrors++;
+        return -1;
     }
 
-    // Done
-    return true;
+    rxType   = type;
+    rxObjId  = objId;
+    rxInstId = instId;
+    rxLength = dataLength;
+
+    return packetSize + CHECKSUM_LENGTH;
 }
 
 /**
@@ -474,14 +400,32 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
  */
 bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length)
 {
-    Q_UNUSED(length);
-
     UAVObject *obj    = NULL;
     bool error        = false;
     bool allInstances = (instId == ALL_INSTANCES);
 
     // Process message type
     switch (type) {
+    case TYPE_OBJ_BATCH:
+        // The instance ID field of a batch holds the number of objects
+        error = !receiveBatch(instId, data, length);
+        break;
+
+    case TYPE_OBJ_DELTA:
+        // Get object and apply the changes to its keyframe, or store a new keyframe
+        obj = receiveDelta(objId, instId, data, length);
+        if (obj != NULL) {
+            // Deltas ack pending OBJ_REQ messages like any OBJ message
+            updateAck(TYPE_OBJ, objId, 0, obj);
+            if (instId & DELTA_KEYFRAME) {
+                // Keyframes are acked with their own instance ID
+                error = !transmitObject(TYPE_ACK, objId, instId, obj);
+            }
+        } else {
+            error = true;
+        }
+        break;
+
     case TYPE_OBJ:
         // All instances, not allowed for OBJ messages
         if (!allInstances) {
@@ -594,6 +538,119 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
     return !error;
 }
 
+/**
+ * Receive a batch packet, each object is handled like an OBJ message.
+ * \param[in] count Number of objects in the batch
+ * \param[in] data Batch payload
+ * \param[in] length Payload length
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::receiveBatch(quint16 count, quint8 *data, qint32 length)
+{
+    qint32 position = 0;
+    bool error = false;
+
+    for (quint16 n = 0; n < count; ++n) {
+        if (position + BATCH_RECORD_HEADER_LENGTH > length) {
+            qWarning() << "UAVTalk - error : truncated batch";
+            return false;
+        }
+        quint8 *record = &data[position];
+        quint32 objId  = qFromLittleEndian<quint32>(record);
+        quint16 instId = qFromLittleEndian<quint16>(&record[4]);
+        qint32 recordLength = record[6];
+
+        position += BATCH_RECORD_HEADER_LENGTH + recordLength;
+        if (position > length) {
+            qWarning() << "UAVTalk - error : truncated batch" << objId;
+            return false;
+        }
+        // Unknown objects are skipped, the record length gives the next one
+        UAVObject *obj = objMngr->getObject(objId);
+        if (obj == NULL || (qint32)obj->getNumBytes() != recordLength) {
+            qWarning() << "UAVTalk - error : unknown object in batch" << objId;
+            error = true;
+        } else if (!receiveObject(TYPE_OBJ, objId, instId, &record[BATCH_RECORD_HEADER_LENGTH], recordLength)) {
+            error = true;
+        }
+    }
+
+    return !error && position == length;
+}
+
+/**
+ * Receive a delta update, the changed blocks are applied on top of the last acked full update (keyframe).
+ * Deltas made against another keyframe than ours are dropped, the next keyframe resyncs us.
+ * Keyframes hold the whole object and replace the stored one.
+ * \param[in] objId ID of the object to update
+ * \param[in] instId Keyframe number, with DELTA_KEYFRAME set for keyframes
+ * \param[in] data Delta payload
+ * \param[in] length Payload length
+ * \return The updated object, NULL on failure
+ */
+UAVObject *UAVTalk::receiveDelta(quint32 objId, quint16 instId, quint8 *data, qint32 length)
+{
+    UAVObject *obj = objMngr->getObject(objId);
+
+    if (obj == NULL || !obj->isSingleInstance()) {
+        return NULL;
+    }
+
+    qint32 numBytes = obj->getNumBytes();
+    if (instId & DELTA_KEYFRAME) {
+        if (length != numBytes) {
+            qWarning() << "UAVTalk - error : mismatched keyframe size" << objId;
+            return NULL;
+        }
+        Keyframe & stored = keyframes[objId];
+        stored.id   = instId & ~DELTA_KEYFRAME;
+        stored.data = QByteArray((const char *)data, numBytes);
+        return updateObject(objId, 0, data);
+    }
+
+    // Work on a copy, the keyframe itself is left untouched
+    QHash<quint32, Keyframe>::const_iterator stored = keyframes.constFind(objId);
+    if (stored == keyframes.constEnd() || stored->id != instId) {
+        qWarning() << "UAVTalk - error : delta does not match keyframe" << objId;
+        return NULL;
+    }
+    QByteArray keyframe = stored->data;
+    if (keyframe.size() != numBytes || length < 1 ||
+        Crc::updateCRC(0, (const quint8 *)keyframe.constData(), numBytes) != data[0]) {
+        qWarning() << "UAVTalk - error : delta does not match keyframe" << objId;
+        return NULL;
+    }
+
+    qint32 numBlocks    = (numBytes + DELTA_BLOCK_SIZE - 1) / DELTA_BLOCK_SIZE;
+    qint32 bitmapLength = (numBlocks + 7) / 8;
+    qint32 dataEnd = length - bitmapLength;
+    if (dataEnd < 1) {
+        qWarning() << "UAVTalk - error : truncated delta" << objId;
+        return NULL;
+    }
+    const quint8 *bitmap = &data[dataEnd];
+
+    qint32 position = 1;
+    for (qint32 n = 0; n < numBlocks; ++n) {
+        if (bitmap[n / 8] & (1 << (n % 8))) {
+            qint32 offset    = n * DELTA_BLOCK_SIZE;
+            qint32 blockSize = qMin(numBytes - offset, DELTA_BLOCK_SIZE);
+            if (position + blockSize > dataEnd) {
+                qWarning() << "UAVTalk - error : truncated delta" << objId;
+                return NULL;
+            }
+            memcpy(keyframe.data() + offset, &data[position], blockSize);
+            position += blockSize;
+        }
+    }
+    if (position != dataEnd) {
+        qWarning() << "UAVTalk - error : mismatched delta size" << objId;
+        return NULL;
+    }
+
+    return updateObject(objId, 0, (quint8 *)keyframe.data());
+}
+
 /**
  * Update the data of an object from a byte array (unpack).
  * If the object instance could not be found in the list, then a
@@ -756,8 +813,8 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     // Setup instance ID
     qToLittleEndian<quint16>(instId, &txBuffer[8]);
 
-    // Determine data length
-    if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+    // Determine data length, batches and deltas are only sent empty
+    if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK || type == TYPE_OBJ_BATCH || type == TYPE_OBJ_DELTA) {
         length = 0;
     } else {
         length = obj->getNumBytes();
@@ -896,6 +953,16 @@ const char *UAVTalk::typeToString(quint8 type)
     case TYPE_NACK:
         return "nack";
 
+        break;
+
+    case TYPE_OBJ_BATCH:
+        return "batch";
+
+        break;
+
+    case TYPE_OBJ_DELTA:
+        return "delta";
+
         break;
     }
     return "<error>";
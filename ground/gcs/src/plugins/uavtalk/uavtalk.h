@@ -68,6 +68,8 @@ public:
 
     bool sendObject(UAVObject *obj, bool acked, bool allInstances);
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
+    bool sendBatchAnnounce();
+    bool sendDeltaAnnounce();
     void cancelTransaction(UAVObject *obj);
 
 signals:
@@ -93,23 +95,29 @@ private:
     static const int TYPE_OBJ_ACK  = (TYPE_VER | 0x02);
     static const int TYPE_ACK      = (TYPE_VER | 0x03);
     static const int TYPE_NACK     = (TYPE_VER | 0x04);
+    static const int TYPE_OBJ_BATCH = (TYPE_VER | 0x05);
+    static const int TYPE_OBJ_DELTA = (TYPE_VER | 0x06);
 
     // header : sync(1), type (1), size(2), object ID(4), instance ID(2)
     static const int HEADER_LENGTH = 10;
 
     static const int MAX_PAYLOAD_LENGTH = 256;
 
+    // batch record header : object ID(4), instance ID(2), data length(1)
+    static const int BATCH_RECORD_HEADER_LENGTH = 7;
+
+    // delta payload : keyframe CRC(1), changed blocks, bitmap of changed blocks
+    // the instance ID of a delta is the number of its keyframe
+    // keyframes are delta packets holding the whole object, their instance ID is DELTA_KEYFRAME | number
+    static const int DELTA_BLOCK_SIZE = 4;
+    static const int DELTA_KEYFRAME   = 0x8000;
+
     static const int CHECKSUM_LENGTH    = 1;
 
     static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
 
     static const int TX_BUFFER_SIZE     = 2 * 1024;
 
-    // Types
-    typedef enum {
-        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
-    } RxStateType;
-
     // Variables
     QPointer<QIODevice> io;
 
@@ -121,34 +129,33 @@ private:
 
     QMap<quint32, QMap<quint32, Transaction *> *> transMap;
 
-    quint8 rxBuffer[MAX_PACKET_LENGTH];
+    // last acked full update of objects sent as deltas, deltas are applied on top of it
+    struct Keyframe {
+        quint16    id;
+        QByteArray data;
+    };
+    QHash<quint32, Keyframe> keyframes;
 
     quint8 txBuffer[MAX_PACKET_LENGTH];
 
-    // Variables used by the receive state machine
-    // state machine variables
-    qint32 rxCount;
-    qint32 packetSize;
-    RxStateType rxState;
-    // data variables
-    quint8 rxTmpBuffer[4];
+    // Received bytes not decoded yet
+    QByteArray rxStream;
+    // Last decoded frame, its payload is still in rxStream
     quint8 rxType;
     quint32 rxObjId;
     quint16 rxInstId;
     quint16 rxLength;
-    quint16 rxPacketLength;
-    quint8 rxCSPacket;
-    quint8 rxCS;
 
     bool useUDPMirror;
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
-    QByteArray rxDataArray;
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
-    bool processInputByte(quint8 rxbyte);
+    qint32 decodeFrame(const quint8 *frame, qint32 length);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
+    bool receiveBatch(quint16 count, quint8 *data, qint32 length);
+    UAVObject *receiveDelta(quint32 objId, quint16 instId, quint8 *data, qint32 length);
     UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     void updateNack(quint32 objId, quint16 instId, UAVObject *obj);
@@ -33,7 +33,8 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
     fieldTypeStrC << "int8_t" << "int16_t" << "int32_t" << "uint8_t"
                   << "uint16_t" << "uint32_t" << "float" << "uint8_t";
 
-    QString flightObjInit, objInc, objFileNames, objNames;
+    QString flightObjInit, objInc, objFileNames, objNames, objIdTable;
+    QMap<quint32, QString> objIds;
     qint32 sizeCalc;
     flightCodePath            = QDir(templatepath + QString(FLIGHT_CODE_DIR));
     flightOutputPath          = QDir(outputpath);
@@ -60,6 +61,7 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
         objInc.append("#include \"" + info->namelc + ".h\"\n");
         objFileNames.append(" " + info->namelc);
         objNames.append(" " + info->name);
+        objIds.insert(info->id, info->name);
         if (parser->getNumBytes(objidx) > sizeCalc) {
             sizeCalc = parser->getNumBytes(objidx);
         }
@@ -75,8 +77,17 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
         return false;
     }
 
+    // Build the ID table, QMap keeps the object IDs sorted in ascending order
+    // so the object manager can use a binary search for lookups by ID
+    for (QMap<quint32, QString>::const_iterator it = objIds.constBegin(); it != objIds.constEnd(); ++it) {
+        objIdTable.append(QString("    0x%1, /* %2 */").arg(it.key(), 8, 16, QChar('0')).arg(it.value()));
+        objIdTable.append((it + 1) == objIds.constEnd() ? "\n" : " \\\n");
+    }
+
     // Write the flight object initialization header
     flightInitIncludeTemplate.replace(QString("$(SIZECALCULATION)"), QString().setNum(sizeCalc));
+    flightInitIncludeTemplate.replace(QString("$(OBJCOUNT)"), QString().setNum(objIds.count()));
+    flightInitIncludeTemplate.replace(QString("$(OBJIDTABLE)"), objIdTable);
     res = writeFileIfDifferent(flightOutputPath.absolutePath() + "/uavobjectsinit.h",
                                flightInitIncludeTemplate);
     if (!res) {